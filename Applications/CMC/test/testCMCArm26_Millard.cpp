@@ -25,9 +25,11 @@
 #include <OpenSim/Simulation/Model/AnalysisSet.h>
 #include <OpenSim/Tools/CMCTool.h>
 #include <OpenSim/Tools/ForwardTool.h>
+#include <OpenSim/Tools/ParallelTimeWindows.h>
 #include <OpenSim/Auxiliary/auxiliaryTestFunctions.h>
 
 #include <fstream>
+#include <memory>
 #include <thread>
 
 using namespace OpenSim;
@@ -63,6 +65,89 @@ void testCMCArm26() {
     cout << "\n" << base <<" passed\n" << endl;
 }
 
+// Linearizing the task accelerations on multiple threads must not change the
+// result, even though arm26 has wrap objects.
+void testCMCArm26Parallel() {
+    CMCTool cmc("arm26_Setup_CMC.xml");
+    cmc.setResultsDir("Results_Arm26_Millard_Parallel");
+    cmc.setNumThreads(4);
+    ASSERT(cmc.run());
+
+    Storage results("Results_Arm26_Millard_Parallel/arm26_states.sto");
+    Storage serial("Results_Arm26_Millard/arm26_states.sto");
+    std::vector<double> rms_tols(2*2+2*6, 1e-6);
+    CHECK_STORAGE_AGAINST_STANDARD(results, serial, rms_tols, __FILE__,
+        __LINE__, "testCMCArm26Parallel failed");
+
+    cout << "\ntestCMCArm26Parallel passed\n" << endl;
+}
+
+// Solving overlapping time windows concurrently and blending the results
+// must track the kinematics about as well as solving the whole time range,
+// and outside the blending regions the stitched result must be exactly that
+// of the window that covers the time.
+void testCMCArm26TimeWindows() {
+    CMCTool cmc("arm26_Setup_CMC.xml");
+    const std::string resultsDir = "Results_Arm26_Millard_TimeWindows";
+    cmc.setResultsDir(resultsDir);
+    const int numWindows = 2;
+    const double overlap = 0.05;
+    cmc.setNumParallelTimeWindows(numWindows);
+    cmc.setParallelTimeWindowOverlap(overlap);
+    cmc.setNumThreads(2);
+    ASSERT(cmc.run());
+
+    Storage results(resultsDir + "/arm26_states.sto");
+    Storage serial("Results_Arm26_Millard/arm26_states.sto");
+    ASSERT_EQUAL(serial.getFirstTime(), results.getFirstTime(), 1e-10,
+        __FILE__, __LINE__, "Expected the same initial time.");
+    ASSERT_EQUAL(serial.getLastTime(), results.getLastTime(), 1e-10,
+        __FILE__, __LINE__, "Expected the same final time.");
+    // Angles within .3 degrees; activations may differ more right after
+    // the boundary, where the second window's warm-up ends.
+    std::vector<double> rms_tols(2*2+2*6, 0.005);
+    for (int i = 4; i < (int)rms_tols.size(); i += 2) rms_tols[i] = 0.05;
+    CHECK_STORAGE_AGAINST_STANDARD(results, serial, rms_tols, __FILE__,
+        __LINE__, "testCMCArm26TimeWindows failed");
+
+    const ParallelTimeWindows windows(cmc.getInitialTime(),
+        cmc.getFinalTime() - cmc.getTimeWindow(), numWindows, overlap);
+    std::vector<std::unique_ptr<Storage>> windowResults;
+    for (int i = 0; i < numWindows; ++i) {
+        windowResults.emplace_back(new Storage(resultsDir + "/time_window_" +
+            std::to_string(i) + "/arm26_states.sto"));
+    }
+    const int numColumns = results.getColumnLabels().getSize() - 1;
+    Array<double> expected(0.0, numColumns);
+    double previousTime = -SimTK::Infinity;
+    for (int irow = 0; irow < results.getSize(); ++irow) {
+        const StateVector& row = *results.getStateVector(irow);
+        const double time = row.getTime();
+        ASSERT(time > previousTime, __FILE__, __LINE__,
+            "Expected the stitched times to increase.");
+        previousTime = time;
+        for (int i = 0; i < numWindows; ++i) {
+            // The window's result is used without blending from the end of
+            // the blending region at its start to the start of the blending
+            // region at its end.
+            const double begin = i == 0 ? windows.getWindowInitialTime(i)
+                : windows.getWindowInitialTime(i) + 1.5 * overlap;
+            const double end = i == numWindows - 1
+                ? windows.getWindowFinalTime(i)
+                : windows.getWindowFinalTime(i) - overlap;
+            if (time < begin || time > end) continue;
+            windowResults[i]->getDataAtTime(time, numColumns, expected);
+            for (int icol = 0; icol < numColumns; ++icol) {
+                ASSERT_EQUAL(expected[icol], row.getData()[icol], 1e-6,
+                    __FILE__, __LINE__, "Expected the stitched states at "
+                    "t = " + std::to_string(time) + " to be those of time "
+                    "window " + std::to_string(i) + ".");
+            }
+        }
+    }
+
+    cout << "\ntestCMCArm26TimeWindows passed\n" << endl;
+}
 
 int main() {
 
@@ -75,6 +160,16 @@ int main() {
     }catch (const std::exception& e) { 
         cout << e.what() <<endl; failures.push_back("testCMCArm26_Millard"); 
     }
+    try{
+        testCMCArm26Parallel();
+    }catch (const std::exception& e) { 
+        cout << e.what() <<endl; failures.push_back("testCMCArm26Parallel"); 
+    }
+    try{
+        testCMCArm26TimeWindows();
+    }catch (const std::exception& e) { 
+        cout << e.what() <<endl; failures.push_back("testCMCArm26TimeWindows"); 
+    }
 
     if (!failures.empty()) {
         cout << "Done, with failure(s): " << failures << endl;
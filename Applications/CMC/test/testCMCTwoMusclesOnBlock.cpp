@@ -31,6 +31,7 @@ using namespace OpenSim;
 using namespace std;
 
 void testTwoMusclesOnBlock();
+void testTwoMusclesOnBlockParallel();
 
 int main() {
 
@@ -40,6 +41,11 @@ int main() {
     catch (const std::exception& e)
         {  cout << e.what() <<endl; failures.push_back("testTwoMusclesOnBlock"); }
 
+    try {testTwoMusclesOnBlockParallel();}
+    catch (const std::exception& e)
+        {  cout << e.what() <<endl; 
+            failures.push_back("testTwoMusclesOnBlockParallel"); }
+
     // redo with the Millard2012EquilibriumMuscle 
     Object::renameType("Thelen2003Muscle", "Millard2012EquilibriumMuscle");
 
@@ -143,3 +149,25 @@ void testTwoMusclesOnBlock() {
     cout << "\n" << base << " passed\n" << endl;
 }
 
+// Linearizing the task accelerations on multiple threads must not change the
+// result.
+void testTwoMusclesOnBlockParallel() {
+    cout<<"\n******************************************************************" << endl;
+    cout << "*                  testTwoMusclesOnBlockParallel                 *" << endl;
+    cout << "******************************************************************\n" << endl;
+
+    CMCTool cmc("twoMusclesOnBlock_Setup_CMC.xml");
+    cmc.setResultsDir("twoMusclesOnBlock_ResultsCMC_Parallel");
+    cmc.setNumThreads(2);
+    cmc.run();
+
+    Storage parallel(
+        "twoMusclesOnBlock_ResultsCMC_Parallel/twoMusclesOnBlock_tugOfWar_states.sto");
+    Storage serial("twoMusclesOnBlock_ResultsCMC/twoMusclesOnBlock_tugOfWar_states.sto");
+
+    CHECK_STORAGE_AGAINST_STANDARD(parallel, serial,
+        std::vector<double>(6, 1e-6), __FILE__, __LINE__,
+        "testTwoMusclesOnBlockParallel failed");
+
+    cout << "\ntestTwoMusclesOnBlockParallel passed\n" << endl;
+}
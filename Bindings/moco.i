@@ -128,6 +128,8 @@ namespace OpenSim {
 }
 %include <OpenSim/Moco/MocoTropterSolver.h>
 %include <OpenSim/Moco/MocoCasADiSolver/MocoCasADiSolver.h>
+// SWIG cannot wrap the std::function arguments of this method.
+%ignore OpenSim::MocoStudy::solveSequence;
 %include <OpenSim/Moco/MocoStudy.h>
 %include <OpenSim/Moco/MocoStudyFactory.h>
 
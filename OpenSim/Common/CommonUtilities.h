@@ -28,8 +28,9 @@
 #include <iostream>
 #include <memory>
 #include <mutex>
-#include <stack>
+#include <deque>
 #include <condition_variable>
+#include <thread>
 
 #include <SimTKcommon/internal/BigMatrix.h>
 
@@ -126,8 +127,13 @@ SimTK::Real solveBisection(std::function<double(const double&)> calcResidual,
 
 /// This class lets you store objects of a single type for reuse by multiple
 /// threads, ensuring threadsafe access to each of those objects.
+/// Objects have affinity to the thread that last returned them: take()
+/// gives a thread the object it most recently returned, if available, so
+/// that a thread that repeatedly takes and returns an object keeps using
+/// the same object (and the memory it has cached). Otherwise, take() gives
+/// the object that has been in the jar the longest, as its previous thread
+/// is the least likely to ask for it again soon.
 /// @ingroup commonutil
-// TODO: Find a way to always give the same thread the same object.
 template <typename T> class ThreadsafeJar {
 public:
     /// Request an object for your exclusive use on your thread. This function
@@ -140,16 +146,22 @@ public:
         // Block this thread until the condition variable is woken up
         // (by a notify_...()) and the lambda function returns true.
         m_inventoryMonitor.wait(lock, [this] { return m_entries.size() > 0; });
-        std::unique_ptr<T> top = std::move(m_entries.top());
-        m_entries.pop();
-        return top;
+        const auto thisThread = std::this_thread::get_id();
+        auto it = m_entries.end();
+        for (auto e = m_entries.begin(); e != m_entries.end(); ++e) {
+            if (e->owner == thisThread) it = e;
+        }
+        if (it == m_entries.end()) it = m_entries.begin();
+        std::unique_ptr<T> entry = std::move(it->object);
+        m_entries.erase(it);
+        return entry;
     }
     /// Add or return an object so that another thread can use it. You will need
     /// to std::move() the entry, ensuring that you will no longer have access
     /// to the entry in your code (the pointer will now be null).
     void leave(std::unique_ptr<T> entry) {
         std::unique_lock<std::mutex> lock(m_mutex);
-        m_entries.push(std::move(entry));
+        m_entries.push_back({std::this_thread::get_id(), std::move(entry)});
         lock.unlock();
         m_inventoryMonitor.notify_one();
     }
@@ -160,7 +172,13 @@ public:
     }
 
 private:
-    std::stack<std::unique_ptr<T>> m_entries;
+    struct Entry {
+        // The thread that last returned the object.
+        std::thread::id owner;
+        std::unique_ptr<T> object;
+    };
+    // Ordered by the time at which the objects were returned.
+    std::deque<Entry> m_entries;
     mutable std::mutex m_mutex;
     std::condition_variable m_inventoryMonitor;
 };
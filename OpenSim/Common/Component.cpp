@@ -943,6 +943,30 @@ SimTK::Vector Component::
     return stateVariableValues;
 }
 
+std::vector<SimTK::SystemYIndex> Component::
+    getStateVariableSystemIndices(const SimTK::State& state) const
+{
+    // Must have already called initSystem.
+    OPENSIM_THROW_IF_FRMOBJ(!hasSystem(), ComponentHasNoSystem);
+
+    int nsv = getNumStateVariables();
+    // if the StateVariables are invalid (see above) rebuild the list
+    if (!isAllStatesVariablesListValid()) {
+        _statesAssociatedSystem.reset(&getSystem());
+        _allStateVariables.clear();
+        _allStateVariables.resize(nsv);
+        Array<std::string> names = getStateVariableNames();
+        for (int i = 0; i < nsv; ++i)
+            _allStateVariables[i].reset(traverseToStateVariable(names[i]));
+    }
+
+    std::vector<SimTK::SystemYIndex> indices(nsv);
+    for (int i = 0; i < nsv; ++i) {
+        indices[i] = _allStateVariables[i]->findSystemYIndex(state);
+    }
+    return indices;
+}
+
 // Set all values of the state variables allocated by this Component. Includes
 // state variables allocated by its subcomponents.
 void Component::
@@ -1578,6 +1602,21 @@ void Component::AddedStateVariable::setValue(SimTK::State& state, double value)
     throw Exception(msg.str(),__FILE__,__LINE__);
 }
 
+SimTK::SystemYIndex Component::AddedStateVariable::
+    findSystemYIndex(const SimTK::State& state) const
+{
+    ZIndex zix(getVarIndex());
+    if (!getSubsysIndex().isValid() || !zix.isValid()) {
+        return SimTK::SystemYIndex();
+    }
+    // Y is ordered as [q, u, z]. The value is stored in the Z of the default
+    // subsystem (see getValue()).
+    const SimTK::SubsystemIndex subsysIndex =
+            getOwner().getDefaultSubsystem().getMySubsystemIndex();
+    return SimTK::SystemYIndex(state.getNQ() + state.getNU() +
+                               state.getZStart(subsysIndex) + zix);
+}
+
 static std::string const& derivativeName(const std::string& baseName) {
     // this function is called *a lot* (e.g. millions of times in a sim), so we
     // use TLS to cache the (potentially, heap-allocated) derivative name
@@ -1318,6 +1318,24 @@ public:
      */
     SimTK::Vector getStateVariableValues(const SimTK::State& state) const;
 
+    /**
+     * Get the index in the State's vector of continuous state variables, Y
+     * (see SimTK::State::getY()), of each state variable allocated by this
+     * Component and its subcomponents. Reading Y at these indices gives the
+     * same values as getStateVariableValues(), without the overhead of
+     * visiting each state variable; this is useful when recording many
+     * states. The index is invalid for a state variable whose value is not
+     * an element of Y.
+     *
+     * @param state   a State realized to at least Stage::Model
+     * @return indices of length getNumStateVariables() in the order returned
+     *         by getStateVariableNames()
+     * @throws ComponentHasNoSystem if this Component has not been added to a
+     *         System (i.e., if initSystem has not been called)
+     */
+    std::vector<SimTK::SystemYIndex> getStateVariableSystemIndices(
+            const SimTK::State& state) const;
+
     /**
      * %Set all values of the state variables allocated by this Component.
      * Includes state variables allocated by its subcomponents. Note, this
@@ -2942,6 +2960,12 @@ protected:
         const SimTK::SubsystemIndex& getSubsysIndex() const { return subsysIndex; }
         // return the index in the global list of continuous state variables, Y
         const SimTK::SystemYIndex& getSystemYIndex() const { return sysYIndex; }
+        // Find the index of this state variable in Y for the given State
+        // (realized to Stage::Model). Concrete state variables whose value
+        // is an element of Y should override this; the default returns an
+        // invalid index.
+        virtual SimTK::SystemYIndex
+        findSystemYIndex(const SimTK::State& state) const { return sysYIndex; }
 
         bool isHidden() const { return hidden; }
         void hide()  { hidden = true; }
@@ -3102,6 +3126,9 @@ private:
         double getDerivative(const SimTK::State& state) const override;
         void setDerivative(const SimTK::State& state, double deriv) const override;
 
+        SimTK::SystemYIndex
+        findSystemYIndex(const SimTK::State& state) const override;
+
         private: // DATA
         // Changes in state variables trigger recalculation of appropriate cache
         // variables by automatically invalidating the realization stage specified
@@ -539,6 +539,21 @@ getParentDirectory(const string& fileName)
     return result;
 }
 
+//_____________________________________________________________________________
+/**
+ * Get the passed in fileName as an absolute path, using the current working
+ * directory for relative file names.
+ * 
+*/
+string IO::
+makeAbsolutePath(const string& fileName)
+{
+    if (fileName.empty()) return fileName;
+    if (fileName[0] == '/' || fileName[0] == '\\') return fileName;
+    if (fileName.size() > 1 && fileName[1] == ':') return fileName; // drive
+    return getCwd() + "/" + fileName;
+}
+
 //_____________________________________________________________________________
 /**
  * Get filename part of a passed in URI (also works if a DOS/Unix path is passed in)
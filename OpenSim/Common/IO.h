@@ -108,6 +108,9 @@ public:
     static int chDir(const std::string &aDirName);
     static std::string getCwd();
     static std::string getParentDirectory(const std::string& fileName);
+    /** Get fileName relative to the current working directory, unless it is
+    already absolute (or empty). */
+    static std::string makeAbsolutePath(const std::string& fileName);
     static std::string GetFileNameFromURI(const std::string& aURI);
     static std::string formatText(const std::string& aComment,const std::string& leadingWhitespace,int width,const std::string& endlineTokenToInsert="\n");
 
@@ -0,0 +1,224 @@
+/* -------------------------------------------------------------------------- *
+ *                       OpenSim:  NativeCodeCache.cpp                        *
+ * -------------------------------------------------------------------------- *
+ * The OpenSim API is a toolkit for musculoskeletal modeling and simulation.  *
+ * See http://opensim.stanford.edu and the NOTICE file for more information.  *
+ * OpenSim is developed at Stanford University and supported by the US        *
+ * National Institutes of Health (U54 GM072970, R24 HD065690) and by DARPA    *
+ * through the Warrior Web program.                                           *
+ *                                                                            *
+ * Copyright (c) 2005-2021 Stanford University and the Authors                *
+ * Author(s): OpenSim Team                                                    *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "NativeCodeCache.h"
+
+#include "IO.h"
+#include "Logger.h"
+
+#include <atomic>
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace OpenSim;
+
+namespace {
+
+#ifdef _WIN32
+const char PathSeparators[] = "/\\";
+#else
+const char PathSeparators[] = "/";
+#endif
+
+std::string readFile(const std::string& path) {
+    std::ifstream file(path);
+    std::stringstream contents;
+    contents << file.rdbuf();
+    return contents.str();
+}
+
+// Quote a path for the shell that std::system() invokes.
+std::string quote(const std::string& path) {
+#ifdef _WIN32
+    return "\"" + path + "\"";
+#else
+    std::string quoted = "'";
+    for (const char c : path) {
+        if (c == '\'') quoted += "'\\''";
+        else quoted += c;
+    }
+    return quoted + "'";
+#endif
+}
+
+// The compiler command may contain arguments (e.g., "ccache g++"), so it is
+// not quoted; instead, we only allow characters that the shell does not
+// interpret.
+bool isAllowedCompiler(const std::string& compiler) {
+    if (compiler.empty()) return false;
+    for (const char c : compiler) {
+        if (std::isalnum((unsigned char)c)) continue;
+        if (std::string(" ._-+/=,:").find(c) != std::string::npos) continue;
+#ifdef _WIN32
+        if (c == '\\') continue;
+#endif
+        return false;
+    }
+    return true;
+}
+
+// A path is private if it is owned by the current user and is not writable
+// by the group or by others.
+bool isPrivate(const std::string& path, bool directory) {
+#ifdef _WIN32
+    return directory || IO::FileExists(path);
+#else
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0) return false;
+    if (directory ? !S_ISDIR(info.st_mode) : !S_ISREG(info.st_mode)) {
+        return false;
+    }
+    return info.st_uid == geteuid() &&
+           (info.st_mode & (S_IWGRP | S_IWOTH)) == 0;
+#endif
+}
+
+void makePrivate(const std::string& path, bool executable) {
+#ifndef _WIN32
+    chmod(path.c_str(), executable ? S_IRWXU : (S_IRUSR | S_IWUSR));
+#endif
+}
+
+// Create the directory and any missing parents (IO::makeDir() creates them
+// with mode 0700).
+void makeDirectories(const std::string& directory) {
+    std::string::size_type pos = 0;
+    while (pos != std::string::npos) {
+        pos = directory.find_first_of(PathSeparators, pos + 1);
+        const std::string parent = directory.substr(0, pos);
+        if (!parent.empty()) IO::makeDir(parent);
+    }
+}
+
+// A suffix for temporary files that is unique to this process and thread.
+std::string getUniqueSuffix() {
+    static std::atomic<int> counter{0};
+#ifdef _WIN32
+    const int pid = _getpid();
+#else
+    const int pid = (int)getpid();
+#endif
+    return std::to_string(pid) + "_" + std::to_string(counter++);
+}
+
+} // anonymous namespace
+
+std::string NativeCodeCache::getDefaultDirectory(const std::string& name) {
+#ifdef _WIN32
+    const char* localAppData = std::getenv("LOCALAPPDATA");
+    if (!localAppData) return "";
+    return std::string(localAppData) + "/opensim/" + name;
+#else
+    const char* cacheHome = std::getenv("XDG_CACHE_HOME");
+    if (cacheHome && cacheHome[0] == '/') {
+        return std::string(cacheHome) + "/opensim/" + name;
+    }
+    const char* home = std::getenv("HOME");
+    if (!home || !home[0]) return "";
+    return std::string(home) + "/.cache/opensim/" + name;
+#endif
+}
+
+std::string NativeCodeCache::getLibrary(const std::string& directory,
+        const std::string& name, const std::string& source,
+        const std::string& sourceExtension, const std::string& compiler,
+        const std::string& flags) {
+    if (directory.empty()) {
+        log_warn("NativeCodeCache: no cache directory for {}; set HOME or "
+                 "choose a directory.", name);
+        return "";
+    }
+    makeDirectories(directory);
+    if (!isPrivate(directory, true)) {
+        log_warn("NativeCodeCache: not using '{}' because it is not a "
+                 "directory that only the current user can write to.",
+                directory);
+        return "";
+    }
+
+    // FNV-1a hash of the source code.
+    std::uint64_t hash = 14695981039346656037ull;
+    for (const char c : source) {
+        hash = (hash ^ (unsigned char)c) * 1099511628211ull;
+    }
+    std::ostringstream base;
+    base << directory << "/" << name << "_" << std::hex << hash;
+    const std::string sourceFile = base.str() + "." + sourceExtension;
+#if defined(_WIN32)
+    const std::string libraryExtension = ".dll";
+#elif defined(__APPLE__)
+    const std::string libraryExtension = ".dylib";
+#else
+    const std::string libraryExtension = ".so";
+#endif
+    const std::string library = base.str() + libraryExtension;
+
+    // The source code is stored next to the library, to detect collisions
+    // of the hash.
+    if (isPrivate(library, false) && isPrivate(sourceFile, false) &&
+            readFile(sourceFile) == source) {
+        return library;
+    }
+
+    if (!isAllowedCompiler(compiler)) {
+        log_warn("NativeCodeCache: not compiling {} because the compiler "
+                 "command '{}' contains characters other than letters, "
+                 "digits, spaces, and ._-+/=,:.", name, compiler);
+        return "";
+    }
+    // Write to files whose names are unique to this process and thread and
+    // then rename them, so that nobody loads a partially written library.
+    const std::string temp = base.str() + "_" + getUniqueSuffix();
+    const std::string tempSource = temp + "." + sourceExtension;
+    const std::string tempLibrary = temp + libraryExtension;
+    {
+        std::ofstream file(tempSource);
+        file << source;
+    }
+    makePrivate(tempSource, false);
+    const std::string command = compiler + " " + flags + " -o " +
+                                quote(tempLibrary) + " " + quote(tempSource);
+    log_info("Compiling {}.", sourceFile);
+    if (std::system(command.c_str()) != 0) {
+        log_warn("NativeCodeCache: failed to compile {} with '{}'.", name,
+                command);
+        std::remove(tempSource.c_str());
+        std::remove(tempLibrary.c_str());
+        return "";
+    }
+    makePrivate(tempLibrary, true);
+    std::rename(tempLibrary.c_str(), library.c_str());
+    std::rename(tempSource.c_str(), sourceFile.c_str());
+    return library;
+}
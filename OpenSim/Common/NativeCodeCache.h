@@ -0,0 +1,73 @@
+#ifndef OPENSIM_NATIVE_CODE_CACHE_H_
+#define OPENSIM_NATIVE_CODE_CACHE_H_
+/* -------------------------------------------------------------------------- *
+ *                        OpenSim:  NativeCodeCache.h                         *
+ * -------------------------------------------------------------------------- *
+ * The OpenSim API is a toolkit for musculoskeletal modeling and simulation.  *
+ * See http://opensim.stanford.edu and the NOTICE file for more information.  *
+ * OpenSim is developed at Stanford University and supported by the US        *
+ * National Institutes of Health (U54 GM072970, R24 HD065690) and by DARPA    *
+ * through the Warrior Web program.                                           *
+ *                                                                            *
+ * Copyright (c) 2005-2021 Stanford University and the Authors                *
+ * Author(s): OpenSim Team                                                    *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "osimCommonDLL.h"
+
+#include <string>
+
+namespace OpenSim {
+
+/** Compiles generated source code into shared libraries that are cached on
+disk, so that the same source code is compiled only once across processes.
+This is used by CompiledExpressions and by MocoCasADiSolver's code
+generation.
+
+A library is named by a hash of its source code, and the source code is
+stored next to it to detect collisions of the hash. Since the library is
+loaded into the process, the cache directory must be private to the user:
+on POSIX systems, it is created with mode 0700, and the cache is used only if
+the directory, the library, and the source code are owned by the current
+user and are not writable by the group or by others. The compiler command
+may only contain characters that the shell does not interpret.
+@ingroup commonutil */
+class OSIMCOMMON_API NativeCodeCache {
+public:
+    /** The default cache directory for the given kind of code (e.g.,
+    "expressions"): `opensim/<name>` in the user's cache directory, that is,
+    `$XDG_CACHE_HOME`, or `$HOME/.cache` if XDG_CACHE_HOME is not set
+    (`%LOCALAPPDATA%` on Windows). Returns an empty string if none of these
+    variables is set. */
+    static std::string getDefaultDirectory(const std::string& name);
+
+    /** Get the path to a shared library compiled from `source`, compiling the
+    source code if the library is not already in `directory` (which is
+    created, along with its parents, if it does not exist). The compiler is
+    invoked as `<compiler> <flags> -o <library> <source file>`, where the
+    source file has the extension `sourceExtension` (e.g., "c" or "cpp") and
+    `flags` must produce a shared library (e.g., "-O2 -shared -fPIC").
+    Processes and threads can share the directory: the files are written
+    under unique names and then renamed.
+    @returns the path to the library, or an empty string (after logging a
+    warning) if the directory is not private to the user, the compiler
+    command is not allowed, or compiling fails. */
+    static std::string getLibrary(const std::string& directory,
+            const std::string& name, const std::string& source,
+            const std::string& sourceExtension, const std::string& compiler,
+            const std::string& flags);
+};
+
+} // namespace OpenSim
+
+#endif // OPENSIM_NATIVE_CODE_CACHE_H_
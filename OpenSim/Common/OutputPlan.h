@@ -0,0 +1,208 @@
+#ifndef OPENSIM_OUTPUT_PLAN_H_
+#define OPENSIM_OUTPUT_PLAN_H_
+/* -------------------------------------------------------------------------- *
+ *                          OpenSim:  OutputPlan.h                            *
+ * -------------------------------------------------------------------------- *
+ * The OpenSim API is a toolkit for musculoskeletal modeling and simulation.  *
+ * See http://opensim.stanford.edu and the NOTICE file for more information.  *
+ * OpenSim is developed at Stanford University and supported by the US        *
+ * National Institutes of Health (U54 GM072970, R24 HD065690) and by DARPA    *
+ * through the Warrior Web program.                                           *
+ *                                                                            *
+ * Copyright (c) 2005-2021 Stanford University and the Authors                *
+ * Author(s): OpenSim Team                                                    *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "Component.h"
+
+#include <algorithm>
+#include <regex>
+
+namespace OpenSim {
+
+/** A list of Output%s (or rather, their Channel%s) of type T, resolved once,
+that can be evaluated repeatedly into a preallocated row.
+
+Connecting outputs to a TableReporter_ is convenient for reporting during a
+simulation, but each report goes through the reporter's Input, allocates a
+new row, and grows the table by one row. When the same outputs are evaluated
+at many states (e.g., in analyze()), an OutputPlan avoids that overhead: the
+outputs are looked up once, and evaluate() writes their values directly into
+a row that you provide (e.g., a row of a preallocated SimTK::Matrix_).
+
+The channels are evaluated in the order of the stage on which they depend
+(Output::getDependsOnStage()), and getRequiredStage() tells you how far a
+state must be realized to evaluate the entire plan. You can also evaluate
+the channels of one stage at a time. The required stage is only as reliable
+as the stages the outputs declare: an output whose value depends on a later
+stage than its dependsOn stage (e.g., one that reads a cache variable
+computed in extendRealizeReport()) may throw or return a stale value. Realize
+to Stage::Report (as analyze() does) unless you know the declared stages
+are accurate.
+
+@code
+OutputPlan<double> plan;
+plan.addOutputsMatching(model, {".*activation", ".*fiber_length"});
+SimTK::Matrix values(numStates, plan.getNumChannels());
+for (int i = 0; i < numStates; ++i) {
+    model.getSystem().realize(states[i], plan.getRequiredStage());
+    auto row = values.updRow(i);
+    plan.evaluate(states[i], row);
+}
+@endcode
+
+The plan holds pointers to the outputs of the components; create it after
+finalizing the components (e.g., after Model::initSystem()) and do not use
+it after the components are modified or destroyed.
+@ingroup reporters */
+template <typename T>
+class OutputPlan {
+public:
+    OutputPlan() = default;
+
+    /** Add all channels of the outputs of the subcomponents of `root` whose
+    path (e.g., `/forceset/soleus|activation`) matches any of the regular
+    expressions in `outputPaths`. The expressions are compiled once. Matching
+    outputs whose type is not T are skipped (with a warning). Each output is
+    added at most once, even if it matches multiple expressions.
+    @returns the number of channels added. */
+    int addOutputsMatching(const Component& root,
+            const std::vector<std::string>& outputPaths) {
+        std::vector<std::regex> regexes;
+        regexes.reserve(outputPaths.size());
+        for (const auto& outputPath : outputPaths) {
+            regexes.emplace_back(outputPath);
+        }
+        const int numChannelsBefore = getNumChannels();
+        for (const auto& comp : root.getComponentList()) {
+            for (const auto& outputName : comp.getOutputNames()) {
+                const auto& output = comp.getOutput(outputName);
+                const auto thisOutputPath = output.getPathName();
+                const bool matches = std::any_of(regexes.begin(),
+                        regexes.end(), [&](const std::regex& regex) {
+                            return std::regex_match(thisOutputPath, regex);
+                        });
+                if (!matches) continue;
+                // Make sure the output type agrees with the template.
+                if (const auto* outputT =
+                                dynamic_cast<const Output<T>*>(&output)) {
+                    log_debug("Adding output {} of type {}.",
+                            output.getPathName(), output.getTypeName());
+                    addOutput(*outputT);
+                } else {
+                    log_warn("Ignoring output {} of type {}.",
+                            output.getPathName(), output.getTypeName());
+                }
+            }
+        }
+        return getNumChannels() - numChannelsBefore;
+    }
+
+    /** Add all channels of the provided output (one channel for a
+    single-value output). The column label for each channel is its path
+    (AbstractChannel::getPathName()). */
+    void addOutput(const Output<T>& output) {
+        const SimTK::Stage& stage = output.getDependsOnStage();
+        for (const auto& it : output.getChannels()) {
+            Entry entry;
+            entry.channel = &it.second;
+            entry.stage = stage;
+            entry.column = getNumChannels();
+            m_labels.push_back(it.second.getPathName());
+            // Keep the entries sorted by stage; within a stage, entries stay
+            // in the order they were added.
+            const auto pos = std::upper_bound(m_entries.begin(),
+                    m_entries.end(), entry,
+                    [](const Entry& a, const Entry& b) {
+                        return a.stage < b.stage;
+                    });
+            m_entries.insert(pos, entry);
+        }
+        if (stage > m_requiredStage) m_requiredStage = stage;
+    }
+
+    /** The number of values in a row; this is the number of channels in the
+    plan. */
+    int getNumChannels() const { return (int)m_entries.size(); }
+
+    /** The labels (channel paths) of the columns of a row, in the order in
+    which the channels were added. */
+    const std::vector<std::string>& getLabels() const { return m_labels; }
+
+    /** The highest stage on which any of the channels depend. A state must be
+    realized to this stage to evaluate the whole plan. */
+    const SimTK::Stage& getRequiredStage() const { return m_requiredStage; }
+
+    /** Evaluate all channels, writing the value of each channel to its column
+    in `row`, which must have getNumChannels() elements. No memory is
+    allocated.
+    @throws SimTK::Exception::StageTooLow if the state is not realized to
+    getRequiredStage(). */
+    void evaluate(const SimTK::State& state,
+            SimTK::RowVectorBase<T>& row) const {
+        checkRow(row);
+        checkStage(state, m_requiredStage);
+        for (const auto& entry : m_entries) {
+            row[entry.column] = entry.channel->getValue(state);
+        }
+    }
+
+    /** Evaluate only the channels that depend on the given stage, leaving the
+    other elements of `row` untouched. This allows you to interleave
+    realization and evaluation.
+    @throws SimTK::Exception::StageTooLow if the state is not realized to
+    `stage`. */
+    void evaluate(const SimTK::State& state, const SimTK::Stage& stage,
+            SimTK::RowVectorBase<T>& row) const {
+        checkRow(row);
+        checkStage(state, stage);
+        Entry key;
+        key.stage = stage;
+        const auto range = std::equal_range(m_entries.begin(),
+                m_entries.end(), key, [](const Entry& a, const Entry& b) {
+                    return a.stage < b.stage;
+                });
+        for (auto it = range.first; it != range.second; ++it) {
+            row[it->column] = it->channel->getValue(state);
+        }
+    }
+
+private:
+    struct Entry {
+        const typename Output<T>::Channel* channel = nullptr;
+        SimTK::Stage stage = SimTK::Stage::Empty;
+        int column = -1;
+    };
+
+    void checkRow(const SimTK::RowVectorBase<T>& row) const {
+        OPENSIM_THROW_IF(row.size() != getNumChannels(), Exception,
+                "Expected row to have {} elements, but it has {}.",
+                getNumChannels(), row.size());
+    }
+
+    static void checkStage(const SimTK::State& state,
+            const SimTK::Stage& stage) {
+        if (state.getSystemStage() < stage) {
+            throw SimTK::Exception::StageTooLow(__FILE__, __LINE__,
+                    state.getSystemStage(), stage, "OutputPlan::evaluate()");
+        }
+    }
+
+    std::vector<Entry> m_entries;
+    std::vector<std::string> m_labels;
+    SimTK::Stage m_requiredStage = SimTK::Stage::Empty;
+};
+
+} // namespace OpenSim
+
+#endif // OPENSIM_OUTPUT_PLAN_H_
@@ -205,7 +205,8 @@ public:
 protected:
     void implementReport(const SimTK::State& state) const override {
         const auto& input = this->template getInput<InputT>("inputs");
-        SimTK::RowVector_<ValueT> result;
+        // Reuse the row from the previous report to avoid reallocating it.
+        auto& result = _row;
         result.resize(int(input.getNumConnectees()));
 
         for (auto idx = 0u; idx < input.getNumConnectees(); ++idx) {
@@ -251,6 +252,8 @@ private:
     // We write to this table in const methods, but only because we ensure
     // those const methods are never called with trial integrator states.
     TimeSeriesTable_<ValueT> _outputTable;
+    // Scratch space for the row being reported.
+    mutable SimTK::RowVector_<ValueT> _row;
 };
 
 /** A reporter that simply prints quantities to the console
@@ -24,7 +24,11 @@
 // INCLUDES
 //=============================================================================
 #include "SmoothSegmentedFunction.h"
+#include <cstring>
 #include <fstream>
+#include <list>
+#include <mutex>
+#include <unordered_map>
 #include "simmath/internal/SplineFitter.h"
 
 //=============================================================================
@@ -39,6 +43,116 @@ static double UTOL = (double)SimTK::Eps*1e2;
 static double INTTOL = (double)SimTK::Eps*1e2;
 static int MAXITER = 20;
 static int NUM_SAMPLE_PTS = 100;
+
+namespace {
+// Fitting the splines that approximate u(x) (and, optionally, the integral of
+// y(x)) dominates the cost of constructing a SmoothSegmentedFunction. A model
+// often contains many identical curves (e.g., the default curves of every
+// muscle of the same type), and every copy of a model (Model::clone(), one
+// per thread in parallel workflows) rebuilds all of its curves. Therefore, we
+// keep the fits for each distinct set of inputs and reuse them. The cache
+// holds the fits of at most MAX_CACHED_FITS distinct curves (evicting the
+// least recently used), so that processes that create many different curves
+// (e.g., parameter sweeps) do not grow without bound.
+//
+// The cache stores, and hands out, deep copies of the splines: SimTK::Spline
+// shares its implementation among copies using a reference count that is not
+// thread-safe, and curves may be constructed and destroyed on different
+// threads.
+struct FittedSplines {
+    SimTK::Array_<SimTK::Spline> splineUX;
+    // Only valid if hasIntegral is true; otherwise, the Spline is empty.
+    SimTK::Spline splineYintX;
+    bool hasIntegral = false;
+};
+
+SimTK::Spline copySpline(const SimTK::Spline& spline) {
+    return SimTK::Spline(spline.getSplineDegree(),
+            spline.getControlPointLocations(),
+            spline.getControlPointValues());
+}
+
+void appendToKey(std::string& key, double value) {
+    char bytes[sizeof(double)];
+    std::memcpy(bytes, &value, sizeof(double));
+    key.append(bytes, sizeof(double));
+}
+
+std::string createFitKey(const SimTK::Matrix& mX, const SimTK::Matrix& mY,
+        bool computeIntegral, bool intx0x1) {
+    std::string key;
+    key.reserve(sizeof(double) * 2 * mX.nrow() * mX.ncol() + 3);
+    key.push_back(static_cast<char>(computeIntegral));
+    key.push_back(static_cast<char>(intx0x1));
+    key.push_back(static_cast<char>(mX.nrow()));
+    for (int j = 0; j < mX.ncol(); ++j) {
+        for (int i = 0; i < mX.nrow(); ++i) {
+            appendToKey(key, mX(i, j));
+            appendToKey(key, mY(i, j));
+        }
+    }
+    return key;
+}
+
+const int MAX_CACHED_FITS = 1000;
+
+// The keys, from most to least recently used, and the fits for each key.
+struct FitCache {
+    std::list<std::string> keys;
+    std::unordered_map<std::string,
+            std::pair<FittedSplines, std::list<std::string>::iterator>>
+            fits;
+};
+
+std::mutex& getFitCacheMutex() {
+    static std::mutex mutex;
+    return mutex;
+}
+
+FitCache& getFitCache() {
+    static FitCache cache;
+    return cache;
+}
+
+bool findFittedSplines(const std::string& key,
+        SimTK::Array_<SimTK::Spline>& splineUX, SimTK::Spline& splineYintX) {
+    std::lock_guard<std::mutex> lock(getFitCacheMutex());
+    FitCache& cache = getFitCache();
+    const auto it = cache.fits.find(key);
+    if (it == cache.fits.end()) return false;
+    cache.keys.splice(cache.keys.begin(), cache.keys, it->second.second);
+    const FittedSplines& fits = it->second.first;
+    splineUX.resize(fits.splineUX.size());
+    for (int s = 0; s < (int)fits.splineUX.size(); ++s) {
+        splineUX[s] = copySpline(fits.splineUX[s]);
+    }
+    if (fits.hasIntegral) splineYintX = copySpline(fits.splineYintX);
+    return true;
+}
+
+void storeFittedSplines(const std::string& key,
+        const SimTK::Array_<SimTK::Spline>& splineUX,
+        const SimTK::Spline& splineYintX, bool hasIntegral) {
+    FittedSplines fits;
+    fits.splineUX.resize(splineUX.size());
+    for (int s = 0; s < (int)splineUX.size(); ++s) {
+        fits.splineUX[s] = copySpline(splineUX[s]);
+    }
+    if (hasIntegral) fits.splineYintX = copySpline(splineYintX);
+    fits.hasIntegral = hasIntegral;
+    std::lock_guard<std::mutex> lock(getFitCacheMutex());
+    FitCache& cache = getFitCache();
+    // Another thread may have fitted the same curve in the meantime.
+    if (cache.fits.count(key)) return;
+    cache.keys.push_front(key);
+    cache.fits.insert(std::make_pair(key,
+            std::make_pair(std::move(fits), cache.keys.begin())));
+    if ((int)cache.keys.size() > MAX_CACHED_FITS) {
+        cache.fits.erase(cache.keys.back());
+        cache.keys.pop_back();
+    }
+}
+} // anonymous namespace
 //=============================================================================
 // UTILITY FUNCTIONS
 //=============================================================================
@@ -97,10 +211,23 @@ SmoothSegmentedFunction::
 _x0(x0),_x1(x1),_y0(y0),_y1(y1),_dydx0(dydx0),_dydx1(dydx1),
      _computeIntegral(computeIntegral),_intx0x1(intx0x1),_name(name)
 {
-    
-
     _numBezierSections = mX.ncol();
 
+    _mXVec.resize(_numBezierSections);
+    _mYVec.resize(_numBezierSections);
+    for(int s=0; s < _numBezierSections; s++){
+        _mXVec[s] = mX(s); 
+        _mYVec[s] = mY(s); 
+    }
+
+    // The fits depend only on the control points and on the integral
+    // settings; the end points, slopes, and name do not affect them.
+    const std::string fitKey =
+            createFitKey(mX, mY, _computeIntegral, _intx0x1);
+    if (findFittedSplines(fitKey, _arraySplineUX, _splineYintX)) {
+        return;
+    }
+
     //////////////////////////////////////////////////
     //Generate the set of splines that approximate u(x)
     //////////////////////////////////////////////////
@@ -154,13 +281,8 @@ _x0(x0),_x1(x1),_y0(y0),_y1(y1),_dydx0(dydx0),_dydx1(dydx1),
         _splineYintX = SimTK::SplineFitter<Real>::
                 fitForSmoothingParameter(3,yInt(0),yInt(1),0).getSpline();
     }
-    
-    _mXVec.resize(_numBezierSections);
-    _mYVec.resize(_numBezierSections);
-    for(int s=0; s < _numBezierSections; s++){
-        _mXVec[s] = mX(s); 
-        _mYVec[s] = mY(s); 
-    }
+
+    storeFittedSplines(fitKey, _arraySplineUX, _splineYintX, _computeIntegral);
 }
 
  SmoothSegmentedFunction::SmoothSegmentedFunction():
@@ -363,6 +363,9 @@ public:
     bool print(const std::string &aFileName,const std::string &aMode="w", const std::string& aComment="") const;
     int print(const std::string &aFileName,double aDT,const std::string &aMode="w") const;
     void setOutputFileName(const std::string& aFileName) override ;
+    /** Whether appended rows are also written to an output file (see
+    setOutputFileName()). */
+    bool hasOutputFile() const { return _fp != 0; }
     // convenience function for Analyses and DerivCallbacks
     static void printResult(const Storage *aStorage,const std::string &aName,
         const std::string &aDir,double aDT,const std::string &aExtension);
@@ -1,5 +1,8 @@
 #include "TRCFileAdapter.h"
 #include <OpenSim/Common/IO.h>
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
 #include <fstream>
 #include <iomanip>
 
@@ -27,6 +30,18 @@ TRCFileAdapter::clone() const {
     return new TRCFileAdapter{*this};
 }
 
+TimeSeriesTableVec3
+TRCFileAdapter::readMarkers(const std::string& fileName,
+                            const std::vector<std::string>& markerNames) {
+    TRCFileAdapter adapter{};
+    adapter._markerNamesToRead = markerNames;
+    // An empty list reads all of the markers; read none instead.
+    if (markerNames.empty()) adapter._markerNamesToRead.push_back("");
+    auto tables = adapter.extendRead(fileName);
+    return *std::static_pointer_cast<TimeSeriesTableVec3>(
+            tables.at(_markers));
+}
+
 void 
 TRCFileAdapter::write(const TimeSeriesTableVec3& table, 
                       const std::string& fileName) {
@@ -156,24 +171,81 @@ TRCFileAdapter::extendRead(const std::string& fileName) const {
         }
     }
 
+    // The markers to read, as indices into column_labels: all of them, or
+    // only the requested ones (in the order of the file).
+    std::vector<int> markers{};
+    for (int i = 0; i < (int)column_labels.size(); ++i) {
+        if (_markerNamesToRead.empty() ||
+                std::find(_markerNamesToRead.begin(), _markerNamesToRead.end(),
+                        column_labels[i]) != _markerNamesToRead.end()) {
+            markers.push_back(i);
+        }
+    }
+    const int numMarkers = static_cast<int>(markers.size());
+
+    // The data rows are split into fields in place, without creating a
+    // string per field, and only the fields of the markers to read are
+    // converted to numbers. Fields are delimited as by getNextLine().
+    struct Field { std::size_t begin, end; };
+    std::string line{};
+    std::vector<Field> row{};
+    auto nextRow = [&] {
+        row.clear();
+        if (!std::getline(in_stream, line)) return false;
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        auto addField = [&](std::size_t begin, std::size_t end) {
+            while (begin < end && std::isspace((unsigned char)line[begin]))
+                ++begin;
+            while (end > begin && std::isspace((unsigned char)line[end - 1]))
+                --end;
+            row.push_back({begin, end});
+        };
+        std::size_t begin{0}, end{};
+        while ((end = line.find_first_of(_delimitersRead, begin)) !=
+                std::string::npos) {
+            addField(begin, end);
+            begin = end + 1;
+        }
+        if (line.size() > begin) addField(begin, line.size());
+        return true;
+    };
+    auto isEmpty = [&](std::size_t field) {
+        return row[field].begin == row[field].end;
+    };
+    std::size_t line_num{_dataStartsAtLine};
+    auto toDouble = [&](std::size_t field) {
+        const char* first = line.c_str() + row[field].begin;
+        char* last{};
+        const double value = std::strtod(first, &last);
+        OPENSIM_THROW_IF(last == first, IOError,
+                "Expected a number in field {} of line {} of file '{}', but "
+                "got '{}'.", field + 1, line_num, fileName,
+                line.substr(row[field].begin,
+                        row[field].end - row[field].begin));
+        return value;
+    };
+
     // Read the rows one at a time and fill up the time column container and
     // the data container.
-    std::size_t line_num{_dataStartsAtLine};
-    std::vector<std::string> row = nextLine();
+    nextRow();
     // skip immediate blank lines between header and data.
-    while(row.empty() || row.at(0).empty()) {
-        row = nextLine();
-        ++line_num;
-    }
+    while((row.empty() || isEmpty(0)) && nextRow()) ++line_num;
     
     const size_t expected{ column_labels.size() * 3 + 2 };
     // Will first store data in a SimTK::Matrix to avoid expensive calls 
     // to the table's appendRow() which reallocates and copies the whole table.
+    // Allocate for the number of frames in the header, if it is valid, so
+    // that the data is not copied as it grows.
+    int capacity = 1024;
+    try {
+        const int numFrames = std::stoi(metaData.getValueForKey(
+                _numFramesLabel).getValue<std::string>());
+        if (numFrames > 0) capacity = numFrames;
+    } catch (const std::exception&) {}
     int rowNumber = 0;
-    int last_size = 1024; 
-    SimTK::Matrix_<SimTK::Vec3> markerData{last_size, static_cast<int>(num_markers_expected)};
+    SimTK::Matrix_<SimTK::Vec3> markerData{capacity, numMarkers};
     std::vector<double> times;
-    times.resize(last_size);
+    times.resize(capacity);
 
     // An empty line during data parsing denotes end of data
     while (!row.empty()) {
@@ -184,44 +256,42 @@ TRCFileAdapter::extendRead(const std::string& fileName) const {
                          expected,
                          row.size());
 
+        if (rowNumber == capacity) {
+            // resize all Data/Matrices, double the size  while keeping data
+            capacity *= 2;
+            times.resize(capacity);
+            markerData.resizeKeep(capacity, numMarkers);
+        }
         // Columns 2 till the end are data.
-        TimeSeriesTableVec3::RowVector 
-            row_vector{static_cast<int>(num_markers_expected), 
-                       SimTK::Vec3(SimTK::NaN)};
-        int ind{0};
-        for (std::size_t c = 2; c < column_labels.size() * 3 + 2; c += 3) {
+        for (int m = 0; m < numMarkers; ++m) {
+            const std::size_t c = 2 + 3 * markers[m];
             //only if each component is specified read process as a Vec3
-            if ( !(row.at(c).empty() || row.at(c + 1).empty() 
-                                     || row.at(c + 2).empty()) ) {
-                row_vector[ind] = SimTK::Vec3{ std::stod(row.at(c)),
-                                               std::stod(row.at(c + 1)),
-                                               std::stod(row.at(c + 2)) };
-            } // otherwise the value will remain NaN (default)
-            ++ind;
+            if ( !(isEmpty(c) || isEmpty(c + 1) || isEmpty(c + 2)) ) {
+                markerData(rowNumber, m) = SimTK::Vec3{ toDouble(c),
+                                                        toDouble(c + 1),
+                                                        toDouble(c + 2) };
+            } else {
+                markerData(rowNumber, m) = SimTK::Vec3(SimTK::NaN);
+            }
         }
-        markerData[rowNumber] = row_vector;
         // Column 1 is time.
-        times[rowNumber] = std::stod(row.at(1));
+        times[rowNumber] = toDouble(1);
         rowNumber++;
-        if (rowNumber== last_size) {
-            // resize all Data/Matrices, double the size  while keeping data
-            int newSize = last_size * 2;
-            times.resize(newSize);
-            // Repeat for Data matrices in use
-            markerData.resizeKeep(newSize, (int)num_markers_expected);
-            last_size = newSize;
-        }
-        row = nextLine();
+        nextRow();
         ++line_num;
     }
     // Trim Matrices in use to actual data and move into tables
     times.resize(rowNumber);
-    markerData.resizeKeep(rowNumber, (int)num_markers_expected);
+    markerData.resizeKeep(rowNumber, numMarkers);
 
     // Set the column labels of the table.
     std::vector<std::string> labels{};
-    for(const auto& cl : column_labels)
-            labels.push_back(SimTK::Value<std::string>{cl});
+    for (int m : markers)
+            labels.push_back(column_labels[m]);
+    if (!_markerNamesToRead.empty()) {
+        metaData.removeValueForKey(_numMarkersLabel);
+        metaData.setValueForKey(_numMarkersLabel, std::to_string(numMarkers));
+    }
     auto table = std::make_shared<TimeSeriesTableVec3>(
             times, markerData, labels);
     table->updTableMetaData() = metaData;
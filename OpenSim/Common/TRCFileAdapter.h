@@ -151,6 +151,16 @@ public:
     static
     void write(const TimeSeriesTableVec3& table, const std::string& filename);
 
+    /** Read only the given markers from a TRC file. The columns of the table
+    are in the order in which the markers appear in the file; markers that
+    are not in the file are ignored. Only the coordinates of these markers
+    are converted to numbers, so this is much faster than reading the whole
+    file when only some of its markers are needed (e.g., by the tasks of
+    an inverse kinematics problem).                                           */
+    static
+    TimeSeriesTableVec3 readMarkers(const std::string& filename,
+                                    const std::vector<std::string>& markerNames);
+
     /** Key used for table associative array returned/accepted by write/read. */
     static const std::string              _markers;
 
@@ -187,6 +197,9 @@ private:
     static const unsigned                 _dataStartsAtLine;
     /** Ordered collection of metadata keys.                                  */
     static const std::vector<std::string> _metadataKeys;
+
+    /** Markers to read; all markers are read if empty.                      */
+    std::vector<std::string>              _markerNamesToRead;
 };
 
 } // namespace OpenSim
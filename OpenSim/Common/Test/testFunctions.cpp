@@ -33,6 +33,8 @@
 #include <OpenSim/Auxiliary/catch.hpp>
 #include <OpenSim/Common/PolynomialFunction.h>
 
+#include <thread>
+
 using namespace OpenSim;
 using namespace SimTK;
 
@@ -175,3 +177,29 @@ TEST_CASE("solveBisection()") {
         REQUIRE_THROWS_AS(solveBisection(parabola, -5, 5), OpenSim::Exception);
     }
 }
+
+TEST_CASE("ThreadsafeJar gives a thread the object it returned") {
+    ThreadsafeJar<int> jar;
+    for (int i = 0; i < 3; ++i) jar.leave(std::unique_ptr<int>(new int(i)));
+
+    // Another thread returns an object; this thread should not get it back
+    // while this thread's own objects are available.
+    int otherValue = -1;
+    std::thread other([&]() {
+        auto object = jar.take();
+        otherValue = *object;
+        jar.leave(std::move(object));
+    });
+    other.join();
+    CHECK(jar.size() == 3);
+
+    auto object = jar.take();
+    CHECK(*object != otherValue);
+    const int value = *object;
+    jar.leave(std::move(object));
+    for (int i = 0; i < 5; ++i) {
+        object = jar.take();
+        CHECK(*object == value);
+        jar.leave(std::move(object));
+    }
+}
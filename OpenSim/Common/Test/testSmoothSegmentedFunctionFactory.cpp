@@ -1907,6 +1907,40 @@ int main(int argc, char* argv[])
                 fiberfalCurve.printMuscleCurveToCSVFile("C:/aBadPath",0,2.0));
             //fiberfalCurve.printMuscleCurveToCSVFile("C:/mjhmilla/Stanford/dev");
             cout << "    passed"<<endl;
+
+        ///////////////////////////////////////
+        //REUSE OF SPLINE FITS
+        ///////////////////////////////////////
+            cout <<"**************************************************"<<endl;
+            cout <<"REUSE OF SPLINE FITS FOR IDENTICAL CURVES         "<<endl;
+            // Curves with identical control points reuse earlier spline
+            // fits; they must be indistinguishable from the original curve
+            // (except for the name) and independent of it.
+            {
+                auto tendonCurveCopy_ptr =
+                    std::unique_ptr<SmoothSegmentedFunction>{
+                    SmoothSegmentedFunctionFactory::
+                    createTendonForceLengthCurve(e0, kiso, ftoe, c, true,
+                                                 "test_tendonCurveCopy")};
+                auto noIntegral_ptr =
+                    std::unique_ptr<SmoothSegmentedFunction>{
+                    SmoothSegmentedFunctionFactory::
+                    createTendonForceLengthCurve(e0, kiso, ftoe, c, false,
+                                                 "test_tendonCurveNoInt")};
+                SimTK_TEST(tendonCurveCopy_ptr->getName() ==
+                        "test_tendonCurveCopy");
+                SimTK_TEST(tendonCurveCopy_ptr->isIntegralAvailable());
+                SimTK_TEST(!noIntegral_ptr->isIntegralAvailable());
+                SimTK::Matrix copySample =
+                    tendonCurveCopy_ptr->calcSampledMuscleCurve(6,1.0,1+e0);
+                SimTK_TEST(copySample.nrow() == tendonCurveSample.nrow());
+                SimTK_TEST_EQ(copySample, tendonCurveSample);
+                SimTK_TEST_EQ(noIntegral_ptr->calcValue(1+0.5*e0),
+                              tendonCurve.calcValue(1+0.5*e0));
+            }
+            // The original is unaffected by destroying the copies.
+            SimTK_TEST_EQ(tendonCurve.calcValue(1+e0), 1.0);
+            cout << "    passed"<<endl;
         SimTK_END_TEST();
 
     }
@@ -186,6 +186,44 @@ int main() {
         }
     }
 
+    std::cout << "Testing TRCFileAdapter::readMarkers()" << std::endl;
+    for (const auto& filename : filenames) {
+        try {
+            std::cout << "  " << filename << std::endl;
+            TimeSeriesTableVec3 table{filename};
+            const auto& labels = table.getColumnLabels();
+            // Columns are in the order of the file, regardless of the order
+            // of the names; unknown names are ignored.
+            std::vector<std::string> names{"not_a_marker", labels.back(),
+                                           labels.front()};
+            const auto subset = TRCFileAdapter::readMarkers(filename, names);
+            const size_t numExpected = labels.size() > 1 ? 2 : 1;
+            OPENSIM_THROW_IF(subset.getNumColumns() != numExpected,
+                    OpenSim::Exception,
+                    "Expected {} columns, but got {}.", numExpected,
+                    subset.getNumColumns());
+            OPENSIM_THROW_IF(subset.getIndependentColumn() !=
+                                     table.getIndependentColumn(),
+                    OpenSim::Exception, "Times do not match.");
+            for (const auto& label : subset.getColumnLabels()) {
+                const auto expected = table.getDependentColumn(label);
+                const auto actual = subset.getDependentColumn(label);
+                for (int i = 0; i < expected.size(); ++i) {
+                    for (int k = 0; k < 3; ++k) {
+                        OPENSIM_THROW_IF(!(actual[i][k] == expected[i][k] ||
+                                (SimTK::isNaN(actual[i][k]) &&
+                                        SimTK::isNaN(expected[i][k]))),
+                                OpenSim::Exception,
+                                "Values of marker '{}' do not match.", label);
+                    }
+                }
+            }
+        } catch (std::exception& ex) {
+            std::cout << "Failed because: '" << ex.what() << "'." << std::endl;
+            failed = true;
+        }
+    }
+
     if (failed) return 1;
     std::cout << "Testing TimeSeriesTable::trim() " << std::endl;
 
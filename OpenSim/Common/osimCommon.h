@@ -40,6 +40,7 @@
 #include "MultivariatePolynomialFunction.h"
 #include "Object.h"
 #include "ObjectGroup.h"
+#include "OutputPlan.h"
 #include "PiecewiseConstantFunction.h"
 #include "PiecewiseLinearFunction.h"
 #include "PolynomialFunction.h"
@@ -26,7 +26,6 @@
 // INCLUDES
 //=============================================================================
 
-#include "Lepton.h"
 #include "SymbolicExpressionReporter.h"
 #include <iostream>
 #include <string>
@@ -219,15 +218,11 @@ record(const SimTK::State& s)
 
     // MAKE SURE ALL QUANTITIES ARE VALID
     _model->getMultibodySystem().realize(s, SimTK::Stage::Velocity );
-    // Get state variable names and values in same order and use that to update map
-    Array<std::string> stateNames = _model->getStateVariableNames();
+    // State variable values are in the same order as the variables of the
+    // compiled expression.
     SimTK::Vector rStateValues = _model->getStateVariableValues(s);
-
-    // update map between names and values, then pass it to expression evaluator
-    for(int i=0; i<stateNames.getSize(); i++){
-        _variables.find(stateNames[i])->second = rStateValues[i];
-    }
-    double value = Lepton::Parser::parse(_expressionStr).evaluate(_variables);
+    _expression.evaluate(rStateValues.getContiguousScalarData(), _workspace);
+    double value = _expression.getValue(_workspace, 0);
     StateVector nextRow{s.getTime(), {}};
      nextRow.getData().append(value);
     _resultStore.append(nextRow);
@@ -257,11 +252,14 @@ begin( const SimTK::State& s)
     constructColumnLabels();
     // RESET STORAGE
     _resultStore.reset(s.getTime());
-    // Populate list of names, initial values from s
+    // Compile the expression once, with the state variables as its variables
     Array<std::string> stateNames = _model->getStateVariableNames();
+    std::vector<std::string> variables;
     for(int i=0; i< stateNames.getSize(); i++){
-        _variables.insert(pair<string, double>(stateNames[i], 0.0));
+        variables.push_back(stateNames[i]);
     }
+    _expression = CompiledExpressions({_expressionStr}, variables);
+    _workspace = _expression.createWorkspace();
     // RECORD
     int status = 0;
     if(_resultStore.getSize()<=0) {
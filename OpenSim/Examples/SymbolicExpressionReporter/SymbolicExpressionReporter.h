@@ -29,6 +29,7 @@
 //=============================================================================
 #include <map>
 #include "OpenSim/OpenSim.h"
+#include <OpenSim/Simulation/Model/CompiledExpressions.h>
 #include "osimExpPluginDLL.h"
 
 
@@ -56,7 +57,8 @@ OpenSim_DECLARE_CONCRETE_OBJECT(SymbolicExpressionReporter, Analysis);
 // DATA
 //=============================================================================
 private:
-    std::map<std::string, double> _variables;
+    CompiledExpressions _expression;
+    CompiledExpressions::Workspace _workspace;
 
 
 protected:
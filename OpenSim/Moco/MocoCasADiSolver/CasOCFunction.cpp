@@ -20,6 +20,10 @@
 
 #include "CasOCProblem.h"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
 using namespace CasOC;
 
 casadi::Sparsity calcJacobianSparsityWithPerturbation(const VectorDM& x0s,
@@ -104,6 +108,26 @@ casadi::Sparsity Function::get_jacobian_sparsity() const {
             x0s, (int)this->nnz_out(), function);
 }
 
+void Function::evalTrajectory(
+        const VectorDM& args, int begin, int end, VectorDM& out) const {
+    VectorDM pointArgs((int)n_in());
+    for (casadi_int i = 0; i < n_in(); ++i) {
+        pointArgs[i] = casadi::DM(sparsity_in(i));
+    }
+    for (int ipoint = begin; ipoint < end; ++ipoint) {
+        for (casadi_int i = 0; i < n_in(); ++i) {
+            const casadi_int size = pointArgs[i].numel();
+            std::copy_n(args[i].ptr() + ipoint * size, size,
+                    pointArgs[i].ptr());
+        }
+        const VectorDM pointOut = eval(pointArgs);
+        for (casadi_int i = 0; i < n_out(); ++i) {
+            const casadi_int size = pointOut[i].numel();
+            std::copy_n(pointOut[i].ptr(), size, out[i].ptr() + ipoint * size);
+        }
+    }
+}
+
 void Function::constructFunction(const Problem* casProblem,
         const std::string& name, const std::string& finiteDiffScheme,
         std::shared_ptr<const std::vector<VariablesDM>>
@@ -134,6 +158,412 @@ casadi::Sparsity Function::get_sparsity_in(casadi_int i) {
     }
 }
 
+WorkerPool::WorkerPool(int numThreads) : m_exceptions(numThreads) {
+    for (int ithread = 1; ithread < numThreads; ++ithread) {
+        m_threads.emplace_back(&WorkerPool::work, this, ithread);
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_taskAvailable.notify_all();
+    for (auto& thread : m_threads) thread.join();
+}
+
+void WorkerPool::run(const std::function<void(int)>& task) {
+    std::lock_guard<std::mutex> runLock(m_runMutex);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_task = &task;
+        m_numRunning = (int)m_threads.size();
+        ++m_generation;
+    }
+    m_taskAvailable.notify_all();
+    try {
+        task(0);
+    } catch (...) {
+        m_exceptions[0] = std::current_exception();
+    }
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_taskFinished.wait(lock, [this] { return m_numRunning == 0; });
+        m_task = nullptr;
+    }
+    for (auto& exception : m_exceptions) {
+        if (exception) {
+            std::exception_ptr first = exception;
+            for (auto& e : m_exceptions) e = nullptr;
+            std::rethrow_exception(first);
+        }
+    }
+}
+
+void WorkerPool::work(int ithread) {
+    long long generation = 0;
+    while (true) {
+        const std::function<void(int)>* task;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_taskAvailable.wait(lock, [&] {
+                return m_stop || m_generation != generation;
+            });
+            if (m_stop) return;
+            generation = m_generation;
+            task = m_task;
+        }
+        try {
+            (*task)(ithread);
+        } catch (...) {
+            m_exceptions[ithread] = std::current_exception();
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            --m_numRunning;
+        }
+        m_taskFinished.notify_one();
+    }
+}
+
+// Map an index into the concatenated inputs (or outputs) of a point function
+// to the index of the input and the row within that input.
+static std::pair<casadi_int, casadi_int> locate(
+        casadi_int index, const std::vector<casadi_int>& sizes) {
+    casadi_int which = 0;
+    while (index >= sizes[which]) {
+        index -= sizes[which];
+        ++which;
+    }
+    return {which, index};
+}
+
+void TrajectoryFunction::constructFunction(const Function* pointFunction,
+        int numPoints, WorkerPool* workerPool,
+        const std::string& finiteDiffScheme, bool provideReverse) {
+    m_pointFunction = pointFunction;
+    m_numPoints = numPoints;
+    m_workerPool = workerPool;
+    m_finiteDiffScheme = finiteDiffScheme;
+    m_provideReverse = provideReverse;
+    casadi::Dict opts;
+    opts["enable_fd"] = true;
+    opts["fd_method"] = finiteDiffScheme;
+    this->construct("trajectory_" + pointFunction->name(), opts);
+}
+
+TrajectoryFunction::~TrajectoryFunction() = default;
+
+const casadi::Sparsity& TrajectoryFunction::getPointJacobianSparsity() const {
+    if (!m_hasPointJacobianSparsity) {
+        m_pointJacobianSparsity =
+                m_pointFunction->has_jacobian_sparsity()
+                        ? m_pointFunction->get_jacobian_sparsity()
+                        : casadi::Sparsity::dense(m_pointFunction->nnz_out(),
+                                  m_pointFunction->nnz_in());
+        m_hasPointJacobianSparsity = true;
+    }
+    return m_pointJacobianSparsity;
+}
+
+casadi::Sparsity TrajectoryFunction::get_jacobian_sparsity() const {
+    std::vector<casadi_int> pointRows;
+    std::vector<casadi_int> pointCols;
+    getPointJacobianSparsity().get_triplet(pointRows, pointCols);
+
+    std::vector<casadi_int> inSizes(n_in());
+    std::vector<casadi_int> inOffsets(n_in());
+    for (casadi_int i = 0, offset = 0; i < n_in(); ++i) {
+        inSizes[i] = m_pointFunction->size1_in(i);
+        inOffsets[i] = offset;
+        offset += inSizes[i] * m_numPoints;
+    }
+    std::vector<casadi_int> outSizes(n_out());
+    std::vector<casadi_int> outOffsets(n_out());
+    for (casadi_int i = 0, offset = 0; i < n_out(); ++i) {
+        outSizes[i] = m_pointFunction->size1_out(i);
+        outOffsets[i] = offset;
+        offset += outSizes[i] * m_numPoints;
+    }
+
+    // The outputs at a point depend only on the inputs at that point.
+    std::vector<casadi_int> rows;
+    std::vector<casadi_int> cols;
+    rows.reserve(pointRows.size() * m_numPoints);
+    cols.reserve(pointRows.size() * m_numPoints);
+    for (int inz = 0; inz < (int)pointRows.size(); ++inz) {
+        const auto out = locate(pointRows[inz], outSizes);
+        const auto in = locate(pointCols[inz], inSizes);
+        for (int ipoint = 0; ipoint < m_numPoints; ++ipoint) {
+            rows.push_back(outOffsets[out.first] +
+                           ipoint * outSizes[out.first] + out.second);
+            cols.push_back(inOffsets[in.first] + ipoint * inSizes[in.first] +
+                           in.second);
+        }
+    }
+    return casadi::Sparsity::triplet(nnz_out(), nnz_in(), rows, cols);
+}
+
+casadi::Function TrajectoryFunction::get_reverse(casadi_int nadj,
+        const std::string& name, const std::vector<std::string>& inames,
+        const std::vector<std::string>& onames,
+        const casadi::Dict& opts) const {
+    m_reverseFunctions.emplace_back(new TrajectoryReverse());
+    m_reverseFunctions.back()->constructFunction(this, (int)nadj, name,
+            inames, onames, opts, m_finiteDiffScheme);
+    return *m_reverseFunctions.back();
+}
+
+VectorDM TrajectoryFunction::eval(const VectorDM& args) const {
+    const auto start = std::chrono::steady_clock::now();
+    VectorDM out((int)n_out());
+    for (casadi_int i = 0; i < n_out(); ++i) {
+        out[i] = casadi::DM(sparsity_out(i));
+    }
+    if (!m_workerPool) {
+        m_pointFunction->evalTrajectory(args, 0, m_numPoints, out);
+    } else {
+        // Each thread evaluates a contiguous chunk of points and writes to
+        // separate columns of the outputs.
+        const int numThreads = m_workerPool->getNumThreads();
+        const int chunkSize = (m_numPoints + numThreads - 1) / numThreads;
+        m_workerPool->run([&](int ithread) {
+            const int begin = std::min(ithread * chunkSize, m_numPoints);
+            const int end = std::min(begin + chunkSize, m_numPoints);
+            m_pointFunction->evalTrajectory(args, begin, end, out);
+        });
+    }
+    m_pointFunction->recordEvaluation(
+            m_numPoints, std::chrono::steady_clock::now() - start);
+    return out;
+}
+
+void TrajectoryReverse::constructFunction(
+        const TrajectoryFunction* trajectoryFunction, int numDirections,
+        const std::string& name, std::vector<std::string> inputNames,
+        std::vector<std::string> outputNames, casadi::Dict opts,
+        const std::string& finiteDiffScheme) {
+    m_trajectoryFunction = trajectoryFunction;
+    const Function& pointFunction = trajectoryFunction->getPointFunction();
+    m_numIn = (int)pointFunction.n_in();
+    m_numOut = (int)pointFunction.n_out();
+    m_numPoints = trajectoryFunction->getNumPoints();
+    m_numDirections = numDirections;
+    m_inputNames = std::move(inputNames);
+    m_outputNames = std::move(outputNames);
+    m_pointInSizes.resize(m_numIn);
+    for (int i = 0; i < m_numIn; ++i) {
+        m_pointInSizes[i] = pointFunction.size1_in(i);
+    }
+    m_pointOutSizes.resize(m_numOut);
+    for (int i = 0; i < m_numOut; ++i) {
+        m_pointOutSizes[i] = pointFunction.size1_out(i);
+    }
+
+    const auto& sparsity = trajectoryFunction->getPointJacobianSparsity();
+    m_columnLocations.resize(sparsity.size2());
+    for (casadi_int col = 0; col < sparsity.size2(); ++col) {
+        m_columnLocations[col] = locate(col, m_pointInSizes);
+    }
+    m_rowLocations.resize(sparsity.size1());
+    for (casadi_int row = 0; row < sparsity.size1(); ++row) {
+        m_rowLocations[row] = locate(row, m_pointOutSizes);
+    }
+
+    // Greedy coloring of the columns of the point Jacobian: each column gets
+    // the first color that is not used by a column that shares a row with
+    // it.
+    std::vector<casadi_int> rows;
+    std::vector<casadi_int> cols;
+    sparsity.get_triplet(rows, cols);
+    std::vector<std::vector<casadi_int>> columnsInRow(sparsity.size1());
+    std::vector<std::vector<casadi_int>> rowsInColumn(sparsity.size2());
+    for (int inz = 0; inz < (int)rows.size(); ++inz) {
+        columnsInRow[rows[inz]].push_back(cols[inz]);
+        rowsInColumn[cols[inz]].push_back(rows[inz]);
+    }
+    std::vector<int> colors(sparsity.size2(), -1);
+    for (casadi_int col = 0; col < sparsity.size2(); ++col) {
+        if (rowsInColumn[col].empty()) continue;
+        std::vector<bool> used(m_colorColumns.size(), false);
+        for (const auto& row : rowsInColumn[col]) {
+            for (const auto& other : columnsInRow[row]) {
+                if (colors[other] != -1) used[colors[other]] = true;
+            }
+        }
+        const int color = (int)(std::find(used.begin(), used.end(), false) -
+                                used.begin());
+        if (color == (int)m_colorColumns.size()) {
+            m_colorColumns.emplace_back();
+            m_colorNonzeros.emplace_back();
+        }
+        colors[col] = color;
+        m_colorColumns[color].push_back(col);
+        for (const auto& row : rowsInColumn[col]) {
+            m_colorNonzeros[color].emplace_back(row, col);
+        }
+    }
+
+    opts["enable_fd"] = true;
+    opts["fd_method"] = finiteDiffScheme;
+    // The sensitivities computed by eval() have a rounding error of about
+    // eps^(2/3), which CasADi's default step (1e-8) would amplify too much.
+    opts["fd_options"] = casadi::Dict{{"h", 1e-5}};
+    this->construct(name, opts);
+}
+
+casadi::Sparsity TrajectoryReverse::get_sparsity_in(casadi_int i) {
+    if (i < m_numIn) {
+        return casadi::Sparsity::dense(m_pointInSizes[i], m_numPoints);
+    } else if (i < m_numIn + m_numOut) {
+        return casadi::Sparsity::dense(
+                m_pointOutSizes[i - m_numIn], m_numPoints);
+    } else {
+        return casadi::Sparsity::dense(m_pointOutSizes[i - m_numIn - m_numOut],
+                m_numPoints * m_numDirections);
+    }
+}
+
+casadi::Sparsity TrajectoryReverse::get_jacobian_sparsity() const {
+    const auto& sparsity = m_trajectoryFunction->getPointJacobianSparsity();
+    std::vector<casadi_int> pointRows;
+    std::vector<casadi_int> pointCols;
+    sparsity.get_triplet(pointRows, pointCols);
+    const casadi_int numColumns = sparsity.size2();
+    std::vector<std::vector<casadi_int>> columnsInRow(sparsity.size1());
+    std::vector<std::vector<casadi_int>> rowsInColumn(numColumns);
+    for (int inz = 0; inz < (int)pointRows.size(); ++inz) {
+        columnsInRow[pointRows[inz]].push_back(pointCols[inz]);
+        rowsInColumn[pointCols[inz]].push_back(pointRows[inz]);
+    }
+    // Two inputs of the point function have a nonzero second derivative
+    // only if they affect a common output.
+    std::vector<bool> coupled(numColumns * numColumns, false);
+    for (const auto& columns : columnsInRow) {
+        for (const auto& a : columns) {
+            for (const auto& b : columns) coupled[a * numColumns + b] = true;
+        }
+    }
+
+    const casadi_int numColumnsAll = m_numPoints * m_numDirections;
+    // The inputs are the nominal inputs, the nominal outputs, and the seeds.
+    std::vector<casadi_int> inOffsets(m_numIn);
+    std::vector<casadi_int> seedOffsets(m_numOut);
+    casadi_int offset = 0;
+    for (int i = 0; i < m_numIn; ++i) {
+        inOffsets[i] = offset;
+        offset += m_pointInSizes[i] * m_numPoints;
+    }
+    for (int i = 0; i < m_numOut; ++i) {
+        offset += m_pointOutSizes[i] * m_numPoints;
+    }
+    for (int i = 0; i < m_numOut; ++i) {
+        seedOffsets[i] = offset;
+        offset += m_pointOutSizes[i] * numColumnsAll;
+    }
+    std::vector<casadi_int> sensOffsets(m_numIn);
+    offset = 0;
+    for (int i = 0; i < m_numIn; ++i) {
+        sensOffsets[i] = offset;
+        offset += m_pointInSizes[i] * numColumnsAll;
+    }
+
+    std::vector<casadi_int> rows;
+    std::vector<casadi_int> cols;
+    for (int idir = 0; idir < m_numDirections; ++idir) {
+        for (int ipoint = 0; ipoint < m_numPoints; ++ipoint) {
+            const casadi_int column = idir * m_numPoints + ipoint;
+            for (casadi_int a = 0; a < numColumns; ++a) {
+                const auto& sens = m_columnLocations[a];
+                const casadi_int row = sensOffsets[sens.first] +
+                                       column * m_pointInSizes[sens.first] +
+                                       sens.second;
+                for (casadi_int b = 0; b < numColumns; ++b) {
+                    if (!coupled[a * numColumns + b]) continue;
+                    const auto& in = m_columnLocations[b];
+                    rows.push_back(row);
+                    cols.push_back(inOffsets[in.first] +
+                                   ipoint * m_pointInSizes[in.first] +
+                                   in.second);
+                }
+                for (const auto& pointRow : rowsInColumn[a]) {
+                    const auto& seed = m_rowLocations[pointRow];
+                    rows.push_back(row);
+                    cols.push_back(seedOffsets[seed.first] +
+                                   column * m_pointOutSizes[seed.first] +
+                                   seed.second);
+                }
+            }
+        }
+    }
+    return casadi::Sparsity::triplet(nnz_out(), nnz_in(), rows, cols);
+}
+
+VectorDM TrajectoryReverse::eval(const VectorDM& args) const {
+    const VectorDM nominal(args.begin(), args.begin() + m_numIn);
+    VectorDM out(m_numIn);
+    for (int i = 0; i < m_numIn; ++i) {
+        out[i] = casadi::DM(sparsity_out(i));
+    }
+    // Central differences, with a step relative to the magnitude of the
+    // input. These are more accurate than forward differences, which matters
+    // because CasADi differentiates the result again for the Hessian.
+    const double relativeStep =
+            std::cbrt(std::numeric_limits<double>::epsilon());
+    std::vector<int> indexInColor(m_columnLocations.size(), -1);
+    for (int icolor = 0; icolor < (int)m_colorColumns.size(); ++icolor) {
+        const auto& columns = m_colorColumns[icolor];
+        VectorDM plus = nominal;
+        VectorDM minus = nominal;
+        // The difference between the perturbed inputs, for each column in
+        // this color and each point.
+        std::vector<double> steps(columns.size() * m_numPoints);
+        for (int k = 0; k < (int)columns.size(); ++k) {
+            indexInColor[columns[k]] = k;
+            const auto& in = m_columnLocations[columns[k]];
+            const casadi_int size = m_pointInSizes[in.first];
+            double* xPlus = plus[in.first].ptr();
+            double* xMinus = minus[in.first].ptr();
+            for (int ipoint = 0; ipoint < m_numPoints; ++ipoint) {
+                const casadi_int index = ipoint * size + in.second;
+                const double x = xPlus[index];
+                const double h = relativeStep * std::max(1.0, std::abs(x));
+                xPlus[index] = x + h;
+                xMinus[index] = x - h;
+                steps[k * m_numPoints + ipoint] = xPlus[index] - xMinus[index];
+            }
+        }
+        const VectorDM outPlus = m_trajectoryFunction->eval(plus);
+        const VectorDM outMinus = m_trajectoryFunction->eval(minus);
+
+        for (const auto& nonzero : m_colorNonzeros[icolor]) {
+            const auto& outLoc = m_rowLocations[nonzero.first];
+            const auto& inLoc = m_columnLocations[nonzero.second];
+            const casadi_int outSize = m_pointOutSizes[outLoc.first];
+            const casadi_int inSize = m_pointInSizes[inLoc.first];
+            const double* fPlus = outPlus[outLoc.first].ptr();
+            const double* fMinus = outMinus[outLoc.first].ptr();
+            const double* seed = args[m_numIn + m_numOut + outLoc.first].ptr();
+            double* sens = out[inLoc.first].ptr();
+            const int k = indexInColor[nonzero.second];
+            for (int ipoint = 0; ipoint < m_numPoints; ++ipoint) {
+                const casadi_int outIndex = ipoint * outSize + outLoc.second;
+                const double derivative =
+                        (fPlus[outIndex] - fMinus[outIndex]) /
+                        steps[k * m_numPoints + ipoint];
+                for (int idir = 0; idir < m_numDirections; ++idir) {
+                    const casadi_int column = idir * m_numPoints + ipoint;
+                    sens[column * inSize + inLoc.second] +=
+                            derivative *
+                            seed[column * outSize + outLoc.second];
+                }
+            }
+        }
+    }
+    return out;
+}
+
 VectorDM PathConstraint::eval(const VectorDM& args) const {
     Problem::ContinuousInput input{args.at(0).scalar(), args.at(1), args.at(2),
             args.at(3), args.at(4), args.at(5)};
@@ -189,19 +619,23 @@ casadi::Sparsity Endpoint::get_sparsity_in(casadi_int i) {
     }
 }
 VectorDM Cost::eval(const VectorDM& args) const {
+    const auto start = std::chrono::steady_clock::now();
     Problem::CostInput input{args.at(0).scalar(), args.at(1), args.at(2),
             args.at(3), args.at(4), args.at(5).scalar(), args.at(6), args.at(7),
             args.at(8), args.at(9), args.at(10), args.at(11).scalar()};
     VectorDM out{casadi::DM(sparsity_out(0))};
     m_casProblem->calcCost(m_index, input, out.at(0));
+    recordEvaluation(1, std::chrono::steady_clock::now() - start);
     return out;
 }
 VectorDM EndpointConstraint::eval(const VectorDM& args) const {
+    const auto start = std::chrono::steady_clock::now();
     Problem::CostInput input{args.at(0).scalar(), args.at(1), args.at(2),
             args.at(3), args.at(4), args.at(5).scalar(), args.at(6), args.at(7),
             args.at(8), args.at(9), args.at(10), args.at(11).scalar()};
     VectorDM out{casadi::DM(sparsity_out(0))};
     m_casProblem->calcEndpointConstraint(m_index, input, out.at(0));
+    recordEvaluation(1, std::chrono::steady_clock::now() - start);
     return out;
 }
 
@@ -244,6 +678,17 @@ VectorDM MultibodySystemExplicit<CalcKCErrors>::eval(
     return out;
 }
 
+template <bool CalcKCErrors>
+void MultibodySystemExplicit<CalcKCErrors>::evalTrajectory(
+        const VectorDM& args, int begin, int end, VectorDM& out) const {
+    Problem::ContinuousInputTrajectory input{args.at(0), args.at(1),
+            args.at(2), args.at(3), args.at(4), args.at(5)};
+    Problem::MultibodySystemExplicitOutput output{out[0], out[1], out[2],
+            out[3]};
+    m_casProblem->calcMultibodySystemExplicitTrajectory(
+            input, CalcKCErrors, begin, end, output);
+}
+
 template class CasOC::MultibodySystemExplicit<false>;
 template class CasOC::MultibodySystemExplicit<true>;
 
@@ -330,5 +775,16 @@ VectorDM MultibodySystemImplicit<CalcKCErrors>::eval(
     return out;
 }
 
+template <bool CalcKCErrors>
+void MultibodySystemImplicit<CalcKCErrors>::evalTrajectory(
+        const VectorDM& args, int begin, int end, VectorDM& out) const {
+    Problem::ContinuousInputTrajectory input{args.at(0), args.at(1),
+            args.at(2), args.at(3), args.at(4), args.at(5)};
+    Problem::MultibodySystemImplicitOutput output{out[0], out[1], out[2],
+            out[3]};
+    m_casProblem->calcMultibodySystemImplicitTrajectory(
+            input, CalcKCErrors, begin, end, output);
+}
+
 template class CasOC::MultibodySystemImplicit<false>;
 template class CasOC::MultibodySystemImplicit<true>;
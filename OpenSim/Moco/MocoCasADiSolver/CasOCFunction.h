@@ -22,6 +22,15 @@
 
 #include <OpenSim/Common/Exception.h>
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
 namespace CasOC {
 
 class Problem;
@@ -63,6 +72,34 @@ public:
     }
     casadi::Sparsity get_jacobian_sparsity() const override;
 
+    /// Evaluate this function at the points [begin, end) of a trajectory,
+    /// whose inputs are the columns of `args`, and write the outputs to the
+    /// corresponding columns of `out`. TrajectoryFunction invokes this,
+    /// possibly concurrently for disjoint ranges of points. The default
+    /// implementation invokes eval() for each point.
+    virtual void evalTrajectory(const VectorDM& args, int begin, int end,
+            VectorDM& out) const;
+
+    /// @name Profiling
+    /// Evaluations of this function and the wall time spent in them,
+    /// including the evaluations that CasADi performs to compute
+    /// finite-difference derivatives. An evaluation may be at many points
+    /// (see TrajectoryFunction).
+    /// @{
+    void recordEvaluation(
+            int numPoints, std::chrono::steady_clock::duration time) const {
+        ++m_numEvaluations;
+        m_numPointsEvaluated += numPoints;
+        m_evaluationTime +=
+                std::chrono::duration_cast<std::chrono::nanoseconds>(time)
+                        .count();
+    }
+    long long getNumEvaluations() const { return m_numEvaluations; }
+    long long getNumPointsEvaluated() const { return m_numPointsEvaluated; }
+    /// In seconds.
+    double getEvaluationTime() const { return 1e-9 * m_evaluationTime; }
+    /// @}
+
 protected:
     const Problem* m_casProblem;
 
@@ -91,6 +128,175 @@ private:
 
     std::shared_ptr<const std::vector<VariablesDM>>
             m_fullPointsForSparsityDetection;
+
+    mutable std::atomic<long long> m_numEvaluations{0};
+    mutable std::atomic<long long> m_numPointsEvaluated{0};
+    // In nanoseconds.
+    mutable std::atomic<long long> m_evaluationTime{0};
+};
+
+/// Threads that persist across evaluations of TrajectoryFunction%s (for the
+/// duration of a solve). Each evaluation splits the points into one chunk
+/// per thread, and chunk i always runs on thread i (thread 0 is the calling
+/// thread). Therefore, a thread keeps using the same resources across
+/// evaluations, such as the MocoProblemRep that it takes from a
+/// ThreadsafeJar (which gives a thread the object it last returned) and
+/// the memory cached in that MocoProblemRep's States.
+class WorkerPool {
+public:
+    explicit WorkerPool(int numThreads);
+    ~WorkerPool();
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+    int getNumThreads() const { return (int)m_threads.size() + 1; }
+    /// Invoke task(i) on thread i, for each thread, and wait for all tasks
+    /// to finish. If a task throws an exception, it is rethrown here.
+    void run(const std::function<void(int)>& task);
+
+private:
+    void work(int ithread);
+
+    std::vector<std::thread> m_threads;
+    // Serializes calls to run().
+    std::mutex m_runMutex;
+    std::mutex m_mutex;
+    std::condition_variable m_taskAvailable;
+    std::condition_variable m_taskFinished;
+    const std::function<void(int)>* m_task = nullptr;
+    // Incremented for each call to run(), so that each worker runs each task
+    // once.
+    long long m_generation = 0;
+    int m_numRunning = 0;
+    bool m_stop = false;
+    std::vector<std::exception_ptr> m_exceptions;
+};
+
+class TrajectoryReverse;
+
+/// This function evaluates a point function at many points (e.g., all mesh
+/// points), given as the columns of its inputs. This is equivalent to
+/// casadi::Function::map(), but all points are evaluated within one call of
+/// this function, either serially or across threads, rather than each point
+/// being dispatched separately by CasADi. If a WorkerPool is provided, the
+/// points are evaluated across its threads. The derivatives are computed with
+/// finite differences, using the block-diagonal sparsity pattern that
+/// follows from the sparsity pattern of the point function. If
+/// `provideReverse` is true, this function also provides its reverse
+/// derivative (see TrajectoryReverse), which CasADi uses to compute exact
+/// Hessians.
+class TrajectoryFunction : public casadi::Callback {
+public:
+    void constructFunction(const Function* pointFunction, int numPoints,
+            WorkerPool* workerPool, const std::string& finiteDiffScheme,
+            bool provideReverse = false);
+    ~TrajectoryFunction() override;
+    const Function& getPointFunction() const { return *m_pointFunction; }
+    int getNumPoints() const { return m_numPoints; }
+    /// The sparsity of the Jacobian of the point function (dense if the
+    /// point function does not provide a sparsity pattern). This is computed
+    /// once.
+    const casadi::Sparsity& getPointJacobianSparsity() const;
+    casadi_int get_n_in() override { return m_pointFunction->n_in(); }
+    casadi_int get_n_out() override { return m_pointFunction->n_out(); }
+    std::string get_name_in(casadi_int i) override {
+        return m_pointFunction->name_in(i);
+    }
+    std::string get_name_out(casadi_int i) override {
+        return m_pointFunction->name_out(i);
+    }
+    casadi::Sparsity get_sparsity_in(casadi_int i) override {
+        return casadi::Sparsity::dense(
+                m_pointFunction->size1_in(i), m_numPoints);
+    }
+    casadi::Sparsity get_sparsity_out(casadi_int i) override {
+        return casadi::Sparsity::dense(
+                m_pointFunction->size1_out(i), m_numPoints);
+    }
+    bool has_jacobian_sparsity() const override { return true; }
+    casadi::Sparsity get_jacobian_sparsity() const override;
+    bool has_reverse(casadi_int) const override { return m_provideReverse; }
+    casadi::Function get_reverse(casadi_int nadj, const std::string& name,
+            const std::vector<std::string>& inames,
+            const std::vector<std::string>& onames,
+            const casadi::Dict& opts) const override;
+    VectorDM eval(const VectorDM& args) const override;
+
+private:
+    const Function* m_pointFunction = nullptr;
+    int m_numPoints = -1;
+    WorkerPool* m_workerPool = nullptr;
+    std::string m_finiteDiffScheme;
+    bool m_provideReverse = false;
+    mutable casadi::Sparsity m_pointJacobianSparsity;
+    mutable bool m_hasPointJacobianSparsity = false;
+    // CasADi refers to these functions but does not own them.
+    mutable std::vector<std::unique_ptr<TrajectoryReverse>> m_reverseFunctions;
+};
+
+/// The reverse derivative of a TrajectoryFunction: given nadj seeds for the
+/// outputs, compute the product of the transpose of the Jacobian of the
+/// point function with the seeds, at each point. The Jacobians of the point
+/// function are computed with central finite differences. The points do not
+/// depend on each other, so each input of the point function is perturbed
+/// at all points at once; furthermore, inputs that do not affect the same
+/// outputs (according to the sparsity pattern of the point function) are
+/// perturbed together, using a greedy coloring of the columns of the
+/// Jacobian. Therefore, the cost of this function is two evaluations of the
+/// trajectory per color, regardless of the number of points and seeds.
+///
+/// The derivatives of this function (i.e., second derivatives of the point
+/// function, for the Hessian of the Lagrangian) are computed by CasADi with
+/// finite differences. Its Jacobian sparsity has one block per point (and
+/// seed): the derivatives of the sensitivity of an input can be nonzero
+/// only with respect to inputs that affect a common output, and with respect
+/// to the seeds of the outputs that the input affects. CasADi colors the
+/// Hessian using these blocks.
+class TrajectoryReverse : public casadi::Callback {
+public:
+    void constructFunction(const TrajectoryFunction* trajectoryFunction,
+            int numDirections, const std::string& name,
+            std::vector<std::string> inputNames,
+            std::vector<std::string> outputNames, casadi::Dict opts,
+            const std::string& finiteDiffScheme);
+    /// The nominal inputs, the nominal outputs (which are not used), and the
+    /// seeds for the outputs.
+    casadi_int get_n_in() override { return m_numIn + 2 * m_numOut; }
+    /// The sensitivities of the inputs.
+    casadi_int get_n_out() override { return m_numIn; }
+    std::string get_name_in(casadi_int i) override { return m_inputNames[i]; }
+    std::string get_name_out(casadi_int i) override {
+        return m_outputNames[i];
+    }
+    casadi::Sparsity get_sparsity_in(casadi_int i) override;
+    casadi::Sparsity get_sparsity_out(casadi_int i) override {
+        return casadi::Sparsity::dense(
+                m_pointInSizes[i], m_numPoints * m_numDirections);
+    }
+    bool has_jacobian_sparsity() const override { return true; }
+    casadi::Sparsity get_jacobian_sparsity() const override;
+    VectorDM eval(const VectorDM& args) const override;
+
+private:
+    const TrajectoryFunction* m_trajectoryFunction = nullptr;
+    int m_numIn = 0;
+    int m_numOut = 0;
+    int m_numPoints = 0;
+    int m_numDirections = 0;
+    std::vector<std::string> m_inputNames;
+    std::vector<std::string> m_outputNames;
+    std::vector<casadi_int> m_pointInSizes;
+    std::vector<casadi_int> m_pointOutSizes;
+    // The (input, row) for each column of the point Jacobian, and the
+    // (output, row) for each row.
+    std::vector<std::pair<casadi_int, casadi_int>> m_columnLocations;
+    std::vector<std::pair<casadi_int, casadi_int>> m_rowLocations;
+    // The columns of the point Jacobian (indices into the concatenated
+    // inputs of the point function) in each color.
+    std::vector<std::vector<casadi_int>> m_colorColumns;
+    // The nonzeros (row, column) of the point Jacobian in each color. Within
+    // a color, each row has at most one nonzero.
+    std::vector<std::vector<std::pair<casadi_int, casadi_int>>>
+            m_colorNonzeros;
 };
 
 class PathConstraint : public Function {
@@ -268,6 +474,8 @@ public:
     }
     casadi::Sparsity get_sparsity_out(casadi_int i) override final;
     VectorDM eval(const VectorDM& args) const override;
+    void evalTrajectory(const VectorDM& args, int begin, int end,
+            VectorDM& out) const override;
 };
 
 /// This function should compute a velocity correction term to make feasible
@@ -311,6 +519,8 @@ class MultibodySystemImplicit : public Function {
     }
     casadi::Sparsity get_sparsity_out(casadi_int i) override final;
     VectorDM eval(const VectorDM& args) const override;
+    void evalTrajectory(const VectorDM& args, int begin, int end,
+            VectorDM& out) const override;
 };
 
 } // namespace CasOC
@@ -19,6 +19,7 @@
  * -------------------------------------------------------------------------- */
 
 #include <casadi/casadi.hpp>
+#include <limits>
 
 namespace CasOC {
 
@@ -62,8 +63,16 @@ struct Iterate {
     std::vector<std::string> derivative_names;
     std::vector<std::string> parameter_names;
     int iteration = -1;
+    /// Multipliers of the NLP for the bounds on the variables and for the
+    /// constraints (in the order of the flattened NLP), and the optimizer's
+    /// barrier parameter. In a guess, these warm-start the optimizer if their
+    /// sizes match the NLP; in a solution, they are from the final iterate.
+    /// These are empty (and NaN) if not available.
+    casadi::DM variable_bound_multipliers;
+    casadi::DM constraint_multipliers;
+    double barrier_parameter = std::numeric_limits<double>::quiet_NaN();
     /// Return a new iterate in which the data is resampled at the times in
-    /// newTimes.
+    /// newTimes. The multipliers of the NLP are not kept.
     Iterate resample(const casadi::DM& newTimes) const;
 };
 
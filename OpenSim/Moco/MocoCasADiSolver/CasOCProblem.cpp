@@ -38,6 +38,82 @@ Iterate Iterate::resample(const casadi::DM& newTimes) const {
     return OpenSim::convertToCasOCIterate(mocoIt);
 }
 
+/// A column vector of zeros with as many rows as the trajectory matrix.
+static casadi::DM createColumn(const casadi::DM& trajectory) {
+    return casadi::DM::zeros(trajectory.size1(), 1);
+}
+
+Problem::ContinuousInputPoint::ContinuousInputPoint(
+        const ContinuousInputTrajectory& trajectory)
+        : m_trajectory(trajectory),
+          m_states(createColumn(trajectory.states)),
+          m_controls(createColumn(trajectory.controls)),
+          m_multipliers(createColumn(trajectory.multipliers)),
+          m_derivatives(createColumn(trajectory.derivatives)),
+          m_parameters(createColumn(trajectory.parameters)),
+          m_input{m_time, m_states, m_controls, m_multipliers, m_derivatives,
+                  m_parameters} {}
+
+const Problem::ContinuousInput& Problem::ContinuousInputPoint::load(
+        int ipoint) {
+    auto loadColumn = [ipoint](const casadi::DM& trajectory,
+                              casadi::DM& point) {
+        std::copy_n(trajectory.ptr() + ipoint * point.numel(), point.numel(),
+                point.ptr());
+    };
+    m_time = *(m_trajectory.times.ptr() + ipoint);
+    loadColumn(m_trajectory.states, m_states);
+    loadColumn(m_trajectory.controls, m_controls);
+    loadColumn(m_trajectory.multipliers, m_multipliers);
+    loadColumn(m_trajectory.derivatives, m_derivatives);
+    loadColumn(m_trajectory.parameters, m_parameters);
+    return m_input;
+}
+
+void Problem::calcMultibodySystemExplicitTrajectory(
+        const ContinuousInputTrajectory& input, bool calcKCErrors, int begin,
+        int end, MultibodySystemExplicitOutput& output) const {
+    calcPointwise(input, begin, end, output,
+            [&](const ContinuousInput& pointInput,
+                    MultibodySystemExplicitOutput& pointOutput) {
+                calcMultibodySystemExplicit(
+                        pointInput, calcKCErrors, pointOutput);
+            });
+}
+
+void Problem::calcMultibodySystemImplicitTrajectory(
+        const ContinuousInputTrajectory& input, bool calcKCErrors, int begin,
+        int end, MultibodySystemImplicitOutput& output) const {
+    calcPointwise(input, begin, end, output,
+            [&](const ContinuousInput& pointInput,
+                    MultibodySystemImplicitOutput& pointOutput) {
+                calcMultibodySystemImplicit(
+                        pointInput, calcKCErrors, pointOutput);
+            });
+}
+
+std::vector<const Function*> Problem::getFunctions() const {
+    std::vector<const Function*> functions;
+    auto add = [&](const Function* function) {
+        if (function) functions.push_back(function);
+    };
+    add(m_multibodyFunc.get());
+    add(m_multibodyFuncIgnoringConstraints.get());
+    add(m_implicitMultibodyFunc.get());
+    add(m_implicitMultibodyFuncIgnoringConstraints.get());
+    add(m_velocityCorrectionFunc.get());
+    for (const auto& info : m_costInfos) {
+        add(info.integrand_function.get());
+        add(info.endpoint_function.get());
+    }
+    for (const auto& info : m_endpointConstraintInfos) {
+        add(info.integrand_function.get());
+        add(info.endpoint_function.get());
+    }
+    for (const auto& info : m_pathInfos) add(info.function.get());
+    return functions;
+}
+
 std::vector<std::string>
 Problem::createKinematicConstraintEquationNamesImpl() const {
     std::vector<std::string> names(getNumKinematicConstraintEquations());
@@ -20,6 +20,7 @@
 
 #include <OpenSim/Moco/MocoUtilities.h>
 #include "CasOCFunction.h"
+#include <array>
 #include <casadi/casadi.hpp>
 #include <string>
 #include <unordered_map>
@@ -137,6 +138,17 @@ public:
         const casadi::DM& derivatives;
         const casadi::DM& parameters;
     };
+    /// The inputs at many points of a trajectory (e.g., all mesh points):
+    /// the input at point i is element i of `times` and column i of each
+    /// matrix.
+    struct ContinuousInputTrajectory {
+        const casadi::DM& times;
+        const casadi::DM& states;
+        const casadi::DM& controls;
+        const casadi::DM& multipliers;
+        const casadi::DM& derivatives;
+        const casadi::DM& parameters;
+    };
     struct CostInput {
         const double& initial_time;
         const casadi::DM& initial_states;
@@ -164,6 +176,62 @@ public:
         casadi::DM& kinematic_constraint_errors;
     };
 
+    /// Holds the input at one point of a trajectory, in buffers that are
+    /// allocated once, so that the pointwise functions (e.g.,
+    /// calcMultibodySystemExplicit()) can be evaluated along a trajectory
+    /// without allocating memory for each point.
+    class ContinuousInputPoint {
+    public:
+        explicit ContinuousInputPoint(
+                const ContinuousInputTrajectory& trajectory);
+        ContinuousInputPoint(const ContinuousInputPoint&) = delete;
+        ContinuousInputPoint& operator=(const ContinuousInputPoint&) = delete;
+        /// Copy the input at point `ipoint` into the buffers.
+        const ContinuousInput& load(int ipoint);
+
+    private:
+        const ContinuousInputTrajectory& m_trajectory;
+        double m_time = 0;
+        casadi::DM m_states;
+        casadi::DM m_controls;
+        casadi::DM m_multipliers;
+        casadi::DM m_derivatives;
+        casadi::DM m_parameters;
+        ContinuousInput m_input;
+    };
+    /// Copy the output at one point (a column vector) into column `ipoint`
+    /// of the output for a trajectory.
+    static void storePoint(
+            const casadi::DM& point, int ipoint, casadi::DM& trajectory) {
+        std::copy_n(point.ptr(), point.numel(),
+                trajectory.ptr() + ipoint * point.numel());
+    }
+    /// Invoke `calcPoint(pointInput, pointOutput)` for each point [begin,
+    /// end) of a trajectory and store `pointOutput` in the columns of
+    /// `output` (a MultibodySystemExplicitOutput or
+    /// MultibodySystemImplicitOutput). The buffers for one point are
+    /// allocated once for all points. This implements
+    /// calcMultibodySystemExplicitTrajectory() and
+    /// calcMultibodySystemImplicitTrajectory().
+    template <typename Output, typename CalcPoint>
+    static void calcPointwise(const ContinuousInputTrajectory& input,
+            int begin, int end, Output& output, CalcPoint&& calcPoint) {
+        const std::array<casadi::DM*, 4> trajectories =
+                getOutputMatrices(output);
+        std::array<casadi::DM, 4> points;
+        for (int i = 0; i < 4; ++i) {
+            points[i] = casadi::DM::zeros(trajectories[i]->size1(), 1);
+        }
+        Output pointOutput{points[0], points[1], points[2], points[3]};
+        ContinuousInputPoint point(input);
+        for (int ipoint = begin; ipoint < end; ++ipoint) {
+            calcPoint(point.load(ipoint), pointOutput);
+            for (int i = 0; i < 4; ++i) {
+                storePoint(points[i], ipoint, *trajectories[i]);
+            }
+        }
+    }
+
 protected:
     /// @name Interface for the user building the problem.
     /// Call the add/set functions in the constructor for your problem.
@@ -312,6 +380,19 @@ public:
             bool calcKCErrors, MultibodySystemExplicitOutput& output) const = 0;
     virtual void calcMultibodySystemImplicit(const ContinuousInput& input,
             bool calcKCErrors, MultibodySystemImplicitOutput& output) const = 0;
+    /// Evaluate calcMultibodySystemExplicit() at the points [begin, end) of
+    /// a trajectory, writing the output at point i to column i of each
+    /// matrix in `output`. This may be invoked concurrently for disjoint
+    /// ranges of points. Override this to avoid the per-point setup cost;
+    /// the default implementation calls calcMultibodySystemExplicit() for
+    /// each point.
+    virtual void calcMultibodySystemExplicitTrajectory(
+            const ContinuousInputTrajectory& input, bool calcKCErrors,
+            int begin, int end, MultibodySystemExplicitOutput& output) const;
+    /// @copydoc calcMultibodySystemExplicitTrajectory()
+    virtual void calcMultibodySystemImplicitTrajectory(
+            const ContinuousInputTrajectory& input, bool calcKCErrors,
+            int begin, int end, MultibodySystemImplicitOutput& output) const;
     virtual void calcVelocityCorrection(const double& time,
             const casadi::DM& multibody_states, const casadi::DM& slacks,
             const casadi::DM& parameters,
@@ -569,33 +650,49 @@ public:
     }
     /// Get a function to the full multibody system (i.e. including kinematic
     /// constraints errors).
-    const casadi::Function& getMultibodySystem() const {
+    const Function& getMultibodySystem() const {
         return *m_multibodyFunc;
     }
     /// Get a function to the multibody system that does *not* compute kinematic
     /// constraint errors (if they exist). This may be necessary for computing
     /// state derivatives at grid points where we do not want to enforce
     /// kinematic constraint errors.
-    const casadi::Function& getMultibodySystemIgnoringConstraints() const {
+    const Function& getMultibodySystemIgnoringConstraints() const {
         return *m_multibodyFuncIgnoringConstraints;
     }
     /// Get a function to compute the velocity correction to qdot when enforcing
     /// kinematic constraints and their derivatives. We require a separate
     /// function for this since we don't actually compute qdot within the
     /// multibody system.
-    const casadi::Function& getVelocityCorrection() const {
+    const Function& getVelocityCorrection() const {
         return *m_velocityCorrectionFunc;
     }
-    const casadi::Function& getImplicitMultibodySystem() const {
+    const Function& getImplicitMultibodySystem() const {
         return *m_implicitMultibodyFunc;
     }
-    const casadi::Function&
-    getImplicitMultibodySystemIgnoringConstraints() const {
+    const Function& getImplicitMultibodySystemIgnoringConstraints() const {
         return *m_implicitMultibodyFuncIgnoringConstraints;
     }
+    /// Get all functions that this problem has constructed, for reporting
+    /// their evaluation counts and times.
+    std::vector<const Function*> getFunctions() const;
     /// @}
 
 private:
+    /// The matrices of the output, in the order of their members.
+    static std::array<casadi::DM*, 4> getOutputMatrices(
+            MultibodySystemExplicitOutput& output) {
+        return {{&output.multibody_derivatives, &output.auxiliary_derivatives,
+                &output.auxiliary_residuals,
+                &output.kinematic_constraint_errors}};
+    }
+    static std::array<casadi::DM*, 4> getOutputMatrices(
+            MultibodySystemImplicitOutput& output) {
+        return {{&output.multibody_residuals, &output.auxiliary_derivatives,
+                &output.auxiliary_residuals,
+                &output.kinematic_constraint_errors}};
+    }
+
     /// Clip endpoint to be as strict as b.
     void clipEndpointBounds(const Bounds& b, Bounds& endpoint) {
         endpoint.lower = std::max(b.lower, endpoint.lower);
@@ -20,8 +20,11 @@
 #include "CasOCTranscription.h"
 #include "CasOCTrapezoidal.h"
 
+#include <OpenSim/Common/NativeCodeCache.h>
 #include <OpenSim/Moco/MocoUtilities.h>
 
+#include <cstdlib>
+
 using OpenSim::Exception;
 
 namespace CasOC {
@@ -62,12 +65,22 @@ void Solver::setSparsityDetectionRandomCount(int count) {
 }
 
 void Solver::setParallelism(std::string parallelism, int numThreads) {
-    m_parallelism = parallelism;
+    OPENSIM_THROW_IF(parallelism != "serial" && parallelism != "thread",
+            OpenSim::Exception,
+            "Expected parallelism to be 'serial' or 'thread', but got '{}'.",
+            parallelism);
     OPENSIM_THROW_IF(numThreads < 1, OpenSim::Exception,
             "Expected numThreads >= 1 but got {}.", numThreads);
+    m_parallelism = std::move(parallelism);
     m_numThreads = numThreads;
 }
 
+std::string Solver::getCodeGenerationDirectory() const {
+    if (!m_codeGenerationDirectory.empty()) return m_codeGenerationDirectory;
+    if (const char* dir = std::getenv("OPENSIM_MOCO_CODEGEN_DIR")) return dir;
+    return OpenSim::NativeCodeCache::getDefaultDirectory("moco_codegen");
+}
+
 Solution Solver::solve(const Iterate& guess) const {
     auto transcription = createTranscription();
     auto pointsForSparsityDetection =
@@ -144,16 +144,55 @@ public:
     }
     std::string getWriteSparsity() const { return m_write_sparsity; }
 
-    /// Use this to tell CasADi to evaluate differential-algebraic equations,
-    /// path constraints, integrands, etc. in parallel across grid points.
-    /// "parallelism" is passed on directly to
-    /// the "parallelism" argument of casadi::MX::map(). CasADi supports
-    /// "serial", "openmp", "thread", and perhaps some other options.
+    /// Print a table of the number of evaluations of each function (e.g.,
+    /// each goal, path constraint, and the multibody system) and the time
+    /// spent in them after solving.
+    void setPrintProfile(bool tf) { m_printProfile = tf; }
+    bool getPrintProfile() const { return m_printProfile; }
+
+    /// Use this to evaluate differential-algebraic equations, path
+    /// constraints, integrands, etc. in parallel across grid points.
+    /// "parallelism" is "thread" to evaluate on numThreads threads (see
+    /// WorkerPool) or "serial" to evaluate the grid points serially. Other
+    /// values (e.g., CasADi's "openmp") are not supported.
     void setParallelism(std::string parallelism, int numThreads);
     std::pair<std::string, int> getParallelism() const {
         return std::make_pair(m_parallelism, m_numThreads);
     }
 
+    /// Convert the parts of the problem that are pure CasADi expressions
+    /// (the defect constraints and the constraints on interpolated controls)
+    /// into functions of scalar expressions, and compile these functions and
+    /// their derivatives to native code with the C compiler (the environment
+    /// variable CC, or "cc", which may not contain characters that the shell
+    /// interprets). The compiled code is cached in
+    /// getCodeGenerationDirectory() and reused by later solves with the same
+    /// mesh and the same numbers of states and controls. If compiling fails,
+    /// the scalar functions are used without compiling them.
+    void setCodeGeneration(bool tf) { m_codeGeneration = tf; }
+    bool getCodeGeneration() const { return m_codeGeneration; }
+    /// The directory for compiled code (default: the environment variable
+    /// OPENSIM_MOCO_CODEGEN_DIR, or
+    /// OpenSim::NativeCodeCache::getDefaultDirectory("moco_codegen"), e.g.,
+    /// `~/.cache/opensim/moco_codegen`). Compiled code is loaded only from a
+    /// directory that is private to the current user (see
+    /// OpenSim::NativeCodeCache).
+    void setCodeGenerationDirectory(std::string directory) {
+        m_codeGenerationDirectory = std::move(directory);
+    }
+    std::string getCodeGenerationDirectory() const;
+
+    /// Set this to true if the optimizer uses exact Hessians (e.g., IPOPT's
+    /// hessian_approximation is "exact"). Then, the functions that are
+    /// evaluated across grid points provide reverse derivatives computed
+    /// with colored finite differences (see TrajectoryReverse), and CasADi
+    /// computes the Hessian of the Lagrangian by differentiating these with
+    /// finite differences, using the block sparsity of the grid points.
+    /// Otherwise, CasADi would compute the Hessian with nested finite
+    /// differences over the whole trajectory, which is prohibitively slow.
+    void setExactHessian(bool tf) { m_exactHessian = tf; }
+    bool getExactHessian() const { return m_exactHessian; }
+
     void setPluginOptions(casadi::Dict opts) {
         m_pluginOptions = std::move(opts);
     }
@@ -189,10 +228,14 @@ private:
     std::string m_finite_difference_scheme = "central";
     std::string m_sparsity_detection = "none";
     std::string m_write_sparsity;
+    bool m_printProfile = false;
     int m_callbackInterval = 0;
     int m_sparsity_detection_random_count = 3;
     std::string m_parallelism = "serial";
     int m_numThreads = 1;
+    bool m_codeGeneration = false;
+    std::string m_codeGenerationDirectory;
+    bool m_exactHessian = false;
     casadi::Dict m_pluginOptions;
     casadi::Dict m_solverOptions;
     std::string m_optimSolver;
@@ -17,6 +17,15 @@
  * -------------------------------------------------------------------------- */
 #include "CasOCTranscription.h"
 
+#include <OpenSim/Common/Logger.h>
+#include <OpenSim/Common/NativeCodeCache.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <sstream>
+
 using casadi::DM;
 using casadi::MX;
 using casadi::MXVector;
@@ -445,6 +454,79 @@ void Transcription::transcribe() {
     calcInterpolatingControls();
 }
 
+void Transcription::calcDefects() {
+    if (!m_solver.getCodeGeneration()) {
+        calcDefectsImpl(m_vars.at(states), m_xdot, m_constraints.defects);
+        return;
+    }
+    // The defects depend on the state derivatives, which are computed by
+    // OpenSim callbacks, so a symbol stands in for them. The times depend on
+    // the initial and final time variables.
+    const MX xdot = MX::sym("xdot", m_xdot.size1(), m_xdot.size2());
+    MX defects = m_constraints.defects;
+    calcDefectsImpl(m_vars.at(states), xdot, defects);
+    const casadi::Function function("casoc_defects",
+            {m_vars.at(states), xdot, m_vars.at(initial_time),
+                    m_vars.at(final_time)},
+            {defects});
+    m_constraints.defects = compileFunction(function)(
+            MXVector{m_vars.at(states), m_xdot, m_vars.at(initial_time),
+                    m_vars.at(final_time)}).at(0);
+}
+
+void Transcription::calcInterpolatingControls() {
+    if (!m_solver.getCodeGeneration() || !m_pointsForInterpControls.numel()) {
+        calcInterpolatingControlsImpl(
+                m_vars.at(controls), m_constraints.interp_controls);
+        return;
+    }
+    MX interpControls = m_constraints.interp_controls;
+    calcInterpolatingControlsImpl(m_vars.at(controls), interpControls);
+    const casadi::Function function("casoc_interp_controls",
+            {m_vars.at(controls)}, {interpControls});
+    m_constraints.interp_controls =
+            compileFunction(function)(MXVector{m_vars.at(controls)}).at(0);
+}
+
+casadi::Function Transcription::compileFunction(
+        const casadi::Function& function) const {
+    // Scalar expressions avoid the overhead of the MX virtual machine, which
+    // evaluates the slicing operations for each mesh interval.
+    const casadi::Function expanded = function.expand();
+    const std::string& name = function.name();
+
+    // casadi::external() looks up the derivatives that CasADi requests by
+    // these names (e.g., "fwd1_<name>", "adj1_<name>", "jac_<name>"). The
+    // Jacobian of the reverse derivative supports exact Hessians.
+    casadi::CodeGenerator generator(name + ".c", {{"with_header", false}});
+    generator.add(expanded);
+    generator.add(expanded.forward(1));
+    generator.add(expanded.reverse(1));
+    generator.add(expanded.jacobian());
+    generator.add(expanded.reverse(1).jacobian());
+    const std::string source = generator.dump();
+
+    // The library is named by a hash of the source code, which contains the
+    // mesh and the numbers of variables.
+    const char* cc = std::getenv("CC");
+    OpenSim::log_debug("Generated {} for {} mesh intervals.", name,
+            m_numMeshIntervals);
+    const std::string library = OpenSim::NativeCodeCache::getLibrary(
+            m_solver.getCodeGenerationDirectory(), name, source, "c",
+            cc ? cc : "cc", "-O1 -shared -fPIC");
+    if (library.empty()) {
+        OpenSim::log_warn("Using {} without compiling it.", name);
+        return expanded;
+    }
+    try {
+        return casadi::external(name, library);
+    } catch (const std::exception& e) {
+        OpenSim::log_warn("Failed to load {}: {}; using it without "
+                          "compiling.", library, e.what());
+        return expanded;
+    }
+}
+
 void Transcription::setObjectiveAndEndpointConstraints() {
     DM quadCoeffs = this->createQuadratureCoefficients();
 
@@ -643,6 +725,31 @@ Solution Transcription::solve(const Iterate& guessOrig) {
     auto g = flattenConstraints(m_constraints);
     casadi_int numConstraints = g.numel();
 
+    // Warm start the optimizer with the multipliers in the guess, if they
+    // are for an NLP of this size.
+    const bool warmStart =
+            guessOrig.variable_bound_multipliers.numel() == numVariables &&
+            guessOrig.constraint_multipliers.numel() == numConstraints;
+    if (warmStart && m_solver.getOptimSolver() == "ipopt") {
+        casadi::Dict solverOptions = m_solver.getSolverOptions();
+        auto setDefault = [&solverOptions](const std::string& name,
+                                  const casadi::GenericType& value) {
+            if (!solverOptions.count(name)) solverOptions[name] = value;
+        };
+        setDefault("warm_start_init_point", "yes");
+        // By default, IPOPT moves the initial point and multipliers away
+        // from the bounds, which undoes much of the warm start.
+        setDefault("warm_start_bound_push", 1e-9);
+        setDefault("warm_start_bound_frac", 1e-9);
+        setDefault("warm_start_slack_bound_push", 1e-9);
+        setDefault("warm_start_slack_bound_frac", 1e-9);
+        setDefault("warm_start_mult_bound_push", 1e-9);
+        if (std::isfinite(guessOrig.barrier_parameter)) {
+            setDefault("mu_init", guessOrig.barrier_parameter);
+        }
+        options["ipopt"] = solverOptions;
+    }
+
     NlpsolCallback callback(*this, m_problem, numVariables, numConstraints,
             m_solver.getCallbackInterval());
     options["iteration_callback"] = callback;
@@ -681,12 +788,19 @@ Solution Transcription::solve(const Iterate& guessOrig) {
     // Run the optimization (evaluate the CasADi NLP function).
     // --------------------------------------------------------
     // The inputs and outputs of nlpFunc are numeric (casadi::DM).
-    const casadi::DMDict nlpResult =
-            nlpFunc(casadi::DMDict{{"x0", flattenVariables(guess.variables)},
-                    {"lbx", flattenVariables(m_lowerBounds)},
-                    {"ubx", flattenVariables(m_upperBounds)},
-                    {"lbg", flattenConstraints(m_constraintsLowerBounds)},
-                    {"ubg", flattenConstraints(m_constraintsUpperBounds)}});
+    const auto solveStart = std::chrono::steady_clock::now();
+    casadi::DMDict nlpArgs{{"x0", flattenVariables(guess.variables)},
+            {"lbx", flattenVariables(m_lowerBounds)},
+            {"ubx", flattenVariables(m_upperBounds)},
+            {"lbg", flattenConstraints(m_constraintsLowerBounds)},
+            {"ubg", flattenConstraints(m_constraintsUpperBounds)}};
+    if (warmStart) {
+        nlpArgs["lam_x0"] = guessOrig.variable_bound_multipliers;
+        nlpArgs["lam_g0"] = guessOrig.constraint_multipliers;
+    }
+    const casadi::DMDict nlpResult = nlpFunc(nlpArgs);
+    const double solveTime = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - solveStart).count();
 
     // Create a CasOC::Solution.
     // -------------------------
@@ -704,9 +818,23 @@ Solution Transcription::solve(const Iterate& guessOrig) {
     solution.times = createTimes(
             solution.variables[initial_time], solution.variables[final_time]);
     solution.stats = nlpFunc.stats();
+    solution.variable_bound_multipliers = nlpResult.at("lam_x");
+    solution.constraint_multipliers = nlpResult.at("lam_g");
+    // IPOPT reports the barrier parameter of each iteration.
+    if (solution.stats.count("iterations") &&
+            solution.stats.at("iterations").is_dict()) {
+        const auto& iterations = solution.stats.at("iterations").as_dict();
+        if (iterations.count("mu") &&
+                iterations.at("mu").is_double_vector() &&
+                !iterations.at("mu").as_double_vector().empty()) {
+            solution.barrier_parameter =
+                    iterations.at("mu").as_double_vector().back();
+        }
+    }
 
     // Print breakdown of objective.
     printObjectiveBreakdown(solution, objectiveOut[0]);
+    if (m_solver.getPrintProfile()) printProfile(solution, solveTime);
 
     if (!solution.stats.at("success")) {
 
@@ -1120,6 +1248,51 @@ void Transcription::printObjectiveBreakdown(const Iterate& it,
     }
 }
 
+void Transcription::printProfile(const Solution& solution, double solveTime,
+        std::ostream& stream) const {
+    std::stringstream ss;
+    ss << "Breakdown of function evaluations (including finite differences):";
+    ss << fmt::format("\n  {:<50} {:>8} {:>10} {:>10} {:>7}", "function",
+            "calls", "points", "time (s)", "%");
+    auto functions = m_problem.getFunctions();
+    std::stable_sort(functions.begin(), functions.end(),
+            [](const Function* a, const Function* b) {
+                return a->getEvaluationTime() > b->getEvaluationTime();
+            });
+    for (const auto* function : functions) {
+        if (!function->getNumEvaluations()) continue;
+        ss << fmt::format("\n  {:<50} {:>8} {:>10} {:>10.3f} {:>7.1f}",
+                function->name(), function->getNumEvaluations(),
+                function->getNumPointsEvaluated(),
+                function->getEvaluationTime(),
+                100.0 * function->getEvaluationTime() / solveTime);
+    }
+    // The optimizer reports the time spent evaluating each NLP function; the
+    // derivatives include the finite differences of the functions above.
+    ss << "\nBreakdown of NLP function evaluations:";
+    ss << fmt::format("\n  {:<50} {:>8} {:>10} {:>10} {:>7}", "function",
+            "calls", "", "time (s)", "%");
+    for (const std::string nlpFunction : {"nlp_f", "nlp_g", "nlp_grad_f",
+                 "nlp_grad", "nlp_jac_g", "nlp_hess_l"}) {
+        const auto time = solution.stats.find("t_wall_" + nlpFunction);
+        const auto calls = solution.stats.find("n_call_" + nlpFunction);
+        if (time == solution.stats.end() || calls == solution.stats.end()) {
+            continue;
+        }
+        const double seconds = time->second;
+        ss << fmt::format("\n  {:<50} {:>8} {:>10} {:>10.3f} {:>7.1f}",
+                nlpFunction, casadi_int(calls->second), "", seconds,
+                100.0 * seconds / solveTime);
+    }
+    ss << fmt::format("\n  {:<50} {:>8} {:>10} {:>10.3f} {:>7.1f}",
+            "total (solve)", "", "", solveTime, 100.0);
+    if (stream.rdbuf() == std::cout.rdbuf()) {
+        OpenSim::log_cout(ss.str());
+    } else {
+        stream << ss.str() << std::endl;
+    }
+}
+
 Iterate Transcription::createInitialGuessFromBounds() const {
     auto setToMidpoint = [](DM& output, const DM& lowerDM, const DM& upperDM) {
         for (int irow = 0; irow < output.rows(); ++irow) {
@@ -1177,11 +1350,18 @@ Iterate Transcription::createRandomIterateWithinBounds(
 }
 
 casadi::MXVector Transcription::evalOnTrajectory(
-        const casadi::Function& pointFunction, const std::vector<Var>& inputs,
-        const casadi::Matrix<casadi_int>& timeIndices) const {
+        const Function& pointFunction, const std::vector<Var>& inputs,
+        const casadi::Matrix<casadi_int>& timeIndices) {
     auto parallelism = m_solver.getParallelism();
-    const auto trajFunc = pointFunction.map(
-            timeIndices.size2(), parallelism.first, parallelism.second);
+    if (!m_workerPool && parallelism.first == "thread" &&
+            parallelism.second > 1) {
+        m_workerPool.reset(new WorkerPool(parallelism.second));
+    }
+    m_trajectoryFunctions.emplace_back(new TrajectoryFunction());
+    auto& trajFunc = *m_trajectoryFunctions.back();
+    trajFunc.constructFunction(&pointFunction, (int)timeIndices.size2(),
+            m_workerPool.get(), m_solver.getFiniteDifferenceScheme(),
+            m_solver.getExactHessian());
 
     // Assemble input.
     // Add 1 for time input and 1 for parameters input.
@@ -1210,17 +1390,6 @@ casadi::MXVector Transcription::evalOnTrajectory(
     MXVector mxOut;
     trajFunc.call(mxIn, mxOut);
     return mxOut;
-    // TODO: Avoid the overhead of map() if not running in parallel.
-    /* } else {
-    casadi::MXVector out(pointFunction.n_out());
-    for (int iout = 0; iout < (int)out.size(); ++iout) {
-    out[iout] = casadi::MX(pointFunction.sparsity_out(iout).rows(),
-    timeIndices.size2());
-    }
-    for (int itime = 0; itime < timeIndices.size2(); ++itime) {
-
-    }
-    }*/
 }
 
 } // namespace CasOC
@@ -77,9 +77,12 @@ protected:
 
     /// We assume all functions depend on time and parameters.
     /// "inputs" is prepended by time and postpended (?) by parameters.
-    casadi::MXVector evalOnTrajectory(const casadi::Function& pointFunction,
+    /// The function is evaluated at all points by a TrajectoryFunction, which
+    /// this object owns, along with the WorkerPool shared by all
+    /// TrajectoryFunctions (if the solver's parallelism is "thread").
+    casadi::MXVector evalOnTrajectory(const Function& pointFunction,
             const std::vector<Var>& inputs,
-            const casadi::Matrix<casadi_int>& timeIndices) const;
+            const casadi::Matrix<casadi_int>& timeIndices);
 
     template <typename TRow, typename TColumn>
     void setVariableBounds(Var var, const TRow& rowIndices,
@@ -112,6 +115,12 @@ protected:
     void printObjectiveBreakdown(const Iterate& it,
             const casadi::DM& objectiveTerms,
             std::ostream& stream = std::cout) const;
+    /// Print the number of evaluations of each of the problem's functions
+    /// and the time spent in them, followed by the NLP-level timings that
+    /// the optimizer reports (e.g., for the constraint Jacobian, which is
+    /// computed with finite differences).
+    void printProfile(const Solution& solution, double solveTime,
+            std::ostream& stream = std::cout) const;
 
     const Solver& m_solver;
     const Problem& m_problem;
@@ -143,6 +152,10 @@ private:
 
     casadi::MX m_xdot; // State derivatives.
 
+    // These must outlive the NLP, whose expressions refer to them.
+    std::unique_ptr<WorkerPool> m_workerPool;
+    std::vector<std::unique_ptr<TrajectoryFunction>> m_trajectoryFunctions;
+
     casadi::MX m_objectiveTerms;
     std::vector<std::string> m_objectiveTermNames;
 
@@ -172,13 +185,12 @@ private:
 
     void transcribe();
     void setObjectiveAndEndpointConstraints();
-    void calcDefects() {
-        calcDefectsImpl(m_vars.at(states), m_xdot, m_constraints.defects);
-    }
-    void calcInterpolatingControls() {
-        calcInterpolatingControlsImpl(
-                m_vars.at(controls), m_constraints.interp_controls);
-    }
+    void calcDefects();
+    void calcInterpolatingControls();
+    /// Convert a function of pure CasADi expressions into a function of
+    /// scalar expressions and, if possible, compile it and its derivatives
+    /// into a shared library (see Solver::setCodeGeneration()).
+    casadi::Function compileFunction(const casadi::Function& function) const;
 
     /// Use this function to ensure you iterate through variables in the same
     /// order.
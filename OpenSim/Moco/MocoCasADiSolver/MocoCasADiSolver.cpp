@@ -45,6 +45,8 @@ void MocoCasADiSolver::constructProperties() {
     constructProperty_optim_write_sparsity("");
     constructProperty_optim_finite_difference_scheme("central");
     constructProperty_parallel();
+    constructProperty_optim_code_generation(false);
+    constructProperty_print_profile(false);
     constructProperty_output_interval(0);
 
     constructProperty_minimize_implicit_multibody_accelerations(false);
@@ -273,10 +275,14 @@ std::unique_ptr<CasOC::Solver> MocoCasADiSolver::createCasOCSolver(
     casSolver->setSparsityDetectionRandomCount(3);
 
     casSolver->setWriteSparsity(get_optim_write_sparsity());
+    casSolver->setPrintProfile(get_print_profile());
 
     checkPropertyValueIsInSet(getProperty_optim_finite_difference_scheme(),
             {"central", "forward", "backward"});
     casSolver->setFiniteDifferenceScheme(get_optim_finite_difference_scheme());
+    casSolver->setCodeGeneration(get_optim_code_generation());
+    casSolver->setExactHessian(get_optim_solver() == "ipopt" &&
+                               get_optim_hessian_approximation() == "exact");
 
     casSolver->setCallbackInterval(get_output_interval());
 
@@ -357,6 +363,13 @@ MocoSolution MocoCasADiSolver::solveImpl() const {
         casGuess = casSolver->createInitialGuessFromBounds();
     } else {
         casGuess = convertToCasOCIterate(guess);
+        if (m_warmStartMultipliers) {
+            casGuess.variable_bound_multipliers =
+                    casadi::DM(m_lastMultipliers.variableBounds);
+            casGuess.constraint_multipliers =
+                    casadi::DM(m_lastMultipliers.constraints);
+            casGuess.barrier_parameter = m_lastMultipliers.barrierParameter;
+        }
     }
 
     // Temporarily disable printing of negative muscle force warnings so the
@@ -370,6 +383,11 @@ MocoSolution MocoCasADiSolver::solveImpl() const {
         OpenSim::Logger::setLevel(origLoggerLevel);
     }
     OpenSim::Logger::setLevel(origLoggerLevel);
+    m_lastMultipliers.variableBounds =
+            casSolution.variable_bound_multipliers.nonzeros();
+    m_lastMultipliers.constraints =
+            casSolution.constraint_multipliers.nonzeros();
+    m_lastMultipliers.barrierParameter = casSolution.barrier_parameter;
 
     MocoSolution mocoSolution =
             convertToMocoTrajectory<MocoSolution>(casSolution);
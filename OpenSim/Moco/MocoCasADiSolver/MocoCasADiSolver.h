@@ -71,6 +71,19 @@ The "central" finite difference is more accurate but can be 2 times
 slower than "forward" (tested on exampleSlidingMass). Sometimes, problems
 may struggle to converge with "forward".
 
+Exact Hessian
+=============
+With `optim_hessian_approximation` set to "exact", IPOPT uses the Hessian
+of the Lagrangian rather than a quasi-Newton approximation, which usually
+requires far fewer iterations. The functions that are evaluated across mesh
+points (e.g., the multibody system and the path constraints) provide their
+gradients, computed with finite differences in which inputs that do not
+affect the same outputs are perturbed together, at all mesh points at once.
+CasADi differentiates these gradients with finite differences, and uses the
+block structure of the mesh points to compute many columns of the Hessian
+with each evaluation. Each iteration is still more expensive than with
+"limited-memory", especially for models with many states and controls.
+
 Parallelization
 ===============
 By default, CasADi evaluate the integral cost integrand and the
@@ -98,6 +111,36 @@ not affect the solution. We encourage you to use the environment variable
 instead, as this allows different users to solve the same problem with the
 parallelization they prefer.
 
+Code generation
+===============
+The defect constraints of the transcription scheme and the constraints on
+interpolated controls do not depend on the model; they are CasADi
+expressions of the variables and of the state derivatives computed by the
+model. With the `optim_code_generation` property, these expressions are
+converted into functions of scalar expressions, and these functions and
+their derivatives are compiled to native code with the C compiler (the
+environment variable CC, or "cc"). This avoids the overhead of CasADi's
+virtual machine in every iteration, which matters for problems with many
+mesh intervals. The compiled code is cached on disk (in the directory given
+by the OPENSIM_MOCO_CODEGEN_DIR environment variable, or in
+`opensim/moco_codegen` in the user's cache directory, e.g.,
+`~/.cache/opensim/moco_codegen`) and reused by later solves with the same mesh and the same
+numbers of states and controls, so only the first solve pays for compiling.
+Compiled code is loaded only from a directory that is owned by the current
+user and not writable by others (see OpenSim::NativeCodeCache). If
+compiling fails, the scalar functions are used without compiling them.
+This does not affect the solution.
+
+Profiling
+=========
+To find out which parts of a problem take the most time to evaluate, set
+the `print_profile` property to true. After solving, the solver prints the
+number of evaluations (and grid points evaluated) for each goal, path
+constraint, and the multibody system, and the wall time spent in them,
+including the evaluations used to compute derivatives with finite
+differences. The solver also prints the time that the optimizer spent
+evaluating the objective, constraints, and their derivatives.
+
 Parameter variables
 ===================
 By default, MocoCasADiSolver is much slower than MocoTroperSolver at
@@ -144,6 +187,14 @@ public:
             "0: not parallel; 1: use all cores (default); greater than 1: use"
             "this number of parallel jobs. This overrides the OPENSIM_MOCO_PARALLEL "
             "environment variable.");
+    OpenSim_DECLARE_PROPERTY(optim_code_generation, bool,
+            "Compile the defect constraints and the constraints on "
+            "interpolated controls, and their derivatives, to native code "
+            "(default: false). See the class description.");
+    OpenSim_DECLARE_PROPERTY(print_profile, bool,
+            "After solving, print the number of evaluations of each goal, "
+            "path constraint, and the multibody system, and the time spent "
+            "in them (default: false).");
     OpenSim_DECLARE_PROPERTY(output_interval, int,
             "Write intermediate trajectories to file. 0, the default, "
             "indicates no intermediate trajectories are saved, 1 indicates "
@@ -216,6 +267,23 @@ public:
 
     /// @}
 
+    /// @name Warm starting
+    /// @{
+
+    /// If true, start the next solve from the multipliers of the optimization
+    /// problem (for the bounds on the variables and for the constraints) and
+    /// the barrier parameter from the final iterate of the last solve, in
+    /// addition to the guess (default: false). This is meaningful only if the
+    /// guess is the solution of the last solve and the problem changed only
+    /// slightly (see MocoStudy::solveSequence()). The multipliers are not
+    /// used if the optimization problem does not have the same numbers of
+    /// variables and constraints as in the last solve. Only IPOPT uses the
+    /// multipliers.
+    void setWarmStartMultipliers(bool tf) { m_warmStartMultipliers = tf; }
+    bool getWarmStartMultipliers() const { return m_warmStartMultipliers; }
+
+    /// @}
+
 protected:
     MocoSolution solveImpl() const override;
 
@@ -235,6 +303,16 @@ private:
     MocoTrajectory m_guessFromAPI;
     mutable SimTK::ResetOnCopy<MocoTrajectory> m_guessFromFile;
     mutable SimTK::ReferencePtr<const MocoTrajectory> m_guessToUse;
+
+    bool m_warmStartMultipliers = false;
+    // The multipliers of the optimization problem and the barrier parameter
+    // from the final iterate of the last solve.
+    struct OptimMultipliers {
+        std::vector<double> variableBounds;
+        std::vector<double> constraints;
+        double barrierParameter = SimTK::NaN;
+    };
+    mutable SimTK::ResetOnCopy<OptimMultipliers> m_lastMultipliers;
 };
 
 } // namespace OpenSim
@@ -57,8 +57,9 @@ MocoCasOCProblem::MocoCasOCProblem(const MocoCasADiSolver& mocoCasADiSolver,
         setPrescribedKinematics(true, model.getWorkingState().getNU());
     }
 
+    std::unordered_map<int, int> yIndexMap;
     auto stateNames =
-            problemRep.createStateVariableNamesInSystemOrder(m_yIndexMap);
+            problemRep.createStateVariableNamesInSystemOrder(yIndexMap);
     setTimeBounds(convertBounds(problemRep.getTimeInitialBounds()),
             convertBounds(problemRep.getTimeFinalBounds()));
     for (const auto& stateName : stateNames) {
@@ -74,6 +75,10 @@ MocoCasOCProblem::MocoCasOCProblem(const MocoCasADiSolver& mocoCasADiSolver,
                 convertBounds(info.getInitialBounds()),
                 convertBounds(info.getFinalBounds()));
     }
+    m_coordinateQIndices.resize(getNumCoordinates());
+    for (int isv = 0; isv < getNumCoordinates(); ++isv) {
+        m_coordinateQIndices[isv] = yIndexMap.at(isv);
+    }
 
     auto controlNames =
             createControlNamesFromModel(model, m_modelControlIndices);
@@ -205,7 +205,52 @@ private:
             bool calcKCErrors,
             MultibodySystemExplicitOutput& output) const override {
         auto mocoProblemRep = m_jar->take();
-
+        calcMultibodySystemExplicitImpl(
+                input, calcKCErrors, mocoProblemRep, output);
+        m_jar->leave(std::move(mocoProblemRep));
+    }
+    void calcMultibodySystemImplicit(const ContinuousInput& input,
+            bool calcKCErrors,
+            MultibodySystemImplicitOutput& output) const override {
+        auto mocoProblemRep = m_jar->take();
+        calcMultibodySystemImplicitImpl(
+                input, calcKCErrors, mocoProblemRep, output);
+        m_jar->leave(std::move(mocoProblemRep));
+    }
+    // The trajectory versions take a MocoProblemRep from the jar once for
+    // all points, rather than once per point, and reuse its States.
+    void calcMultibodySystemExplicitTrajectory(
+            const ContinuousInputTrajectory& input, bool calcKCErrors,
+            int begin, int end,
+            MultibodySystemExplicitOutput& output) const override {
+        if (begin == end) return;
+        auto mocoProblemRep = m_jar->take();
+        calcPointwise(input, begin, end, output,
+                [&](const ContinuousInput& pointInput,
+                        MultibodySystemExplicitOutput& pointOutput) {
+                    calcMultibodySystemExplicitImpl(pointInput, calcKCErrors,
+                            mocoProblemRep, pointOutput);
+                });
+        m_jar->leave(std::move(mocoProblemRep));
+    }
+    void calcMultibodySystemImplicitTrajectory(
+            const ContinuousInputTrajectory& input, bool calcKCErrors,
+            int begin, int end,
+            MultibodySystemImplicitOutput& output) const override {
+        if (begin == end) return;
+        auto mocoProblemRep = m_jar->take();
+        calcPointwise(input, begin, end, output,
+                [&](const ContinuousInput& pointInput,
+                        MultibodySystemImplicitOutput& pointOutput) {
+                    calcMultibodySystemImplicitImpl(pointInput, calcKCErrors,
+                            mocoProblemRep, pointOutput);
+                });
+        m_jar->leave(std::move(mocoProblemRep));
+    }
+    void calcMultibodySystemExplicitImpl(const ContinuousInput& input,
+            bool calcKCErrors,
+            const std::unique_ptr<const MocoProblemRep>& mocoProblemRep,
+            MultibodySystemExplicitOutput& output) const {
         const auto& modelBase = mocoProblemRep->getModelBase();
         auto& simtkStateBase = mocoProblemRep->updStateBase();
 
@@ -240,14 +285,11 @@ private:
         // Copy auxiliary residuals to output.
         copyImplicitResidualsToOutput(*mocoProblemRep,
                 simtkStateDisabledConstraints, output.auxiliary_residuals);
-
-        m_jar->leave(std::move(mocoProblemRep));
     }
-    void calcMultibodySystemImplicit(const ContinuousInput& input,
+    void calcMultibodySystemImplicitImpl(const ContinuousInput& input,
             bool calcKCErrors,
-            MultibodySystemImplicitOutput& output) const override {
-        auto mocoProblemRep = m_jar->take();
-
+            const std::unique_ptr<const MocoProblemRep>& mocoProblemRep,
+            MultibodySystemImplicitOutput& output) const {
         // Original model and its associated state. These are used to calculate
         // kinematic constraint forces and errors.
         const auto& modelBase = mocoProblemRep->getModelBase();
@@ -293,8 +335,6 @@ private:
         // Copy auxiliary residuals to output.
         copyImplicitResidualsToOutput(*mocoProblemRep,
                 simtkStateDisabledConstraints, output.auxiliary_residuals);
-
-        m_jar->leave(std::move(mocoProblemRep));
     }
     void calcVelocityCorrection(const double& time,
             const casadi::DM& multibody_states, const casadi::DM& slacks,
@@ -527,7 +567,8 @@ private:
             // Assign the generalized coordinates. We know we have NU
             // generalized speeds because we do not yet support quaternions.
             for (int isv = 0; isv < getNumCoordinates(); ++isv) {
-                simtkState.updQ()[m_yIndexMap.at(isv)] = *(states.ptr() + isv);
+                simtkState.updQ()[m_coordinateQIndices[isv]] =
+                        *(states.ptr() + isv);
             }
             std::copy_n(states.ptr() + getNumCoordinates(), getNumSpeeds(),
                     simtkState.updY().updContiguousScalarData() +
@@ -749,7 +790,8 @@ private:
     std::unique_ptr<ThreadsafeJar<const MocoProblemRep>> m_jar;
     bool m_paramsRequireInitSystem = true;
     std::string m_formattedTimeString;
-    std::unordered_map<int, int> m_yIndexMap;
+    // The index in Q of each coordinate state variable.
+    std::vector<int> m_coordinateQIndices;
     std::vector<int> m_modelControlIndices;
     std::unique_ptr<FileDeletionThrower> m_fileDeletionThrower;
     // Local memory to hold constraint forces.
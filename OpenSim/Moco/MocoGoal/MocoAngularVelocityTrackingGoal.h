@@ -19,6 +19,7 @@
  * -------------------------------------------------------------------------- */
 
 #include "MocoGoal.h"
+#include "MocoReferenceCache.h"
 
 #include <OpenSim/Common/GCVSplineSet.h>
 #include <OpenSim/Common/TimeSeriesTable.h>
@@ -171,6 +172,7 @@ private:
 
     TimeSeriesTableVec3 m_angular_velocity_table;
     mutable GCVSplineSet m_ref_splines;
+    mutable MocoReferenceCache m_ref_cache;
     mutable std::vector<std::string> m_frame_paths;
     mutable std::vector<SimTK::ReferencePtr<const Frame>> m_model_frames;
     mutable std::vector<double> m_angular_velocity_weights;
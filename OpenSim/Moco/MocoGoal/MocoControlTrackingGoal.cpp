@@ -140,6 +140,8 @@ void MocoControlTrackingGoal::initializeOnModelImpl(const Model& model) const {
         m_ref_labels.push_back(refLabel);
     }
 
+    m_ref_cache.clear();
+
     setRequirements(1, 1, SimTK::Stage::Model);
 }
 
@@ -147,14 +149,13 @@ void MocoControlTrackingGoal::calcIntegrandImpl(
         const IntegrandInput& input, SimTK::Real& integrand) const {
 
     const auto& time = input.time;
-    SimTK::Vector timeVec(1, time);
+    const double* refValues = m_ref_cache.getValues(m_ref_splines, time);
     const auto& controls = input.controls;
 
     integrand = 0;
     for (int i = 0; i < (int)m_control_indices.size(); ++i) {
         const auto& modelValue = controls[m_control_indices[i]];
-        const auto& refValue =
-                m_ref_splines[m_ref_indices[i]].calcValue(timeVec);
+        const auto& refValue = refValues[m_ref_indices[i]];
         integrand +=
                 m_control_weights[i] * SimTK::square(modelValue - refValue);
     }
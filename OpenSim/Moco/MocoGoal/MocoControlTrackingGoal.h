@@ -20,6 +20,7 @@
  * -------------------------------------------------------------------------- */
 
 #include "MocoGoal.h"
+#include "MocoReferenceCache.h"
 
 #include <OpenSim/Common/GCVSplineSet.h>
 #include <OpenSim/Common/TimeSeriesTable.h>
@@ -241,6 +242,7 @@ private:
     mutable std::vector<int> m_control_indices;
     mutable std::vector<double> m_control_weights;
     mutable GCVSplineSet m_ref_splines;
+    mutable MocoReferenceCache m_ref_cache;
     mutable std::vector<int> m_ref_indices;
     mutable std::vector<std::string> m_control_names;
     mutable std::vector<std::string> m_ref_labels;
@@ -163,6 +163,7 @@ void MocoOrientationTrackingGoal::initializeOnModelImpl(const Model& model)
     flatTable.setColumnLabels(colLabels);
 
     m_ref_splines = GCVSplineSet(flatTable);
+    m_ref_cache.clear();
 
     setRequirements(1, 1, SimTK::Stage::Position);
 }
@@ -171,7 +172,7 @@ void MocoOrientationTrackingGoal::calcIntegrandImpl(
         const IntegrandInput& input, SimTK::Real& integrand) const {
     const auto& time = input.state.getTime();
     getModel().realizePosition(input.state);
-    SimTK::Vector timeVec(1, time);
+    const double* refValues = m_ref_cache.getValues(m_ref_splines, time);
 
     // Rotation frame symbols: 
     //  G - ground
@@ -190,10 +191,10 @@ void MocoOrientationTrackingGoal::calcIntegrandImpl(
         // seems to be sufficient for the purposes of this cost. 
         // https://keithmaggio.wordpress.com/2011/02/15/math-magician-lerp-slerp-and-nlerp/
         const SimTK::Quaternion e(
-            m_ref_splines[4*iframe].calcValue(timeVec),
-            m_ref_splines[4*iframe + 1].calcValue(timeVec),
-            m_ref_splines[4*iframe + 2].calcValue(timeVec),
-            m_ref_splines[4*iframe + 3].calcValue(timeVec));
+            refValues[4*iframe],
+            refValues[4*iframe + 1],
+            refValues[4*iframe + 2],
+            refValues[4*iframe + 3]);
         // Construct a Rotation object from which we'll calcuation an angle-axis 
         // representation of the current orientation error.
         const Rotation R_GD(e);
@@ -0,0 +1,51 @@
+/* -------------------------------------------------------------------------- *
+ * OpenSim: MocoReferenceCache.cpp                                            *
+ * -------------------------------------------------------------------------- *
+ * Copyright (c) 2021 Stanford University and the Authors                     *
+ *                                                                            *
+ * Author(s): OpenSim Team                                                    *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0          *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "MocoReferenceCache.h"
+
+using namespace OpenSim;
+
+void MocoReferenceCache::clear() {
+    m_rows.clear();
+    m_values.clear();
+}
+
+const double* MocoReferenceCache::getValues(
+        const GCVSplineSet& splines, double time) {
+    const int numSplines = splines.getSize();
+    if (numSplines == 0) return nullptr;
+    const auto it = m_rows.find(time);
+    if (it != m_rows.end()) {
+        return m_values.data() + (size_t)it->second * numSplines;
+    }
+    double* row;
+    if ((int)m_rows.size() < m_capacity) {
+        const int index = (int)m_rows.size();
+        m_rows.emplace(time, index);
+        m_values.resize((size_t)(index + 1) * numSplines);
+        row = m_values.data() + (size_t)index * numSplines;
+    } else {
+        m_uncached.resize(numSplines);
+        row = m_uncached.data();
+    }
+    m_time[0] = time;
+    for (int i = 0; i < numSplines; ++i) {
+        row[i] = splines[i].calcValue(m_time);
+    }
+    return row;
+}
@@ -0,0 +1,64 @@
+#ifndef OPENSIM_MOCOREFERENCECACHE_H
+#define OPENSIM_MOCOREFERENCECACHE_H
+/* -------------------------------------------------------------------------- *
+ * OpenSim: MocoReferenceCache.h                                              *
+ * -------------------------------------------------------------------------- *
+ * Copyright (c) 2021 Stanford University and the Authors                     *
+ *                                                                            *
+ * Author(s): OpenSim Team                                                    *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0          *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include <OpenSim/Moco/osimMocoDLL.h>
+
+#include <OpenSim/Common/GCVSplineSet.h>
+
+#include <unordered_map>
+#include <vector>
+
+namespace OpenSim {
+
+/** This class caches the values of a tracking goal's reference splines at the
+times at which the goal is evaluated. When the initial and final times of the
+problem are fixed, a direct collocation solver evaluates integrands at the same
+grid points in every iteration, so each spline is evaluated only once per grid
+point and later evaluations are a lookup. When the times change between
+iterations (e.g., the final time is a variable), the cache fills up to its
+capacity and further times are evaluated with the splines.
+
+A goal owns one cache per spline set; the cache must be cleared whenever the
+splines change (i.e., in MocoGoal::initializeOnModelImpl()). Like the goal
+that owns it, a cache must not be used by multiple threads at once. */
+class OSIMMOCO_API MocoReferenceCache {
+public:
+    /// @param capacity The maximum number of times for which values are
+    /// stored.
+    explicit MocoReferenceCache(int capacity = 4096) : m_capacity(capacity) {}
+    /// Discard all cached values.
+    void clear();
+    /// The values of all splines in the set at the given time, in the order
+    /// of the set. The returned pointer is valid until the next call.
+    const double* getValues(const GCVSplineSet& splines, double time);
+    /// The number of times for which values are cached.
+    int getNumTimes() const { return (int)m_rows.size(); }
+
+private:
+    int m_capacity;
+    std::unordered_map<double, int> m_rows;
+    std::vector<double> m_values;
+    std::vector<double> m_uncached;
+    SimTK::Vector m_time = SimTK::Vector(1, 0.0);
+};
+
+} // namespace OpenSim
+
+#endif // OPENSIM_MOCOREFERENCECACHE_H
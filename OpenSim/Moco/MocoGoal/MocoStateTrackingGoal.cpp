@@ -98,6 +98,8 @@ void MocoStateTrackingGoal::initializeOnModelImpl(const Model& model) const {
         m_state_names.push_back(refName);
     }
 
+    m_refcache.clear();
+
     setRequirements(1, 1, SimTK::Stage::Time);
 }
 
@@ -105,14 +107,14 @@ void MocoStateTrackingGoal::calcIntegrandImpl(
         const IntegrandInput& input, SimTK::Real& integrand) const {
     const auto& time = input.time;
 
-    SimTK::Vector timeVec(1, time);
+    // The reference values at the mesh points are cached, rather than
+    // evaluating the splines in every iteration.
+    const double* refValues = m_refcache.getValues(m_refsplines, time);
 
-    // TODO cache the reference coordinate values at the mesh points, rather
-    // than evaluating the spline.
     integrand = 0;
     for (int iref = 0; iref < m_refsplines.getSize(); ++iref) {
         const auto& modelValue = input.state.getY()[m_sysYIndices[iref]];
-        const auto& refValue = m_refsplines[iref].calcValue(timeVec);
+        const auto& refValue = refValues[iref];
         integrand +=
                 m_state_weights[iref] * SimTK::square(modelValue - refValue);
     }
@@ -130,6 +130,7 @@ void MocoTranslationTrackingGoal::initializeOnModelImpl(const Model& model)
 
     m_ref_splines = GCVSplineSet(translationTable.flatten(
         {"/position_x", "/position_y", "/position_z"}));
+    m_ref_cache.clear();
 
     setRequirements(1, 1, SimTK::Stage::Position);
 }
@@ -138,7 +139,7 @@ void MocoTranslationTrackingGoal::calcIntegrandImpl(
         const IntegrandInput& input, SimTK::Real& integrand) const {
     const auto& time = input.state.getTime();
     getModel().realizePosition(input.state);
-    SimTK::Vector timeVec(1, time);
+    const double* refValues = m_ref_cache.getValues(m_ref_splines, time);
 
     integrand = 0;
     Vec3 position_ref;
@@ -150,7 +151,7 @@ void MocoTranslationTrackingGoal::calcIntegrandImpl(
 
         for (int ip = 0; ip < position_ref.size(); ++ip) {
             position_ref[ip] =
-                    m_ref_splines[3*iframe + ip].calcValue(timeVec);
+                    refValues[3*iframe + ip];
         }
         Vec3 error = position_model - position_ref;
 
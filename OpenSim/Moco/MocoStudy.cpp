@@ -102,6 +102,82 @@ MocoSolution MocoStudy::solve() const {
     return solution;
 }
 
+std::vector<MocoSolution> MocoStudy::solveSequence(
+        const std::vector<std::function<void(MocoStudy&)>>& modifications) {
+    std::vector<MocoSolution> solutions;
+    solutions.reserve(modifications.size());
+    // The index of the last successful solution.
+    int lastSuccess = -1;
+    // The CasADi solver whose warm-start setting we changed, and its
+    // original setting, which we restore when we are done.
+    MocoCasADiSolver* warmStartSolver = nullptr;
+    bool origWarmStartMultipliers = false;
+    auto restoreWarmStart = [&]() {
+        if (warmStartSolver && warmStartSolver ==
+                        dynamic_cast<MocoCasADiSolver*>(&upd_solver())) {
+            warmStartSolver->setWarmStartMultipliers(origWarmStartMultipliers);
+        }
+    };
+    auto setGuessToLastSuccess = [&]() {
+        if (lastSuccess == -1) return;
+        MocoSolver& solver = upd_solver();
+        const MocoTrajectory guess = solutions[lastSuccess];
+        if (auto* casadiSolver = dynamic_cast<MocoCasADiSolver*>(&solver)) {
+            casadiSolver->setGuess(guess);
+        } else if (auto* tropterSolver =
+                           dynamic_cast<MocoTropterSolver*>(&solver)) {
+            tropterSolver->setGuess(guess);
+        } else {
+            log_warn("MocoStudy::solveSequence(): cannot set the guess of a "
+                     "solver of type {}.",
+                    solver.getConcreteClassName());
+        }
+    };
+    try {
+        for (int istep = 0; istep < (int)modifications.size(); ++istep) {
+            if (modifications[istep]) modifications[istep](*this);
+
+            // The modification may have replaced the solver.
+            setGuessToLastSuccess();
+            auto* casadiSolver = dynamic_cast<MocoCasADiSolver*>(&upd_solver());
+            if (casadiSolver) {
+                if (casadiSolver != warmStartSolver) {
+                    restoreWarmStart();
+                    warmStartSolver = casadiSolver;
+                    origWarmStartMultipliers =
+                            casadiSolver->getWarmStartMultipliers();
+                }
+                // The multipliers are from the last solve, so they match the
+                // guess only if the last solve succeeded.
+                casadiSolver->setWarmStartMultipliers(
+                        istep > 0 && lastSuccess == istep - 1);
+            }
+
+            solutions.push_back(solve());
+            if (solutions.back().success()) lastSuccess = istep;
+        }
+    } catch (...) {
+        restoreWarmStart();
+        throw;
+    }
+    restoreWarmStart();
+    setGuessToLastSuccess();
+
+    log_info("MocoStudy::solveSequence():");
+    log_info("{:>6} {:>8} {:>10} {:>14} {:>12}", "step", "success",
+            "iterations", "objective", "duration (s)");
+    for (int istep = 0; istep < (int)solutions.size(); ++istep) {
+        // Failed solutions are sealed.
+        MocoSolution solution = solutions[istep];
+        solution.unseal();
+        log_info("{:>6} {:>8} {:>10} {:>14.6g} {:>12.3f}", istep,
+                solution.success() ? "yes" : "no",
+                solution.getNumIterations(), solution.getObjective(),
+                solution.getSolverDuration());
+    }
+    return solutions;
+}
+
 void MocoStudy::visualize(const MocoTrajectory& it) const {
     // TODO this does not need the Solver at all, so this could be moved to
     // MocoProblem.
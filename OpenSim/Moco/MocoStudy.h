@@ -23,6 +23,9 @@
 #include <OpenSim/Common/Object.h>
 #include <OpenSim/Simulation/Model/Model.h>
 
+#include <functional>
+#include <vector>
+
 namespace OpenSim {
 
 class MocoProblem;
@@ -149,6 +152,35 @@ public:
     /// until you acknowledge the failure by invoking MocoSolution::unseal().
     MocoSolution solve() const;
 
+    /// Solve a sequence of related problems (e.g., with different goal
+    /// weights, speeds, or model parameters), starting each solve from the
+    /// solution of the previous one. Before each solve, the corresponding
+    /// modification is invoked with this study, so that it can edit the
+    /// problem or the solver (a null modification solves the study as is).
+    /// The first solve uses the guess set on the solver; each subsequent solve
+    /// uses the solution of the previous solve as the guess. With
+    /// MocoCasADiSolver and IPOPT, each solve also starts from the
+    /// multipliers and the barrier parameter of the previous solve (see
+    /// MocoCasADiSolver::setWarmStartMultipliers()), which usually reduces
+    /// the number of iterations much more than the guess alone. If a solve
+    /// fails, the next solve starts from the last successful solution
+    /// (without multipliers). After solving, the guess of the solver is the
+    /// last successful solution, and a table of the number of iterations
+    /// for each solve is logged.
+    /// @code{.cpp}
+    /// std::vector<std::function<void(MocoStudy&)>> modifications;
+    /// for (double weight : {1.0, 10.0, 100.0}) {
+    ///     modifications.push_back([weight](MocoStudy& study) {
+    ///         study.updProblem().updGoal("effort").setWeight(weight);
+    ///     });
+    /// }
+    /// std::vector<MocoSolution> solutions = study.solveSequence(modifications);
+    /// @endcode
+    /// @returns the solution of each solve; use
+    /// MocoSolution::getNumIterations() for the number of iterations.
+    std::vector<MocoSolution> solveSequence(
+            const std::vector<std::function<void(MocoStudy&)>>& modifications);
+
     /// Interactively visualize a trajectory using the simbody-visualizer. The
     /// trajectory could be an initial guess, a solution, etc.
     /// @precondition
@@ -61,15 +61,17 @@ class MocoProblem;
 ///
 /// @note Parameters and Lagrange multipliers in the MocoTrajectory are **not**
 ///       applied to the model.
+///
+/// Set numThreads to evaluate the time points in parallel; see analyze().
 /// @ingroup mocoutil
 template <typename T>
 TimeSeriesTable_<T> analyzeMocoTrajectory(
         Model model, const MocoTrajectory& trajectory,
-        const std::vector<std::string>& outputPaths) {
+        const std::vector<std::string>& outputPaths, int numThreads = 1) {
     const TimeSeriesTable statesTable = trajectory.exportToStatesTable();
     const TimeSeriesTable controlsTable = trajectory.exportToControlsTable();
-    return analyze<T>(
-            std::move(model), statesTable, controlsTable, outputPaths);
+    return analyze<T>(std::move(model), statesTable, controlsTable,
+            outputPaths, numThreads);
 }
 
 /// Given a MocoTrajectory and the associated OpenSim model, return the model
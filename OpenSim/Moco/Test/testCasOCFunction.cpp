@@ -0,0 +1,137 @@
+/* -------------------------------------------------------------------------- *
+ * OpenSim Moco: testCasOCFunction.cpp                                        *
+ * -------------------------------------------------------------------------- *
+ * Copyright (c) 2021 Stanford University and the Authors                     *
+ *                                                                            *
+ * Author(s): OpenSim Team                                                    *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0          *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#define CATCH_CONFIG_MAIN
+#include "Testing.h"
+
+#include <OpenSim/Moco/MocoCasADiSolver/CasOCFunction.h>
+
+#include <cmath>
+#include <memory>
+
+using namespace CasOC;
+using casadi::DM;
+using casadi::MX;
+using casadi::Slice;
+
+namespace {
+
+/// A point function with several inputs and outputs, and a sparse Jacobian:
+///     out0 = [x0 * u0 + t, sin(x1) + p]
+///     out1 = [x2^2 * u1]
+/// with inputs t (time), x (3 states), u (2 controls), and p (1 parameter).
+class SparsePointFunction : public Function {
+public:
+    void constructTestFunction() {
+        casadi::Dict opts;
+        setCommonOptions(opts);
+        construct("sparse_point_function", opts);
+    }
+    casadi_int get_n_in() override { return 4; }
+    std::string get_name_in(casadi_int i) override {
+        return std::vector<std::string>{"time", "states", "controls",
+                "parameters"}[i];
+    }
+    casadi::Sparsity get_sparsity_in(casadi_int i) override {
+        return casadi::Sparsity::dense(std::vector<int>{1, 3, 2, 1}[i], 1);
+    }
+    casadi_int get_n_out() override { return 2; }
+    std::string get_name_out(casadi_int i) override {
+        return i == 0 ? "out0" : "out1";
+    }
+    casadi::Sparsity get_sparsity_out(casadi_int i) override {
+        return casadi::Sparsity::dense(i == 0 ? 2 : 1, 1);
+    }
+    bool has_jacobian_sparsity() const override { return true; }
+    casadi::Sparsity get_jacobian_sparsity() const override {
+        // Columns: t (0), x (1-3), u (4-5), p (6).
+        return casadi::Sparsity::triplet(3, 7, {0, 0, 0, 1, 1, 2, 2},
+                {0, 1, 4, 2, 6, 3, 5});
+    }
+    VectorDM eval(const VectorDM& args) const override {
+        const double t = args[0].scalar();
+        const DM& x = args[1];
+        const DM& u = args[2];
+        const double p = args[3].scalar();
+        DM out0 = DM::zeros(2, 1);
+        out0(0) = x(0).scalar() * u(0).scalar() + t;
+        out0(1) = std::sin(x(1).scalar()) + p;
+        DM out1 = DM::zeros(1, 1);
+        out1(0) = std::pow(x(2).scalar(), 2) * u(1).scalar();
+        return {out0, out1};
+    }
+};
+
+VectorDM createRandomInputs(const casadi::Function& function, int numPoints) {
+    VectorDM args;
+    for (casadi_int i = 0; i < function.n_in(); ++i) {
+        args.push_back(DM::rand(function.size1_in(i), numPoints));
+    }
+    return args;
+}
+
+/// The Jacobian of all outputs with respect to all inputs (both
+/// vectorized and concatenated), as CasADi computes it for `function`.
+DM calcJacobian(const casadi::Function& function, const VectorDM& args) {
+    const MX x = MX::sym("x", function.nnz_in());
+    std::vector<MX> in;
+    casadi_int offset = 0;
+    for (casadi_int i = 0; i < function.n_in(); ++i) {
+        const casadi_int size = function.nnz_in(i);
+        in.push_back(MX::reshape(x(Slice(offset, offset + size)),
+                function.size1_in(i), function.size2_in(i)));
+        offset += size;
+    }
+    const MX jacobian = MX::jacobian(MX::veccat(function(in)), x);
+    casadi::Function jacobianFunction("jacobian", {x}, {jacobian});
+    return jacobianFunction(VectorDM{DM::veccat(args)})[0];
+}
+
+} // anonymous namespace
+
+TEST_CASE("TrajectoryFunction matches map()", "[casadi]") {
+    SparsePointFunction pointFunction;
+    pointFunction.constructTestFunction();
+    const int numPoints = 7;
+    const casadi::Function mapped = pointFunction.map(numPoints);
+    const VectorDM args = createRandomInputs(mapped, numPoints);
+    const VectorDM expected = mapped(args);
+    const DM expectedJacobian = calcJacobian(mapped, args);
+
+    auto numThreads = GENERATE(1, 3);
+    CAPTURE(numThreads);
+    std::unique_ptr<WorkerPool> workerPool;
+    if (numThreads > 1) workerPool.reset(new WorkerPool(numThreads));
+    TrajectoryFunction trajectoryFunction;
+    trajectoryFunction.constructFunction(
+            &pointFunction, numPoints, workerPool.get(), "central");
+
+    const VectorDM actual = trajectoryFunction(args);
+    REQUIRE(actual.size() == expected.size());
+    for (int i = 0; i < (int)actual.size(); ++i) {
+        CHECK(actual[i].size() == expected[i].size());
+        CHECK(DM::norm_inf(actual[i] - expected[i]).scalar() == 0);
+    }
+
+    const DM actualJacobian = calcJacobian(trajectoryFunction, args);
+    CHECK(actualJacobian.sparsity() == expectedJacobian.sparsity());
+    CHECK(actualJacobian.nnz() ==
+            numPoints * pointFunction.get_jacobian_sparsity().nnz());
+    CHECK(DM::norm_inf(actualJacobian - expectedJacobian).scalar() ==
+            Approx(0).margin(1e-6));
+}
@@ -769,3 +769,29 @@ TEST_CASE("MocoGoal stage dependency") {
     CHECK_THROWS_WITH(goal.calcGoal(input, goalValue),
             Catch::Contains("calcGoal()") && Catch::Contains("final_state"));
 }
+
+TEST_CASE("MocoReferenceCache") {
+    std::vector<double> times;
+    SimTK::Matrix data(11, 2);
+    for (int i = 0; i < data.nrow(); ++i) {
+        times.push_back(0.1 * i);
+        data(i, 0) = std::sin(times.back());
+        data(i, 1) = std::cos(times.back());
+    }
+    GCVSplineSet splines(TimeSeriesTable(times, data, {"sin", "cos"}));
+
+    // Cached and uncached values are those of the splines.
+    MocoReferenceCache cache(3);
+    SimTK::Vector timeVec(1);
+    for (double time : {0.1, 0.25, 0.1, 0.5, 0.75, 0.25, 0.75}) {
+        const double* values = cache.getValues(splines, time);
+        timeVec[0] = time;
+        for (int i = 0; i < splines.getSize(); ++i) {
+            CHECK(values[i] == splines[i].calcValue(timeVec));
+        }
+    }
+    // 0.75 exceeds the capacity.
+    CHECK(cache.getNumTimes() == 3);
+    cache.clear();
+    CHECK(cache.getNumTimes() == 0);
+}
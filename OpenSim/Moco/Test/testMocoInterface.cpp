@@ -19,10 +19,13 @@
 #define CATCH_CONFIG_MAIN
 #include "Testing.h"
 #include <fstream>
+#include <map>
+#include <sstream>
 
 #include <OpenSim/Actuators/BodyActuator.h>
 #include <OpenSim/Actuators/CoordinateActuator.h>
 #include <OpenSim/Actuators/ModelFactory.h>
+#include <OpenSim/Common/LogSink.h>
 #include <OpenSim/Common/STOFileAdapter.h>
 #include <OpenSim/Moco/osimMoco.h>
 #include <OpenSim/Simulation/Manager/Manager.h>
@@ -316,6 +319,120 @@ TEST_CASE("Serializing a MocoStudy", "") {
     SimTK_TEST(sol0.isNumericallyEqual(sol1));
 }
 
+TEST_CASE("MocoCasADiSolver optim_code_generation", "[casadi]") {
+    MocoStudy study = createSlidingMassMocoStudy<MocoCasADiSolver>();
+    auto& solver = study.updSolver<MocoCasADiSolver>();
+    solver.set_transcription_scheme("hermite-simpson");
+    solver.set_num_mesh_intervals(20);
+    MocoSolution expected = study.solve();
+    REQUIRE(expected.success());
+
+    solver.set_optim_code_generation(true);
+    // The second solve loads the code compiled by the first.
+    for (int i = 0; i < 2; ++i) {
+        CAPTURE(i);
+        MocoSolution solution = study.solve();
+        REQUIRE(solution.success());
+        CHECK(solution.compareContinuousVariablesRMS(expected) <
+                Approx(0).margin(1e-6));
+        CHECK(solution.getFinalTime() ==
+                Approx(expected.getFinalTime()).epsilon(1e-6));
+    }
+}
+
+TEST_CASE("MocoCasADiSolver print_profile", "[casadi]") {
+    MocoStudy study = createSlidingMassMocoStudy<MocoCasADiSolver>();
+    // A goal with an integrand, in addition to the final time goal.
+    study.updProblem().addGoal<MocoControlGoal>("effort", 1e-3);
+    MocoSolution expected = study.solve();
+    study.updSolver<MocoCasADiSolver>().set_print_profile(true);
+
+    auto sink = std::make_shared<StringLogSink>();
+    Logger::addSink(sink);
+    MocoSolution solution = study.solve();
+    Logger::removeSink(sink);
+    CHECK(solution.isNumericallyEqual(expected));
+
+    // Each row of the profile lists a function that was evaluated, with the
+    // number of calls, the number of points, the time, and the percentage of
+    // the solve time.
+    struct Row {
+        long long calls;
+        long long points;
+    };
+    std::map<std::string, Row> rows;
+    std::istringstream profile(sink->getString());
+    std::string line;
+    bool inFunctionBreakdown = false;
+    while (std::getline(profile, line)) {
+        if (line.find("Breakdown of function evaluations") !=
+                std::string::npos) {
+            inFunctionBreakdown = true;
+            continue;
+        }
+        if (line.find("Breakdown of NLP function evaluations") !=
+                std::string::npos) {
+            break;
+        }
+        if (!inFunctionBreakdown) continue;
+        std::istringstream fields(line);
+        std::string name;
+        Row row;
+        double time, percentage;
+        if (fields >> name >> row.calls >> row.points >> time >> percentage) {
+            rows[name] = row;
+        }
+    }
+    CHECK(inFunctionBreakdown);
+    for (const std::string name : {"explicit_multibody_system",
+                 "cost_effort_integrand", "cost_goal_endpoint"}) {
+        INFO(name);
+        REQUIRE(rows.count(name) == 1);
+        CHECK(rows[name].calls > 0);
+        CHECK(rows[name].points > 0);
+    }
+    CHECK(sink->getString().find("total (solve)") != std::string::npos);
+}
+
+TEST_CASE("MocoCasADiSolver exact Hessian", "[casadi]") {
+    MocoStudy study = createSlidingMassMocoStudy<MocoCasADiSolver>();
+    auto& solver = study.updSolver<MocoCasADiSolver>();
+    solver.set_optim_hessian_approximation("limited-memory");
+    MocoSolution expected = study.solve();
+    solver.set_optim_hessian_approximation("exact");
+    MocoSolution solution = study.solve();
+    CHECK(solution.isNumericallyEqual(expected, 1e-4));
+    CHECK(solution.getNumIterations() <= expected.getNumIterations());
+}
+
+TEST_CASE("MocoStudy::solveSequence()", "[casadi]") {
+    MocoStudy study = createSlidingMassMocoStudy<MocoCasADiSolver>();
+    auto setFinalPosition = [](double position) {
+        return [position](MocoStudy& study) {
+            study.updProblem().setStateInfo("/slider/position/value",
+                    MocoBounds(0, 2), MocoInitialBounds(0),
+                    MocoFinalBounds(position));
+        };
+    };
+    std::vector<MocoSolution> solutions = study.solveSequence(
+            {setFinalPosition(1.0), setFinalPosition(1.05),
+                    setFinalPosition(1.1)});
+    REQUIRE(solutions.size() == 3);
+    for (const auto& solution : solutions) REQUIRE(solution.success());
+    CHECK(solutions[1].getFinalTime() > solutions[0].getFinalTime());
+    CHECK(solutions[2].getFinalTime() > solutions[1].getFinalTime());
+    CHECK_FALSE(
+            study.updSolver<MocoCasADiSolver>().getWarmStartMultipliers());
+    CHECK(study.updSolver<MocoCasADiSolver>().getGuess().isNumericallyEqual(
+            solutions[2]));
+
+    // Solve the last problem without warm starting.
+    study.updSolver<MocoCasADiSolver>().clearGuess();
+    MocoSolution cold = study.solve();
+    CHECK(solutions[2].isNumericallyEqual(cold, 1e-4));
+    CHECK(solutions[2].getNumIterations() <= cold.getNumIterations());
+}
+
 // TODO does not pass consistently on Mac
 //TEST_CASE("Copying a MocoStudy", "") {
 //    MocoStudy study = createSlidingMassMocoStudy();
@@ -24,6 +24,7 @@
 #include "AssemblySolver.h"
 #include "OpenSim/Simulation/Model/Model.h"
 #include <OpenSim/Common/Constant.h>
+#include <OpenSim/Common/Stopwatch.h>
 #include "simbody/internal/AssemblyCondition_QValue.h"
 
 using namespace std;
@@ -183,6 +184,10 @@ void AssemblySolver::updateGoals(SimTK::State &s)
  */
 void AssemblySolver::assemble(SimTK::State &state)
 {
+    Stopwatch watch;
+    PerformanceRecord record;
+    record.time = state.getTime();
+
     // Make a working copy of the state that will be used to set the internal 
     // state of the solver. This is necessary because we may wish to disable 
     // redundant constraints, but do not want this to affect the state of 
@@ -191,6 +196,7 @@ void AssemblySolver::assemble(SimTK::State &state)
     
     // Make sure goals are up-to-date.
     setupGoals(s);
+    record.goalsTime = watch.getElapsedTime();
 
     // Let assembler perform some internal setup
     _assembler->initialize(s);
@@ -229,13 +235,27 @@ void AssemblySolver::assemble(SimTK::State &state)
         log_debug(" evals: goal={} grad={} error={} jac={}",
             _assembler->getNumGoalEvals(), _assembler->getNumGoalGradientEvals(),
             _assembler->getNumErrorEvals(), _assembler->getNumErrorJacobianEvals());
+        record.converged = true;
     }
     catch (const std::exception& ex)
     {
+        if (isRecordingPerformance()) {
+            record.solveTime = watch.getElapsedTime();
+            recordPerformance(record);
+        }
         std::string msg = "AssemblySolver::assemble() Failed: ";
         msg += ex.what();
         throw Exception(msg);
     }
+    if (isRecordingPerformance()) {
+        // setupGoals() created a new SimTK::Assembler, so its statistics
+        // cover only this call.
+        record.numAssemblySteps = _assembler->getNumAssemblySteps();
+        record.numGoalEvals = _assembler->getNumGoalEvals();
+        record.numGoalGradientEvals = _assembler->getNumGoalGradientEvals();
+        record.solveTime = watch.getElapsedTime();
+        recordPerformance(record);
+    }
 }
 
 /* Obtain a model configuration that meets the assembly conditions  
@@ -246,6 +266,10 @@ void AssemblySolver::assemble(SimTK::State &state)
     to track a desired trajectory of coordinate values. */
 void AssemblySolver::track(SimTK::State &s)
 {
+    Stopwatch watch;
+    PerformanceRecord record;
+    record.isTrack = true;
+
     // move the target locations or angles, etc... just do not change number of goals
     // and their type (constrained vs. weighted)
 
@@ -256,6 +280,22 @@ void AssemblySolver::track(SimTK::State &s)
         throw Exception(
             "AssemblySolver::track() failed: assemble() must be called first.");
     }
+    // updateGoals() may advance the time (see InverseKinematicsSolver).
+    record.time = s.getTime();
+    record.goalsTime = watch.getElapsedTime();
+    const int numAssemblySteps = _assembler->getNumAssemblySteps();
+    const int numGoalEvals = _assembler->getNumGoalEvals();
+    const int numGoalGradientEvals = _assembler->getNumGoalGradientEvals();
+    auto finishRecord = [&]() {
+        if (!isRecordingPerformance()) return;
+        record.numAssemblySteps =
+                _assembler->getNumAssemblySteps() - numAssemblySteps;
+        record.numGoalEvals = _assembler->getNumGoalEvals() - numGoalEvals;
+        record.numGoalGradientEvals =
+                _assembler->getNumGoalGradientEvals() - numGoalGradientEvals;
+        record.solveTime = watch.getElapsedTime();
+        recordPerformance(record);
+    };
 
     // TODO: Useful to include through debug message/log in the future
     log_debug("UNASSEMBLED(track) CONFIGURATION (normerr={}, maxerr={}, cost={})",
@@ -281,9 +321,88 @@ void AssemblySolver::track(SimTK::State &s)
     }
     catch (const std::exception& ex)
     {
+        finishRecord();
         log_info( "AssemblySolver::track() attempt Failed: {}", ex.what());
         throw Exception("AssemblySolver::track() attempt failed.");
     }
+    record.converged = true;
+    finishRecord();
+}
+
+void AssemblySolver::setPerformanceRecordCapacity(int capacity)
+{
+    OPENSIM_THROW_IF(capacity < 0, Exception,
+        "Expected a non-negative capacity, but got {}.", capacity);
+    _performanceRecords.assign(capacity, PerformanceRecord());
+    _numPerformanceRecords = 0;
+    _nextPerformanceRecord = 0;
+}
+
+const AssemblySolver::PerformanceRecord&
+AssemblySolver::getPerformanceRecord(int index) const
+{
+    OPENSIM_THROW_IF(index < 0 || index >= _numPerformanceRecords,
+        IndexOutOfRange, (size_t)index, 0, (size_t)_numPerformanceRecords - 1);
+    const int capacity = getPerformanceRecordCapacity();
+    const int oldest =
+        (_nextPerformanceRecord - _numPerformanceRecords + capacity) % capacity;
+    return _performanceRecords[(oldest + index) % capacity];
+}
+
+TimeSeriesTable AssemblySolver::getPerformanceTable() const
+{
+    std::vector<double> times;
+    std::vector<const PerformanceRecord*> records;
+    for (int i = 0; i < _numPerformanceRecords; ++i) {
+        const PerformanceRecord& record = getPerformanceRecord(i);
+        while (!times.empty() && times.back() >= record.time) {
+            times.pop_back();
+            records.pop_back();
+        }
+        times.push_back(record.time);
+        records.push_back(&record);
+    }
+    SimTK::Matrix data((int)records.size(), 8);
+    for (int i = 0; i < (int)records.size(); ++i) {
+        const PerformanceRecord& record = *records[i];
+        data(i, 0) = record.isTrack;
+        data(i, 1) = record.converged;
+        data(i, 2) = record.numAssemblySteps;
+        data(i, 3) = record.numGoalEvals;
+        data(i, 4) = record.numGoalGradientEvals;
+        data(i, 5) = record.solveTime;
+        data(i, 6) = record.goalsTime;
+        data(i, 7) = record.errorEvaluationTime;
+    }
+    TimeSeriesTable table(times, data, {"is_track", "converged",
+            "num_assembly_steps", "num_goal_evals", "num_goal_gradient_evals",
+            "solve_time", "goals_time", "error_evaluation_time"});
+    table.updTableMetaData().setValueForKey<std::string>(
+            "name", "AssemblySolverPerformance");
+    return table;
+}
+
+void AssemblySolver::clearPerformanceRecords()
+{
+    _numPerformanceRecords = 0;
+    _nextPerformanceRecord = 0;
+}
+
+void AssemblySolver::recordPerformance(const PerformanceRecord& record)
+{
+    if (!isRecordingPerformance()) return;
+    const int capacity = getPerformanceRecordCapacity();
+    _performanceRecords[_nextPerformanceRecord] = record;
+    _nextPerformanceRecord = (_nextPerformanceRecord + 1) % capacity;
+    _numPerformanceRecords = std::min(_numPerformanceRecords + 1, capacity);
+}
+
+void AssemblySolver::addErrorEvaluationTime(double seconds)
+{
+    if (_numPerformanceRecords == 0) return;
+    const int capacity = getPerformanceRecordCapacity();
+    _performanceRecords[(_nextPerformanceRecord - 1 + capacity) % capacity]
+            .errorEvaluationTime += seconds;
 }
 
 const SimTK::Assembler& AssemblySolver::getAssembler() const
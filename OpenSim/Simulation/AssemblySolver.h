@@ -25,6 +25,7 @@
 
 #include "Solver.h"
 #include "OpenSim/Simulation/CoordinateReference.h"
+#include <OpenSim/Common/TimeSeriesTable.h>
 #include "simbody/internal/Assembler.h"
 
 namespace SimTK { 
@@ -84,6 +85,7 @@ public:
         Note, setting the accuracy will invalidate the AssemblySolver and one
         must call assemble() before being able to track().*/
     void setAccuracy(double accuracy);
+    double getAccuracy() const { return _accuracy; }
 
     /** %Set the relative weighting for constraints. Use Infinity to identify the 
         strict enforcement of constraints, otherwise any positive weighting will
@@ -118,6 +120,54 @@ public:
     /** Read access to the underlying SimTK::Assembler. */
     const SimTK::Assembler& getAssembler() const;
 
+    /** @name Performance records
+    The solver can record the cost and outcome of each call to assemble() and
+    track(), e.g., to find slow frames or to choose an accuracy and weights
+    that meet a required throughput. Recording is disabled by default. The
+    records are kept in a ring buffer that holds the most recent calls. */
+    /// @{
+    /** The cost and outcome of one call to assemble() or track(). Times are
+    wall-clock times in seconds. */
+    struct PerformanceRecord {
+        /** The time of the state that was solved. */
+        double time = SimTK::NaN;
+        /** True for track(), false for assemble(). */
+        bool isTrack = false;
+        /** False if the assembler failed (assemble() or track() threw). */
+        bool converged = false;
+        /** Iterations taken by the SimTK::Assembler. */
+        int numAssemblySteps = 0;
+        int numGoalEvals = 0;
+        int numGoalGradientEvals = 0;
+        /** Total time spent in assemble() or track(). */
+        double solveTime = 0;
+        /** The part of solveTime spent setting up or updating the goals,
+        which includes reading the references. */
+        double goalsTime = 0;
+        /** Time spent evaluating errors (e.g.,
+        InverseKinematicsSolver::computeCurrentMarkerErrors()) after the
+        call, until the next call. */
+        double errorEvaluationTime = 0;
+    };
+    /** The number of calls to keep records for. 0 (the default) disables
+    recording. Changing the capacity discards existing records. */
+    void setPerformanceRecordCapacity(int capacity);
+    int getPerformanceRecordCapacity() const
+    {   return (int)_performanceRecords.size(); }
+    int getNumPerformanceRecords() const { return _numPerformanceRecords; }
+    /** Index 0 is the oldest record in the buffer. */
+    const PerformanceRecord& getPerformanceRecord(int index) const;
+    /** The records as a table, one row per call (oldest first) at the time of
+    the solved state, with the columns `is_track`, `converged`,
+    `num_assembly_steps`, `num_goal_evals`, `num_goal_gradient_evals`,
+    `solve_time`, `goals_time`, and `error_evaluation_time`. Since the times
+    of a table must increase, a call at a time that is not later than that
+    of the previous call replaces the rows at or after its time (e.g., the
+    first track() replaces the assemble() at the same time). */
+    TimeSeriesTable getPerformanceTable() const;
+    void clearPerformanceRecords();
+    /// @}
+
 protected:
     /** Internal method to convert the CoordinateReferences into goals of the 
         assembly solver. Subclasses, can add and override to include other goals  
@@ -132,6 +182,17 @@ protected:
     /** Write access to the underlying SimTK::Assembler. */
     SimTK::Assembler& updAssembler();
 
+    /** Whether performance records are being kept. */
+    bool isRecordingPerformance() const
+    {   return !_performanceRecords.empty(); }
+    /** Add to the error evaluation time of the latest performance record,
+        if any. For use by subclasses that evaluate errors. */
+    void addErrorEvaluationTime(double seconds);
+    /** Append a performance record to the ring buffer (if recording),
+        replacing the oldest record if the buffer is full. For use by
+        subclasses that solve without the SimTK::Assembler. */
+    void recordPerformance(const PerformanceRecord& record);
+
 private:
 
     // The assembly solution accuracy
@@ -147,6 +208,12 @@ private:
     SimTK::ResetOnCopy< std::unique_ptr<SimTK::Assembler>> _assembler;
 
     SimTK::Array_<SimTK::QValue*> _coordinateAssemblyConditions;
+
+    // Ring buffer of performance records; its size is the capacity.
+    std::vector<PerformanceRecord> _performanceRecords;
+    int _numPerformanceRecords{0};
+    // Index of the slot for the next record.
+    int _nextPerformanceRecord{0};
 //=============================================================================
 };  // END of class AssemblySolver
 //=============================================================================
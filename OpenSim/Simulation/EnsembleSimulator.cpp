@@ -0,0 +1,218 @@
+/* -------------------------------------------------------------------------- *
+ *                     OpenSim:  EnsembleSimulator.cpp                        *
+ * -------------------------------------------------------------------------- *
+ * The OpenSim API is a toolkit for musculoskeletal modeling and simulation.  *
+ * See http://opensim.stanford.edu and the NOTICE file for more information.  *
+ * OpenSim is developed at Stanford University and supported by the US        *
+ * National Institutes of Health (U54 GM072970, R24 HD065690) and by DARPA    *
+ * through the Warrior Web program.                                           *
+ *                                                                            *
+ * Copyright (c) 2005-2021 Stanford University and the Authors                *
+ * Author(s): OpenSim Team                                                    *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "EnsembleSimulator.h"
+
+#include <OpenSim/Common/CommonUtilities.h>
+#include <OpenSim/Common/PiecewiseLinearFunction.h>
+#include <OpenSim/Common/TableUtilities.h>
+#include <OpenSim/Simulation/Manager/Manager.h>
+
+#include <atomic>
+#include <thread>
+
+using namespace OpenSim;
+
+EnsembleSimulator::EnsembleSimulator(const Model& model)
+        : m_model(new Model(model)) {
+    m_model->setUseVisualizer(false);
+}
+
+int EnsembleSimulator::addMember(Member member) {
+    m_members.push_back(std::move(member));
+    return (int)m_members.size() - 1;
+}
+
+std::vector<EnsembleSimulator::MemberResult> EnsembleSimulator::run() const {
+    OPENSIM_THROW_IF(m_finalTime < m_initialTime, Exception,
+            "Expected the final time ({}) to be at least the initial time "
+            "({}).", m_finalTime, m_initialTime);
+
+    const int numMembers = getNumMembers();
+    std::vector<MemberResult> results(numMembers);
+    if (numMembers == 0) return results;
+
+    int numThreads = m_numThreads;
+    if (numThreads < 1) {
+        numThreads = (int)std::thread::hardware_concurrency();
+    }
+    numThreads = std::max(1, std::min(numThreads, numMembers));
+
+    // Copy the model for each thread here, so that the worker threads do not
+    // read the base model while another thread copies it.
+    std::vector<std::unique_ptr<Model>> models;
+    for (int ithread = 0; ithread < numThreads; ++ithread) {
+        models.emplace_back(new Model(*m_model));
+    }
+
+    // Threads take the next member from a shared counter, so that a thread
+    // that gets short simulations is not left idle.
+    std::atomic<int> nextMember(0);
+    auto work = [&](int ithread) {
+        Model& model = *models[ithread];
+        int imember;
+        while ((imember = nextMember++) < numMembers) {
+            results[imember] = simulate(model, m_members[imember]);
+        }
+    };
+
+    if (numThreads == 1) {
+        work(0);
+    } else {
+        std::vector<std::thread> threads;
+        for (int ithread = 0; ithread < numThreads; ++ithread) {
+            threads.emplace_back(work, ithread);
+        }
+        for (auto& thread : threads) thread.join();
+    }
+
+    int numFailed = 0;
+    for (const auto& result : results) {
+        if (!result.success) ++numFailed;
+    }
+    if (numFailed) {
+        log_warn("EnsembleSimulator: {} of {} members failed.", numFailed,
+                numMembers);
+    }
+    return results;
+}
+
+EnsembleSimulator::MemberResult EnsembleSimulator::simulate(
+        Model& threadModel, const Member& member) const {
+    MemberResult result;
+    result.name = member.name;
+    try {
+        // A member that modifies the model gets its own copy; otherwise, we
+        // reuse the thread's model, whose system we only need to build once.
+        std::unique_ptr<Model> memberModel;
+        Model* model = &threadModel;
+        if (member.modifyModel) {
+            memberModel.reset(new Model(threadModel));
+            member.modifyModel(*memberModel);
+            memberModel->buildSystem();
+            model = memberModel.get();
+        } else if (!threadModel.hasSystem()) {
+            threadModel.buildSystem();
+        }
+
+        SimTK::State& state = model->initializeState();
+        state.setTime(m_initialTime);
+        for (const auto& value : member.stateVariableValues) {
+            model->setStateVariableValue(state, value.first, value.second);
+        }
+        if (member.modifyState) member.modifyState(*model, state);
+        if (m_equilibrateMuscles) model->equilibrateMuscles(state);
+
+        Manager manager(*model);
+        if (!SimTK::isNaN(m_accuracy)) {
+            manager.setIntegratorAccuracy(m_accuracy);
+        }
+        manager.initialize(state);
+        manager.integrate(m_finalTime);
+
+        result.states = manager.getStatesTable();
+        result.success = true;
+    } catch (const std::exception& ex) {
+        result.success = false;
+        result.message = ex.what();
+        log_debug("EnsembleSimulator: member '{}' failed: {}", member.name,
+                result.message);
+    }
+    return result;
+}
+
+EnsembleSimulator::Statistics EnsembleSimulator::computeStatistics(
+        const std::vector<MemberResult>& results, int numTimes) {
+    OPENSIM_THROW_IF(numTimes < 2, Exception,
+            "Expected numTimes to be at least 2, but got {}.", numTimes);
+
+    std::vector<const TimeSeriesTable*> tables;
+    double initialTime = -SimTK::Infinity;
+    double finalTime = SimTK::Infinity;
+    for (const auto& result : results) {
+        if (!result.success) continue;
+        const auto& table = result.states;
+        if (!tables.empty()) {
+            OPENSIM_THROW_IF(table.getColumnLabels() !=
+                                     tables.front()->getColumnLabels(),
+                    Exception,
+                    "Expected all members to have the same state variables, "
+                    "but member '{}' differs from the first member.",
+                    result.name);
+        }
+        OPENSIM_THROW_IF(table.getNumRows() < 2, Exception,
+                "Expected member '{}' to have at least 2 rows, but it has "
+                "{}.", result.name, table.getNumRows());
+        const auto& time = table.getIndependentColumn();
+        initialTime = std::max(initialTime, time.front());
+        finalTime = std::min(finalTime, time.back());
+        tables.push_back(&table);
+    }
+    OPENSIM_THROW_IF(tables.empty(), Exception,
+            "Expected at least one successful member.");
+    OPENSIM_THROW_IF(finalTime <= initialTime, Exception,
+            "Expected the members' time ranges to overlap.");
+
+    const SimTK::Vector time =
+            createVectorLinspace(numTimes, initialTime, finalTime);
+    const int numColumns = (int)tables.front()->getNumColumns();
+    // Welford's algorithm, which, unlike the difference between the sum of
+    // squares and the squared sum, does not lose precision when the spread of
+    // the members is small compared to their mean.
+    SimTK::Matrix mean(numTimes, numColumns, 0.0);
+    SimTK::Matrix sumSquaredDeviations(numTimes, numColumns, 0.0);
+    int numMembers = 0;
+    for (const auto* table : tables) {
+        const auto resampled = TableUtilities::resample<SimTK::Vector,
+                PiecewiseLinearFunction>(*table, time);
+        const auto& values = resampled.getMatrix();
+        ++numMembers;
+        for (int icol = 0; icol < numColumns; ++icol) {
+            for (int itime = 0; itime < numTimes; ++itime) {
+                const double value = values(itime, icol);
+                const double delta = value - mean(itime, icol);
+                mean(itime, icol) += delta / numMembers;
+                sumSquaredDeviations(itime, icol) +=
+                        delta * (value - mean(itime, icol));
+            }
+        }
+    }
+
+    SimTK::Matrix stdDev(numTimes, numColumns, 0.0);
+    if (numMembers > 1) {
+        for (int icol = 0; icol < numColumns; ++icol) {
+            for (int itime = 0; itime < numTimes; ++itime) {
+                stdDev(itime, icol) = std::sqrt(
+                        sumSquaredDeviations(itime, icol) / (numMembers - 1));
+            }
+        }
+    }
+
+    const std::vector<double> timeVec(time.begin(), time.end());
+    const auto& labels = tables.front()->getColumnLabels();
+    Statistics stats;
+    stats.numMembers = numMembers;
+    stats.mean = TimeSeriesTable(timeVec, mean, labels);
+    stats.standardDeviation = TimeSeriesTable(timeVec, stdDev, labels);
+    return stats;
+}
@@ -0,0 +1,173 @@
+#ifndef OPENSIM_ENSEMBLE_SIMULATOR_H_
+#define OPENSIM_ENSEMBLE_SIMULATOR_H_
+/* -------------------------------------------------------------------------- *
+ *                      OpenSim:  EnsembleSimulator.h                         *
+ * -------------------------------------------------------------------------- *
+ * The OpenSim API is a toolkit for musculoskeletal modeling and simulation.  *
+ * See http://opensim.stanford.edu and the NOTICE file for more information.  *
+ * OpenSim is developed at Stanford University and supported by the US        *
+ * National Institutes of Health (U54 GM072970, R24 HD065690) and by DARPA    *
+ * through the Warrior Web program.                                           *
+ *                                                                            *
+ * Copyright (c) 2005-2021 Stanford University and the Authors                *
+ * Author(s): OpenSim Team                                                    *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "osimSimulationDLL.h"
+#include <OpenSim/Common/TimeSeriesTable.h>
+#include <OpenSim/Simulation/Model/Model.h>
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace OpenSim {
+
+/** Run many forward simulations of variations of one Model (an ensemble),
+e.g., for Monte Carlo analyses and parameter sweeps.
+
+Each member of the ensemble starts from the base model and its default
+state, and can change:
+- the initial values of state variables (Member::stateVariableValues),
+- the model itself, before the system is built (Member::modifyModel; e.g.,
+  scale the max isometric force of a muscle), and
+- the initial state, after it has been created (Member::modifyState).
+
+The members are simulated with a Manager on a pool of threads. Each thread
+works on its own copy of the base model, which is made before the threads
+start, and takes the next member that has not been simulated yet. A member
+that modifies the model is simulated with a further copy, so members never
+affect one another. The result for each member is its states trajectory;
+computeStatistics() aggregates the trajectories of the members.
+
+@code
+EnsembleSimulator ensemble(model);
+ensemble.setFinalTime(1.0);
+for (int i = 0; i < 100; ++i) {
+    EnsembleSimulator::Member member;
+    member.name = "force_scale_" + std::to_string(i);
+    const double scale = 0.5 + 0.01 * i;
+    member.modifyModel = [scale](Model& model) {
+        auto& muscle = model.updMuscles().get("soleus_r");
+        muscle.setMaxIsometricForce(scale * muscle.getMaxIsometricForce());
+    };
+    ensemble.addMember(member);
+}
+const auto results = ensemble.run();
+const auto stats = EnsembleSimulator::computeStatistics(results);
+@endcode
+
+A member whose simulation throws an exception does not stop the ensemble;
+its result has `success = false` and the exception's message.
+
+@note The functions in Member are invoked on the worker threads, so they must
+not modify shared data without synchronization.
+@ingroup simulationutil */
+class OSIMSIMULATION_API EnsembleSimulator {
+public:
+    /** A variation of the base model and initial state. */
+    struct Member {
+        /** Used to identify the member in the results. */
+        std::string name;
+        /** Values (by path, e.g., "/jointset/knee/knee_angle/value") to
+        assign to state variables in the initial state. */
+        std::vector<std::pair<std::string, double>> stateVariableValues;
+        /** If provided, invoked on a copy of the base model before its
+        system is built. */
+        std::function<void(Model&)> modifyModel;
+        /** If provided, invoked on the initial state after
+        stateVariableValues have been applied. */
+        std::function<void(const Model&, SimTK::State&)> modifyState;
+    };
+
+    /** The outcome of simulating one member. */
+    struct MemberResult {
+        std::string name;
+        bool success = false;
+        /** If the simulation failed, the reason. */
+        std::string message;
+        /** The states recorded by the Manager (see
+        Manager::getStatesTable()). */
+        TimeSeriesTable states;
+    };
+
+    /** Mean and (sample) standard deviation of the states across members,
+    at common times. */
+    struct Statistics {
+        int numMembers = 0;
+        TimeSeriesTable mean;
+        TimeSeriesTable standardDeviation;
+    };
+
+    /** The base model is copied. */
+    explicit EnsembleSimulator(const Model& model);
+
+    /** The time of the initial state of each member (default: 0). */
+    void setInitialTime(double time) { m_initialTime = time; }
+    double getInitialTime() const { return m_initialTime; }
+    /** The time at which each simulation ends (default: 1). */
+    void setFinalTime(double time) { m_finalTime = time; }
+    double getFinalTime() const { return m_finalTime; }
+
+    /** The number of threads on which to simulate members. If less than 1
+    (the default), we use the number of hardware threads. We never use more
+    threads than there are members. */
+    void setNumThreads(int numThreads) { m_numThreads = numThreads; }
+    int getNumThreads() const { return m_numThreads; }
+
+    /** Accuracy of the integrator (see Manager::setIntegratorAccuracy()).
+    If not set, the Manager's default is used. */
+    void setIntegratorAccuracy(double accuracy) { m_accuracy = accuracy; }
+
+    /** Equilibrate muscles (Model::equilibrateMuscles()) in each initial
+    state, after the member's modifications (default: false). */
+    void setEquilibrateMuscles(bool tf) { m_equilibrateMuscles = tf; }
+    bool getEquilibrateMuscles() const { return m_equilibrateMuscles; }
+
+    /** Add a member to the ensemble.
+    @returns the index of the member. */
+    int addMember(Member member);
+    int getNumMembers() const { return (int)m_members.size(); }
+    const Member& getMember(int index) const { return m_members.at(index); }
+    void clearMembers() { m_members.clear(); }
+
+    /** Simulate all members. The results are in the order in which the
+    members were added. */
+    std::vector<MemberResult> run() const;
+
+    /** Compute the mean and standard deviation of each state variable across
+    the successful members. The trajectories are linearly interpolated at
+    numTimes equally-spaced times, from the latest initial time to the
+    earliest final time of the members.
+    @throws Exception if no member succeeded or if the members' states have
+    different labels. */
+    static Statistics computeStatistics(
+            const std::vector<MemberResult>& results, int numTimes = 101);
+
+private:
+    MemberResult simulate(Model& threadModel, const Member& member) const;
+
+    std::unique_ptr<Model> m_model;
+    std::vector<Member> m_members;
+    double m_initialTime = 0;
+    double m_finalTime = 1;
+    int m_numThreads = 0;
+    double m_accuracy = SimTK::NaN;
+    bool m_equilibrateMuscles = false;
+};
+
+} // namespace OpenSim
+
+#endif // OPENSIM_ENSEMBLE_SIMULATOR_H_
@@ -24,6 +24,7 @@
 #include "InverseKinematicsSolver.h"
 #include "Model/Model.h"
 #include "Model/MarkerSet.h"
+#include <OpenSim/Common/Stopwatch.h>
 
 #include "simbody/internal/AssemblyCondition_Markers.h"
 #include "simbody/internal/AssemblyCondition_OrientationSensors.h"
@@ -228,9 +229,11 @@ SimTK::Vec3 InverseKinematicsSolver::computeCurrentMarkerLocation(int markerInde
 /* Compute and return the spatial locations of all markers in ground. */
 void InverseKinematicsSolver::computeCurrentMarkerLocations(SimTK::Array_<SimTK::Vec3> &markerLocations)
 {
+    Stopwatch watch;
     markerLocations.resize(_markerAssemblyCondition->getNumMarkers());
     for(unsigned int i=0; i<markerLocations.size(); i++)
         markerLocations[i] = _markerAssemblyCondition->findCurrentMarkerLocation(SimTK::Markers::MarkerIx(i));
+    addErrorEvaluationTime(watch.getElapsedTime());
 }
 
 
@@ -255,9 +258,11 @@ double InverseKinematicsSolver::computeCurrentMarkerError(int markerIndex)
 /* Compute and return the distance errors between all model markers and their observations. */
 void InverseKinematicsSolver::computeCurrentMarkerErrors(SimTK::Array_<double> &markerErrors)
 {
+    Stopwatch watch;
     markerErrors.resize(_markerAssemblyCondition->getNumMarkers());
     for(unsigned int i=0; i<markerErrors.size(); i++)
         markerErrors[i] = _markerAssemblyCondition->findCurrentMarkerError(SimTK::Markers::MarkerIx(i));
+    addErrorEvaluationTime(watch.getElapsedTime());
 }
 
 
@@ -283,10 +288,12 @@ double InverseKinematicsSolver::computeCurrentSquaredMarkerError(int markerIndex
 void InverseKinematicsSolver::
     computeCurrentSquaredMarkerErrors(SimTK::Array_<double> &markerErrors)
 {
+    Stopwatch watch;
     markerErrors.resize(_markerAssemblyCondition->getNumMarkers());
     for(unsigned int i=0; i<markerErrors.size(); i++)
         markerErrors[i] = _markerAssemblyCondition->
                     findCurrentMarkerErrorSquared(SimTK::Markers::MarkerIx(i));
+    addErrorEvaluationTime(watch.getElapsedTime());
 }
 
 /* Marker errors are reported in order different from tasks file or model, find name corresponding to passed in index  */
@@ -318,10 +325,12 @@ SimTK::Rotation InverseKinematicsSolver::computeCurrentSensorOrientation(int ose
 void InverseKinematicsSolver::computeCurrentSensorOrientations(
         SimTK::Array_<SimTK::Rotation>& osensorOrientations)
 {
+    Stopwatch watch;
     osensorOrientations.resize(_orientationAssemblyCondition->getNumOSensors());
     for (unsigned int i = 0; i< osensorOrientations.size(); i++)
         osensorOrientations[i] =
             _orientationAssemblyCondition->findCurrentOSensorOrientation(SimTK::OrientationSensors::OSensorIx(i));
+    addErrorEvaluationTime(watch.getElapsedTime());
 }
 
 
@@ -353,10 +362,12 @@ double InverseKinematicsSolver::computeCurrentOrientationError(int osensorIndex)
 void InverseKinematicsSolver::computeCurrentOrientationErrors(
                                           SimTK::Array_<double>& osensorErrors)
 {
+    Stopwatch watch;
     osensorErrors.resize(_orientationAssemblyCondition->getNumOSensors());
     for (unsigned int i = 0; i<osensorErrors.size(); i++)
         osensorErrors[i] = _orientationAssemblyCondition->
         findCurrentOSensorError(OrientationSensors::OSensorIx(i));
+    addErrorEvaluationTime(watch.getElapsedTime());
 }
 
 /* Orientation errors may be reported in an order that may be different from
@@ -375,6 +386,9 @@ void InverseKinematicsSolver::setupGoals(SimTK::State &s)
     // Setup coordinates performed by the base class
     AssemblySolver::setupGoals(s);
 
+    // The goals or the locks may have changed.
+    _leastSquaresEligible = -1;
+
     setupMarkersGoal(s);
 
     setupOrientationsGoal(s);
@@ -470,6 +484,296 @@ void InverseKinematicsSolver::setupOrientationsGoal(SimTK::State &s)
     _orientationAssemblyCondition->defineObservationOrder(osensorNames);
 }
 
+void InverseKinematicsSolver::track(SimTK::State &s)
+{
+    if (!_useLeastSquaresTracking) {
+        AssemblySolver::track(s);
+        return;
+    }
+    if (!getAssembler().isInitialized()) {
+        throw Exception("InverseKinematicsSolver::track() failed: "
+                        "assemble() must be called first.");
+    }
+    if (_leastSquaresEligible < 0) {
+        _leastSquaresEligible = setupLeastSquares(s);
+        if (!_leastSquaresEligible) {
+            log_info("InverseKinematicsSolver: the model has quaternions or "
+                     "constraints, so track() uses the Assembler instead of "
+                     "least squares.");
+        }
+    }
+    if (_leastSquaresEligible) {
+        trackWithLeastSquares(s);
+    } else {
+        AssemblySolver::track(s);
+    }
+}
+
+bool InverseKinematicsSolver::setupLeastSquares(const SimTK::State &s)
+{
+    const SimbodyMatterSubsystem& matter = getModel().getMatterSubsystem();
+    if (matter.getNumQuaternionsInUse(s) > 0) return false;
+
+    _freeUs.clear();
+    _leastSquaresClamps.clear();
+    _leastSquaresCoordinateGoals.clear();
+
+    // Locked coordinates are enforced with a constraint; we can hold them
+    // fixed instead. Any other constraint requires the Assembler.
+    const CoordinateSet& coordSet = getModel().getCoordinateSet();
+    int numLocked = 0;
+    for (int i = 0; i < coordSet.getSize(); ++i) {
+        const Coordinate& coord = coordSet[i];
+        if (coord.isPrescribed(s)) return false;
+        if (coord.getLocked(s)) {
+            ++numLocked;
+            continue;
+        }
+        const MobilizedBody& mobod = matter.getMobilizedBody(coord.getBodyIndex());
+        const QIndex q(mobod.getFirstQIndex(s) + coord.getMobilizerQIndex());
+        // Without quaternions, each q has a corresponding u.
+        _freeUs.push_back(
+            UIndex(mobod.getFirstUIndex(s) + coord.getMobilizerQIndex()));
+        if (coord.getClamped(s)) {
+            _leastSquaresClamps.push_back(
+                {q, coord.getRangeMin(), coord.getRangeMax()});
+        }
+    }
+    int numEnabled = 0;
+    for (ConstraintIndex cx(0); cx < matter.getNumConstraints(); ++cx) {
+        if (!matter.getConstraint(cx).isDisabled(s)) ++numEnabled;
+    }
+    if (numEnabled > numLocked) return false;
+
+    // Coordinate goals, as in AssemblySolver::setupGoals().
+    const auto& coordRefs = getCoordinateReferences();
+    for (int i = 0; i < (int)coordRefs.size(); ++i) {
+        const Coordinate& coord = coordSet.get(coordRefs[i].getName());
+        if (coord.getLocked(s) || coord.get_is_free_to_satisfy_constraints())
+            continue;
+        const MobilizedBody& mobod = matter.getMobilizedBody(coord.getBodyIndex());
+        _leastSquaresCoordinateGoals.push_back({i,
+            QIndex(mobod.getFirstQIndex(s) + coord.getMobilizerQIndex())});
+    }
+    return true;
+}
+
+double InverseKinematicsSolver::calcLeastSquaresResiduals(
+        const SimTK::State &s, SimTK::Vector &residuals,
+        SimTK::Matrix *jacobian, SimTK::Matrix *dqdu) const
+{
+    const SimbodyMatterSubsystem& matter = getModel().getMatterSubsystem();
+    getModel().getMultibodySystem().realize(s, SimTK::Stage::Position);
+
+    // Gather the markers and sensors that have observations; the Assembler
+    // ignores the others as well.
+    SimTK::Array_<MobilizedBodyIndex> markerBodies;
+    SimTK::Array_<Vec3> markerStations;
+    SimTK::Array_<Vec3> markerErrors;
+    SimTK::Array_<double> markerWeights;
+    double totalMarkerWeight = 0;
+    if (_markerAssemblyCondition) {
+        const Markers& markers = *_markerAssemblyCondition;
+        for (Markers::MarkerIx mx(0); mx < markers.getNumMarkers(); ++mx) {
+            const double weight = markers.getMarkerWeight(mx);
+            const Markers::ObservationIx ox =
+                markers.getObservationIxForMarker(mx);
+            if (weight == 0 || !ox.isValid()) continue;
+            const Vec3& observation = markers.getObservation(ox);
+            if (!observation.isFinite()) continue;
+            const MobilizedBody& mobod =
+                matter.getMobilizedBody(markers.getMarkerBody(mx));
+            const Vec3& station = markers.getMarkerStation(mx);
+            markerBodies.push_back(mobod.getMobilizedBodyIndex());
+            markerStations.push_back(station);
+            markerErrors.push_back(
+                mobod.findStationLocationInGround(s, station) - observation);
+            markerWeights.push_back(weight);
+            totalMarkerWeight += weight;
+        }
+    }
+    SimTK::Array_<MobilizedBodyIndex> osensorBodies;
+    SimTK::Array_<Vec3> osensorErrors;
+    SimTK::Array_<double> osensorWeights;
+    double totalOSensorWeight = 0;
+    if (_orientationAssemblyCondition) {
+        const OrientationSensors& osensors = *_orientationAssemblyCondition;
+        for (OrientationSensors::OSensorIx ox(0);
+                ox < osensors.getNumOSensors(); ++ox) {
+            const double weight = osensors.getOSensorWeight(ox);
+            const OrientationSensors::ObservationIx obx =
+                osensors.getObservationIxForOSensor(ox);
+            if (weight == 0 || !obx.isValid()) continue;
+            const Rotation& observation = osensors.getObservation(obx);
+            if (!observation.asMat33().isFinite()) continue;
+            const MobilizedBody& mobod =
+                matter.getMobilizedBody(osensors.getOSensorBody(ox));
+            const Rotation R_GS =
+                mobod.getBodyRotation(s) * osensors.getOSensorStation(ox);
+            // The error as a rotation vector in ground; its norm is the angle
+            // between the sensor and its observation.
+            const Vec4 angleAxis =
+                (R_GS * ~observation).convertRotationToAngleAxis();
+            osensorBodies.push_back(mobod.getMobilizedBodyIndex());
+            osensorErrors.push_back(
+                angleAxis[0] * Vec3(angleAxis[1], angleAxis[2], angleAxis[3]));
+            osensorWeights.push_back(weight);
+            totalOSensorWeight += weight;
+        }
+    }
+
+    const int nm = (int)markerErrors.size();
+    const int no = (int)osensorErrors.size();
+    const int nc = (int)_leastSquaresCoordinateGoals.size();
+    const int n = (int)_freeUs.size();
+    residuals.resize(3 * nm + 3 * no + nc);
+    if (jacobian) jacobian->resize(residuals.size(), n);
+
+    // Scale each residual so that the sum of squares is the Assembler's goal.
+    SimTK::Matrix JS, JF;
+    if (jacobian && nm) {
+        matter.calcStationJacobian(s, markerBodies, markerStations, JS);
+    }
+    for (int i = 0; i < nm; ++i) {
+        const double scale = std::sqrt(markerWeights[i] / totalMarkerWeight);
+        for (int k = 0; k < 3; ++k) {
+            residuals[3 * i + k] = scale * markerErrors[i][k];
+            if (!jacobian) continue;
+            for (int j = 0; j < n; ++j) {
+                (*jacobian)(3 * i + k, j) = scale * JS(3 * i + k, _freeUs[j]);
+            }
+        }
+    }
+    if (jacobian && no) {
+        const SimTK::Array_<Vec3> origins(no, Vec3(0));
+        matter.calcFrameJacobian(s, osensorBodies, origins, JF);
+    }
+    const int offset = 3 * nm;
+    for (int i = 0; i < no; ++i) {
+        const double scale = std::sqrt(osensorWeights[i] / totalOSensorWeight);
+        for (int k = 0; k < 3; ++k) {
+            residuals[offset + 3 * i + k] = scale * osensorErrors[i][k];
+            if (!jacobian) continue;
+            // The angular velocity rows of the frame Jacobian; the error
+            // changes at the angular velocity, to first order.
+            for (int j = 0; j < n; ++j) {
+                (*jacobian)(offset + 3 * i + k, j) =
+                    scale * JF(6 * i + k, _freeUs[j]);
+            }
+        }
+    }
+    if (jacobian) calcFreeMobilityToQ(s, *dqdu);
+    const auto& coordRefs = getCoordinateReferences();
+    for (int i = 0; i < nc; ++i) {
+        const auto& goal = _leastSquaresCoordinateGoals[i];
+        const CoordinateReference& ref = coordRefs[goal.reference];
+        const double scale = std::sqrt(ref.getWeight(s));
+        const int row = 3 * nm + 3 * no + i;
+        residuals[row] = scale * (s.getQ()[goal.q] - ref.getValue(s));
+        if (!jacobian) continue;
+        for (int j = 0; j < n; ++j) {
+            (*jacobian)(row, j) = scale * (*dqdu)(goal.q, j);
+        }
+    }
+    return residuals.normSqr();
+}
+
+void InverseKinematicsSolver::calcFreeMobilityToQ(
+        const SimTK::State &s, SimTK::Matrix &dqdu) const
+{
+    const SimbodyMatterSubsystem& matter = getModel().getMatterSubsystem();
+    const int n = (int)_freeUs.size();
+    dqdu.resize(s.getNQ(), n);
+    SimTK::Vector u(s.getNU(), 0.0);
+    SimTK::Vector qdot;
+    for (int j = 0; j < n; ++j) {
+        u[_freeUs[j]] = 1;
+        matter.multiplyByN(s, false, u, qdot);
+        dqdu(j) = qdot;
+        u[_freeUs[j]] = 0;
+    }
+}
+
+void InverseKinematicsSolver::trackWithLeastSquares(SimTK::State &s)
+{
+    Stopwatch watch;
+    PerformanceRecord record;
+    record.isTrack = true;
+
+    // Move the observations to the current frame (this may advance the time).
+    updateGoals(s);
+    record.time = s.getTime();
+    record.goalsTime = watch.getElapsedTime();
+
+    const int n = (int)_freeUs.size();
+    SimTK::Vector residuals, trialResiduals;
+    SimTK::Matrix jacobian, dqdu;
+    double cost = calcLeastSquaresResiduals(s, residuals, &jacobian, &dqdu);
+    ++record.numGoalEvals;
+    ++record.numGoalGradientEvals;
+
+    // Levenberg-Marquardt: Gauss-Newton steps, damped (and scaled by the
+    // diagonal of the approximate Hessian) when a step does not reduce the
+    // objective.
+    const int maxIterations = 50;
+    double lambda = 1e-3;
+    bool converged = n == 0;
+    SimTK::Vector step;
+    for (int iter = 0; iter < maxIterations && !converged; ++iter) {
+        ++record.numAssemblySteps;
+        const SimTK::Matrix JtJ = ~jacobian * jacobian;
+        const SimTK::Vector gradient = ~jacobian * residuals;
+        const SimTK::Vector q0 = s.getQ();
+        bool accepted = false;
+        while (!accepted && lambda < 1e10) {
+            SimTK::Matrix A = JtJ;
+            for (int i = 0; i < n; ++i) {
+                A(i, i) += lambda * std::max(JtJ(i, i), SimTK::SignificantReal);
+            }
+            SimTK::FactorLU(A).solve(-gradient, step);
+            s.updQ() = q0 + dqdu * step;
+            for (const auto& clamp : _leastSquaresClamps) {
+                s.updQ()[clamp.q] = SimTK::clamp(
+                    clamp.rangeMin, s.getQ()[clamp.q], clamp.rangeMax);
+            }
+            const double trialCost =
+                calcLeastSquaresResiduals(s, trialResiduals);
+            ++record.numGoalEvals;
+            if (trialCost < cost) {
+                accepted = true;
+                lambda = std::max(0.1 * lambda, 1e-12);
+            } else {
+                lambda *= 10;
+            }
+        }
+        if (!accepted) {
+            // No step reduces the objective: we are at a minimum to within
+            // roundoff.
+            s.updQ() = q0;
+            converged = true;
+        } else {
+            // Stop once the coordinates are resolved to the accuracy.
+            converged = max(abs(dqdu * step)) <= getAccuracy();
+        }
+        cost = calcLeastSquaresResiduals(s, residuals, &jacobian, &dqdu);
+        ++record.numGoalEvals;
+        ++record.numGoalGradientEvals;
+    }
+    if (!converged) {
+        log_debug("InverseKinematicsSolver::track(): least squares did not "
+                  "converge in {} iterations at t = {} (objective = {}).",
+                  maxIterations, s.getTime(), cost);
+    }
+
+    // Keep the Assembler's state, from which the current marker and sensor
+    // errors are computed, consistent with the solution.
+    updAssembler().initialize(s);
+
+    record.converged = converged;
+    record.solveTime = watch.getElapsedTime();
+    recordPerformance(record);
+}
+
 /* Internal method to update the time, reference values and/or their weights based
     on the state */
 void InverseKinematicsSolver::updateGoals(SimTK::State &s)
@@ -498,8 +802,11 @@ void InverseKinematicsSolver::updateGoals(SimTK::State &s)
     double nextTime = s.getTime();
     // specify the marker observations to be matched
     if (_markersReference && _markersReference->getNumRefs() > 0) {
-        SimTK::Array_<SimTK::Vec3> markerValues;
-        _markersReference->getValuesAtTime(nextTime, markerValues);
+        // Share the reference's storage of the frame rather than copying it.
+        const auto frame = _markersReference->getValuesViewAtTime(nextTime);
+        const SimTK::Array_<SimTK::Vec3> markerValues(
+                const_cast<SimTK::Vec3*>(frame.begin()), frame.end(),
+                SimTK::DontCopy());
         _markerAssemblyCondition->moveAllObservations(markerValues);
     }
 
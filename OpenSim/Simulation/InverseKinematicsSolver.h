@@ -232,6 +232,41 @@ public:
         _advanceTimeFromReference = newValue;
     };
 
+    /** Use a Levenberg-Marquardt (damped Gauss-Newton) method, rather than
+    the SimTK::Assembler's general-purpose optimizer, in track(). The default
+    is false.
+
+    The method minimizes the same objective as the Assembler: the weighted
+    sum of squared marker distance errors (divided by the sum of the marker
+    weights), plus the weighted sum of squared orientation sensor angle
+    errors (divided by the sum of the sensor weights), plus the weighted
+    squared coordinate errors. The Jacobians of all markers and sensors are
+    formed with one call each to
+    SimbodyMatterSubsystem::calcStationJacobian() and
+    SimbodyMatterSubsystem::calcFrameJacobian(), and each step solves a
+    small dense system whose size is the number of free coordinates.
+    Clamped coordinates are kept within their ranges and locked coordinates
+    are kept fixed. This converges in a few iterations when the previous
+    frame is close to the solution, which is the case when tracking, and is
+    much faster than the Assembler for models with many markers.
+
+    track() starts from the coordinate values in the given state, so pass
+    the state returned by the previous assemble() or track(). The method is
+    used only for models without quaternions and without constraints other
+    than locked coordinates; otherwise, track() uses the Assembler. assemble()
+    always uses the Assembler. */
+    void setUseLeastSquaresTracking(bool tf) {
+        _useLeastSquaresTracking = tf;
+    }
+    bool getUseLeastSquaresTracking() const {
+        return _useLeastSquaresTracking;
+    }
+
+    /** Obtain a model configuration that meets the InverseKinematics
+    conditions, given a state that is close to the solution (see
+    AssemblySolver::track() and setUseLeastSquaresTracking()). */
+    void track(SimTK::State &s) override;
+
 protected:
     /** Override to include point of interest matching (Marker tracking)
         as well ad Frame orientation (OSensor) tracking.
@@ -249,6 +284,22 @@ private:
         assembly problem. */
     void setupOrientationsGoal(SimTK::State &s);
 
+    /** Determine whether track() can use the least-squares method for the
+        model and the locks in this state, and which mobilities are free. */
+    bool setupLeastSquares(const SimTK::State &s);
+    /** Solve the current goals with the Levenberg-Marquardt method. */
+    void trackWithLeastSquares(SimTK::State &s);
+    /** Compute the weighted residuals of the goals, whose sum of squares is
+        the objective, and (optionally) their Jacobian with respect to the
+        free mobilities along with the change in q per change in each free
+        mobility (dqdu, the corresponding columns of N; required with the
+        Jacobian). Returns the objective. */
+    double calcLeastSquaresResiduals(const SimTK::State &s,
+            SimTK::Vector &residuals, SimTK::Matrix *jacobian = nullptr,
+            SimTK::Matrix *dqdu = nullptr) const;
+    /** The columns of N (qdot = N u) for the free mobilities. */
+    void calcFreeMobilityToQ(const SimTK::State &s, SimTK::Matrix &dqdu) const;
+
     // The marker reference values and weightings
     std::shared_ptr<MarkersReference> _markersReference;
 
@@ -267,6 +318,25 @@ private:
     // controlled by the driver porgram (typically based on pre-recorded data).
     bool _advanceTimeFromReference{false};
 
+    bool _useLeastSquaresTracking{false};
+    // -1 until determined by setupLeastSquares() after each setupGoals().
+    int _leastSquaresEligible{-1};
+    // The mobilities that track() with least squares can change.
+    SimTK::Array_<SimTK::UIndex> _freeUs;
+    // Coordinates whose values must stay within their ranges.
+    struct LeastSquaresClamp {
+        SimTK::QIndex q;
+        double rangeMin;
+        double rangeMax;
+    };
+    std::vector<LeastSquaresClamp> _leastSquaresClamps;
+    // Coordinate references that are goals, and the q of their coordinate.
+    struct LeastSquaresCoordinateGoal {
+        int reference;
+        SimTK::QIndex q;
+    };
+    std::vector<LeastSquaresCoordinateGoal> _leastSquaresCoordinateGoals;
+
 //=============================================================================
 };  // END of class InverseKinematicsSolver
 //=============================================================================
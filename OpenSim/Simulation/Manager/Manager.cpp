@@ -24,6 +24,7 @@
 /* Note: This code was originally developed by Realistic Dynamics Inc.
  * Author: Frank C. Anderson
  */
+#include <algorithm>
 #include <cstdio>
 #include "Manager.h"
 #include <OpenSim/Simulation/Model/Model.h>
@@ -97,6 +98,9 @@ setNull()
     _dt = 1.0e-4;
     _performAnalyses=true;
     _writeToStorage=true;
+    _recordToStatesBuffer = true;
+    _numRecordedStates = 0;
+    _numStatesInStorage = 0;
     _tArray.setSize(0);
     _dtArray.setSize(0);
 }
@@ -120,6 +124,12 @@ constructStorage()
     for(int i=0;i<ny;i++) columnLabels.append(stateNames[i]);
     _stateStore->setColumnLabels(columnLabels);
 
+    // The buffer grows as states are recorded.
+    _statesTimes.clear();
+    _statesValues.resize(0, ny);
+    _numRecordedStates = 0;
+    _numStatesInStorage = 0;
+
     return(true);
 }
 
@@ -612,6 +622,8 @@ void Manager::
 setStateStorage(Storage& aStorage)
 {
     _stateStore.reset(&aStorage);
+    // Append to the provided Storage directly.
+    _recordToStatesBuffer = false;
 }
 //_____________________________________________________________________________
 /**
@@ -622,11 +634,48 @@ getStateStorage() const
 {
     if(!_stateStore)
         throw Exception("Manager::getStateStorage(): Storage is not set");
+
+    if (_recordToStatesBuffer) copyRecordedStatesToStorage();
     return *_stateStore;
 }
 
+void Manager::copyRecordedStatesToStorage() const
+{
+    // Copy the rows recorded (or overwritten; see recordToStatesBuffer())
+    // since the last call. Storage::append() replaces a row with the same
+    // time.
+    StateVector vec;
+    for (int irow = _numStatesInStorage; irow < _numRecordedStates; ++irow) {
+        vec.setStates(_statesTimes[irow],
+                SimTK::Vector(_statesValues[irow].transpose()));
+        _stateStore->append(vec);
+    }
+    _numStatesInStorage = _numRecordedStates;
+}
+
 TimeSeriesTable Manager::getStatesTable() const {
-    return getStateStorage().exportToTable();
+    if (!_recordToStatesBuffer) return getStateStorage().exportToTable();
+
+    if(!_stateStore)
+        throw Exception("Manager::getStatesTable(): Storage is not set");
+
+    // Build the table directly from the buffer, with the same metadata and
+    // labels as Storage::exportToTable().
+    const int ny = _statesValues.ncol();
+    const auto& labels = _stateStore->getColumnLabels();
+    std::vector<std::string> columnLabels(
+            labels.get() + 1, labels.get() + labels.getSize());
+    TimeSeriesTable table(_statesTimes,
+            SimTK::Matrix(_statesValues.block(0, 0, _numRecordedStates, ny)),
+            columnLabels);
+    table.addTableMetaData("header", _stateStore->getName());
+    table.addTableMetaData("inDegrees",
+            std::string{_stateStore->isInDegrees() ? "yes" : "no"});
+    table.addTableMetaData("nRows", std::to_string(_numRecordedStates));
+    table.addTableMetaData("nColumns", std::to_string(labels.getSize()));
+    if (!_stateStore->getDescription().empty())
+        table.addTableMetaData("description", _stateStore->getDescription());
+    return table;
 }
 
 //_____________________________________________________________________________
@@ -822,6 +871,17 @@ void Manager::initialize(const SimTK::State& s)
         _timeStepper->setReportAllSignificantStates(true);
     }
 
+    // Find where each state variable lives in Y once, so that recording a
+    // state is a gather from Y. If some state variable is not an element of
+    // Y, we fall back to Model::getStateVariableValues().
+    _stateYIndices = _model->getStateVariableSystemIndices(getState());
+    for (const auto& yIndex : _stateYIndices) {
+        if (!yIndex.isValid()) {
+            _stateYIndices.clear();
+            break;
+        }
+    }
+
     // Here we call the constructStorage because it is possible that
     // the Model's control storage has already been appended in a
     // previous simulation since the Manager mutates the model
@@ -844,16 +904,61 @@ void Manager::record(const SimTK::State& s, const int& step)
             analysisSet.step(s, step);
     }
     if (_writeToStorage) {
-        SimTK::Vector stateValues = _model->getStateVariableValues(s);
-        StateVector vec;
-        vec.setStates(s.getTime(), stateValues);
-        getStateStorage().append(vec);
+        if (_recordToStatesBuffer) {
+            recordToStatesBuffer(s);
+            // A Storage with an output file writes each row as it is
+            // appended (e.g., so that the results of a failed simulation are
+            // not lost); keep doing so.
+            if (_stateStore->hasOutputFile()) copyRecordedStatesToStorage();
+        } else {
+            SimTK::Vector stateValues = _model->getStateVariableValues(s);
+            StateVector vec;
+            vec.setStates(s.getTime(), stateValues);
+            getStateStorage().append(vec);
+        }
         if (_model->isControlled())
             _controllerSet->storeControls(s,
-                (step < 0) ? getStateStorage().getSize() : step);
+                (step < 0) ? getNumRecordedStates() : step);
     }
 }
 
+void Manager::recordToStatesBuffer(const SimTK::State& s)
+{
+    const int ny = _statesValues.ncol();
+    OPENSIM_THROW_IF(ny != _model->getNumStateVariables(), Exception,
+            "Manager: expected the model to have {} state variables, but it "
+            "has {}. Create a new Manager after changing the model.",
+            ny, _model->getNumStateVariables());
+
+    // Like Storage::append(), overwrite the last row if the time is the same.
+    int irow = _numRecordedStates;
+    if (irow > 0 && _statesTimes[irow - 1] == s.getTime()) {
+        --irow;
+        // Copy the row to the Storage again.
+        _numStatesInStorage = std::min(_numStatesInStorage, irow);
+    } else {
+        if (irow == _statesValues.nrow()) {
+            _statesValues.resizeKeep(std::max(512, 2 * irow), ny);
+        }
+        _statesTimes.push_back(s.getTime());
+        ++_numRecordedStates;
+    }
+
+    SimTK::RowVectorView row = _statesValues.updRow(irow);
+    if (!_stateYIndices.empty()) {
+        const SimTK::Vector& y = s.getY();
+        for (int i = 0; i < ny; ++i) row[i] = y[_stateYIndices[i]];
+    } else {
+        row = _model->getStateVariableValues(s).transpose();
+    }
+}
+
+int Manager::getNumRecordedStates() const
+{
+    if (_recordToStatesBuffer) return _numRecordedStates;
+    return getStateStorage().getSize();
+}
+
 //=============================================================================
 // INTERRUPT
 //=============================================================================
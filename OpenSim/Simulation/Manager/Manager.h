@@ -87,6 +87,23 @@ private:
     /** Storage for the states. */
     std::unique_ptr<Storage> _stateStore;
 
+    /** Unless a Storage is provided with setStateStorage(), the states are
+    recorded into these preallocated buffers, and copied to _stateStore only
+    when it is requested, or at every recorded step if _stateStore has an
+    output file. _statesValues has one column per state variable and
+    its number of rows grows geometrically; the first _numRecordedStates rows
+    are in use. */
+    bool _recordToStatesBuffer;
+    std::vector<double> _statesTimes;
+    SimTK::Matrix _statesValues;
+    int _numRecordedStates;
+    /** Number of recorded rows already copied to _stateStore. */
+    mutable int _numStatesInStorage;
+    /** Index in the State's Y of each state variable (in the order of the
+    columns of the states Storage), determined by initialize(). Empty if
+    some state variable is not an element of Y. */
+    std::vector<SimTK::SystemYIndex> _stateYIndices;
+
     /** Flag for signaling a desired halt. */
     bool _halt;
 
@@ -339,9 +356,18 @@ public:
     // STATE STORAGE
     bool hasStateStorage() const;
     /** Set the Storage object to be used for storing states. The Manager takes
-    ownership of the passed-in Storage. */
+    ownership of the passed-in Storage, and appends to it directly at every
+    recorded step. */
     void setStateStorage(Storage& aStorage);
+    /** Get the Storage containing the states recorded so far. By default, the
+    Manager records states into a preallocated buffer and copies them to this
+    Storage when you call this method; getStatesTable() avoids the copy. If
+    this Storage has an output file (Storage::setOutputFileName()), each
+    state is instead copied (and so written to the file) as it is
+    recorded. */
     Storage& getStateStorage() const;
+    /** Get the states recorded so far as a table with one column per state
+    variable. */
     TimeSeriesTable getStatesTable() const;
 
    //--------------------------------------------------------------------------
@@ -362,6 +388,13 @@ private:
     // Helper to record state and analysis values at integration steps.
     // step = 0 is the beginning, step = -1 used to denote the end/final step
     void record(const SimTK::State& s, const int& step);
+    // Helper for record() that writes the state variable values into the
+    // states buffer, growing it if necessary.
+    void recordToStatesBuffer(const SimTK::State& s);
+    // Append the rows of the states buffer that are not yet in (or were
+    // overwritten since they were appended to) the states Storage.
+    void copyRecordedStatesToStorage() const;
+    int getNumRecordedStates() const;
 
 //=============================================================================
 };  // END of class Manager
@@ -22,6 +22,7 @@
  * -------------------------------------------------------------------------- */
 
 #include "MarkersReference.h"
+#include <OpenSim/Common/TRCFileAdapter.h>
 #include <SimTKcommon/internal/State.h>
 #include <cmath>
 
@@ -63,7 +64,14 @@ void MarkersReference::initializeFromMarkersFile(const std::string& markerFile,
                      markerFile,
                      "Supported file types are -- STO, TRC.");
 
-    if(fileExt == "trc") {
+    if(fileExt == "trc" && markerWeightSet.getSize()) {
+        // Only the markers with weights are tracked, so do not parse the
+        // others.
+        std::vector<std::string> markerNames;
+        for (int i = 0; i < markerWeightSet.getSize(); ++i)
+            markerNames.push_back(markerWeightSet[i].getName());
+        _markerTable = TRCFileAdapter::readMarkers(markerFile, markerNames);
+    } else if(fileExt == "trc") {
         _markerTable = TimeSeriesTableVec3{markerFile};
     } else {
         try {
@@ -95,8 +103,7 @@ populateFromMarkerData(const TimeSeriesTable_<SimTK::Vec3>& markerTable,
                      "TimeSeriesTable has unspecified units.");
 
     if(std::fabs(scaleFactor - 1) >= SimTK::Eps) {
-        for(unsigned r = 0; r < _markerTable.getNumRows(); ++r)
-            _markerTable.updRowAtIndex(r) *= scaleFactor;
+        _markerTable.updMatrix() *= scaleFactor;
 
         _markerTable.removeTableMetaDataKey("Units");
         _markerTable.addTableMetaData("Units", units);
@@ -108,11 +115,28 @@ populateFromMarkerData(const TimeSeriesTable_<SimTK::Vec3>& markerTable,
     // If user specifies a MarkerWeightSet only track markers that it specifies
     // therefore remove extraneous markers and their data from the Reference
     if (markerWeightSet.getSize()) {
-        for (const auto& mname : allMarkerNamesInFile) {
-            if (!markerWeightSet.contains(mname)) {
-                _markerTable.removeColumn(mname);
+        std::vector<std::string> trackedNames;
+        std::vector<int> trackedColumns;
+        for (int i = 0; i < (int)allMarkerNamesInFile.size(); ++i) {
+            if (markerWeightSet.contains(allMarkerNamesInFile[i])) {
+                trackedNames.push_back(allMarkerNamesInFile[i]);
+                trackedColumns.push_back(i);
             }
         }
+        // Gather the tracked columns at once; removing the other columns one
+        // at a time copies the whole table for each column removed.
+        if (trackedNames.size() < allMarkerNamesInFile.size()) {
+            const auto& data = _markerTable.getMatrix();
+            SimTK::Matrix_<SimTK::Vec3> trackedData(
+                    data.nrow(), (int)trackedColumns.size());
+            for (int j = 0; j < (int)trackedColumns.size(); ++j)
+                trackedData(j) = data(trackedColumns[j]);
+            TimeSeriesTable_<SimTK::Vec3> trackedTable(
+                    _markerTable.getIndependentColumn(), trackedData,
+                    trackedNames);
+            trackedTable.updTableMetaData() = _markerTable.getTableMetaData();
+            _markerTable = std::move(trackedTable);
+        }
         // update the reference weights to be the user assigned weights
         upd_marker_weights() = markerWeightSet;
     }
@@ -132,6 +156,16 @@ populateFromMarkerData(const TimeSeriesTable_<SimTK::Vec3>& markerTable,
 
     // Names must be assigned before weights can be updated
     updateInternalWeights();
+
+    // The table stores each marker's trajectory contiguously; store each
+    // frame contiguously as well, so that getValuesViewAtTime() need not
+    // copy.
+    const auto& data = _markerTable.getMatrix();
+    const int nc = data.ncol();
+    _frames.resize(static_cast<size_t>(data.nrow()) * nc);
+    for (int r = 0; r < data.nrow(); ++r)
+        for (int c = 0; c < nc; ++c)
+            _frames[static_cast<size_t>(r) * nc + c] = data(r, c);
 }
 
 SimTK::Vec2 MarkersReference::getValidTimeRange() const {
@@ -156,10 +190,16 @@ const SimTK::Array_<std::string>& MarkersReference::getNames() const {
 
 void MarkersReference::getValuesAtTime(double time,
                                   SimTK::Array_<Vec3>& values) const {
-    const auto rowView = _markerTable.getNearestRow(time);
-    values.clear();
-    for(int i = 0; i < rowView.ncol(); ++i)
-        values.push_back(rowView[i]);
+    const auto frame = getValuesViewAtTime(time);
+    values.assign(frame.begin(), frame.end());
+}
+
+SimTK::ArrayViewConst_<Vec3>
+MarkersReference::getValuesViewAtTime(double time) const {
+    const size_t nc = _markerTable.getNumColumns();
+    const Vec3* first =
+            _frames.data() + _markerTable.getNearestRowIndexForTime(time) * nc;
+    return SimTK::ArrayViewConst_<Vec3>(first, first + nc);
 }
 
 // void
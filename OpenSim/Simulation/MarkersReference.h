@@ -146,6 +146,12 @@ public:
     /** get the value of the MarkersReference  */
     void getValuesAtTime(
             double time, SimTK::Array_<SimTK::Vec3> &values) const override;
+    /** Same as getValuesAtTime(), but the values are not copied: the view
+        refers to storage owned by this MarkersReference, and is valid as
+        long as this MarkersReference is not modified or destroyed. To
+        support this, the marker data is stored twice: in the marker table
+        (one column per marker) and frame by frame. */
+    SimTK::ArrayViewConst_<SimTK::Vec3> getValuesViewAtTime(double time) const;
     // The following two methods are commented out as they are not implemented
     // and we don't want users to think it *is* implemented when viewing
     // doxygen.
@@ -190,6 +196,14 @@ private:
     SimTK::Array_<std::string> _markerNames;
     // List of weights guaranteed to be in the same order as marker names.
     mutable SimTK::Array_<double> _weights;
+    // The values in _markerTable, frame by frame (row-major). This doubles
+    // the memory used for the marker data, but the table's matrix stores
+    // each marker's trajectory contiguously, and a frame must be contiguous
+    // for getValuesViewAtTime() to avoid copying it at every time step. The
+    // table is still needed for getMarkerTable(), which the IK tool and
+    // Moco use. The copy takes 24 bytes per marker per frame (e.g., 12 MB
+    // for 50 markers and 10,000 frames).
+    std::vector<SimTK::Vec3> _frames;
 //=============================================================================
 };  // END of class MarkersReference
 //=============================================================================
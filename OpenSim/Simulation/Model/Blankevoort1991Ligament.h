@@ -304,6 +304,10 @@ public:
     double computePotentialEnergy(
         const SimTK::State& state) const override;
 
+    /** The ligament force can be computed in parallel with other forces
+    (see Model::setNumForceThreads()). */
+    bool shouldBeParallelized() const override { return true; }
+
     //-------------------------------------------------------------------------
     // SCALE
     //-------------------------------------------------------------------------
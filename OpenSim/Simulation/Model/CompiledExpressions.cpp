@@ -0,0 +1,419 @@
+/* -------------------------------------------------------------------------- *
+ *                     OpenSim:  CompiledExpressions.cpp                      *
+ * -------------------------------------------------------------------------- *
+ * The OpenSim API is a toolkit for musculoskeletal modeling and simulation.  *
+ * See http://opensim.stanford.edu and the NOTICE file for more information.  *
+ * OpenSim is developed at Stanford University and supported by the US        *
+ * National Institutes of Health (U54 GM072970, R24 HD065690) and by DARPA    *
+ * through the Warrior Web program.                                           *
+ *                                                                            *
+ * Copyright (c) 2005-2021 Stanford University and the Authors                *
+ * Author(s): OpenSim Team                                                    *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "CompiledExpressions.h"
+
+#include <OpenSim/Common/Exception.h>
+#include <OpenSim/Common/Logger.h>
+#include <OpenSim/Common/NativeCodeCache.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <lepton/ParsedExpression.h>
+#include <lepton/Parser.h>
+
+#ifndef _WIN32
+#include <dlfcn.h>
+#endif
+
+using namespace OpenSim;
+
+namespace {
+
+using NativeFunction = void (*)(double*, int);
+
+// The name of the function in the generated source code.
+const char* const NativeFunctionName = "opensim_evaluate_expressions";
+
+struct NativeCodeSettings {
+    NativeCodeSettings() {
+        const char* enabledVar = std::getenv("OPENSIM_NATIVE_EXPRESSIONS");
+        enabled = enabledVar && std::string(enabledVar) != "0";
+        const char* cxx = std::getenv("CXX");
+        compiler = cxx ? cxx : "c++";
+        cacheDirectory = NativeCodeCache::getDefaultDirectory("expressions");
+    }
+    std::mutex mutex;
+    bool enabled;
+    std::string compiler;
+    std::string cacheDirectory;
+    // Functions that have been loaded in this process, by their source code.
+    std::map<std::string, NativeFunction> functions;
+};
+
+NativeCodeSettings& getNativeCodeSettings() {
+    static NativeCodeSettings settings;
+    return settings;
+}
+
+// A literal that the compiler parses to exactly the given value.
+std::string toLiteral(double value) {
+    if (std::isnan(value)) return "std::numeric_limits<double>::quiet_NaN()";
+    if (std::isinf(value)) {
+        return value > 0 ? "std::numeric_limits<double>::infinity()"
+                         : "(-std::numeric_limits<double>::infinity())";
+    }
+    std::ostringstream literal;
+    literal << "(" << std::scientific << std::setprecision(17) << value
+            << ")";
+    return literal.str();
+}
+
+// The C++ code for an operation, with the same semantics as
+// Lepton::Operation::evaluate(), or an empty string if the operation cannot
+// be translated.
+std::string translate(const Lepton::Operation& operation,
+        const std::vector<std::string>& a) {
+    using Lepton::Operation;
+    auto call = [&](const std::string& function) {
+        return function + "(" + a[0] + ")";
+    };
+    switch (operation.getId()) {
+    case Operation::ADD: return "(" + a[0] + " + " + a[1] + ")";
+    case Operation::SUBTRACT: return "(" + a[0] + " - " + a[1] + ")";
+    case Operation::MULTIPLY: return "(" + a[0] + " * " + a[1] + ")";
+    case Operation::DIVIDE: return "(" + a[0] + " / " + a[1] + ")";
+    case Operation::POWER: return "std::pow(" + a[0] + ", " + a[1] + ")";
+    case Operation::NEGATE: return "(-" + a[0] + ")";
+    case Operation::SQRT: return call("std::sqrt");
+    case Operation::EXP: return call("std::exp");
+    case Operation::LOG: return call("std::log");
+    case Operation::SIN: return call("std::sin");
+    case Operation::COS: return call("std::cos");
+    case Operation::SEC: return "(1.0 / " + call("std::cos") + ")";
+    case Operation::CSC: return "(1.0 / " + call("std::sin") + ")";
+    case Operation::TAN: return call("std::tan");
+    case Operation::COT: return "(1.0 / " + call("std::tan") + ")";
+    case Operation::ASIN: return call("std::asin");
+    case Operation::ACOS: return call("std::acos");
+    case Operation::ATAN: return call("std::atan");
+    case Operation::SINH: return call("std::sinh");
+    case Operation::COSH: return call("std::cosh");
+    case Operation::TANH: return call("std::tanh");
+    case Operation::ERF: return call("std::erf");
+    case Operation::ERFC: return call("std::erfc");
+    case Operation::STEP: return "(" + a[0] + " >= 0.0 ? 1.0 : 0.0)";
+    case Operation::DELTA: return "(" + a[0] + " == 0.0 ? 1.0 : 0.0)";
+    case Operation::SQUARE: return "(" + a[0] + " * " + a[0] + ")";
+    case Operation::CUBE:
+        return "(" + a[0] + " * " + a[0] + " * " + a[0] + ")";
+    case Operation::RECIPROCAL: return "(1.0 / " + a[0] + ")";
+    case Operation::ADD_CONSTANT:
+        return "(" + a[0] + " + " +
+               toLiteral(dynamic_cast<const Operation::AddConstant&>(
+                       operation).getValue()) + ")";
+    case Operation::MULTIPLY_CONSTANT:
+        return "(" + a[0] + " * " +
+               toLiteral(dynamic_cast<const Operation::MultiplyConstant&>(
+                       operation).getValue()) + ")";
+    case Operation::POWER_CONSTANT: {
+        const double exponent =
+                dynamic_cast<const Operation::PowerConstant&>(operation)
+                        .getValue();
+        const int intExponent = (int)exponent;
+        if (intExponent == exponent) {
+            return "opensim_powi(" + a[0] + ", " +
+                   std::to_string(intExponent) + ")";
+        }
+        return "std::pow(" + a[0] + ", " + toLiteral(exponent) + ")";
+    }
+    case Operation::MIN: return "(" + a[1] + " < " + a[0] + " ? " + a[1] +
+                                " : " + a[0] + ")";
+    case Operation::MAX: return "(" + a[0] + " < " + a[1] + " ? " + a[1] +
+                                " : " + a[0] + ")";
+    case Operation::ABS: return call("std::fabs");
+    default: return "";
+    }
+}
+
+// Compile (or find in the cache) and load the library for the given source
+// code. Returns nullptr if this fails.
+NativeFunction loadNativeFunction(const std::string& source) {
+    auto& settings = getNativeCodeSettings();
+    // Hold the lock while compiling, so that threads constructing the same
+    // expressions do not compile them more than once.
+    std::lock_guard<std::mutex> lock(settings.mutex);
+    const auto loaded = settings.functions.find(source);
+    if (loaded != settings.functions.end()) return loaded->second;
+#ifdef _WIN32
+    log_warn("CompiledExpressions: native code is not supported on Windows; "
+             "interpreting the expressions instead.");
+    settings.functions[source] = nullptr;
+    return nullptr;
+#else
+    const std::string library = NativeCodeCache::getLibrary(
+            settings.cacheDirectory, "expressions", source, "cpp",
+            settings.compiler, "-O2 -shared -fPIC");
+    if (library.empty()) {
+        log_warn("CompiledExpressions: interpreting the expressions instead "
+                 "of compiling them.");
+        settings.functions[source] = nullptr;
+        return nullptr;
+    }
+
+    NativeFunction function = nullptr;
+    // The library is never unloaded, as copies of CompiledExpressions may
+    // use its function until the process exits.
+    void* handle = dlopen(library.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (handle) {
+        function = reinterpret_cast<NativeFunction>(
+                dlsym(handle, NativeFunctionName));
+    }
+    if (!function) {
+        const char* error = dlerror();
+        log_warn("CompiledExpressions: failed to load '{}' ({}); "
+                 "interpreting the expressions instead.", library,
+                error ? error : "unknown error");
+    }
+    settings.functions[source] = function;
+    return function;
+#endif
+}
+
+} // anonymous namespace
+
+struct CompiledExpressions::Temporary {
+    Lepton::ExpressionTreeNode node;
+    int slot;
+};
+
+CompiledExpressions::CompiledExpressions(
+        const std::vector<std::string>& expressions,
+        const std::vector<std::string>& variables, bool withDerivatives)
+        : m_numVariables((int)variables.size()),
+          m_slots(variables.size(), 0.0) {
+    std::vector<Lepton::ParsedExpression> parsed;
+    for (const auto& expression : expressions) {
+        parsed.push_back(Lepton::Parser::parse(expression).optimize());
+    }
+
+    // Nodes that have been compiled, and the slots that hold their values.
+    // Comparing nodes is quadratic in the number of nodes, but the
+    // expressions are compiled only once and are usually small.
+    std::vector<Temporary> temporaries;
+    for (int i = 0; i < (int)parsed.size(); ++i) {
+        m_valueSlots.push_back(compileNode(parsed[i].getRootNode(),
+                expressions[i], variables, temporaries));
+    }
+    m_numValueSteps = (int)m_steps.size();
+
+    if (withDerivatives) {
+        for (int i = 0; i < (int)parsed.size(); ++i) {
+            for (const auto& variable : variables) {
+                const Lepton::ParsedExpression derivative =
+                        parsed[i].differentiate(variable).optimize();
+                m_derivativeSlots.push_back(compileNode(
+                        derivative.getRootNode(), expressions[i], variables,
+                        temporaries));
+            }
+        }
+    }
+
+    for (const auto& step : m_steps) {
+        m_maxNumArguments = std::max(m_maxNumArguments,
+                step.operation->getNumArguments());
+    }
+
+    if (getNativeCodeEnabled()) {
+        const std::string source = generateSource(NativeFunctionName);
+        if (!source.empty()) m_nativeFunction = loadNativeFunction(source);
+    }
+}
+
+int CompiledExpressions::compileNode(const Lepton::ExpressionTreeNode& node,
+        const std::string& expression,
+        const std::vector<std::string>& variables,
+        std::vector<Temporary>& temporaries) {
+    const Lepton::Operation& operation = node.getOperation();
+    if (operation.getId() == Lepton::Operation::VARIABLE) {
+        const auto it = std::find(variables.begin(), variables.end(),
+                operation.getName());
+        OPENSIM_THROW_IF(it == variables.end(), Exception,
+                "Expression '{}' uses the unknown variable '{}'.", expression,
+                operation.getName());
+        return (int)(it - variables.begin());
+    }
+    for (const auto& temporary : temporaries) {
+        if (temporary.node == node) return temporary.slot;
+    }
+
+    if (operation.getId() == Lepton::Operation::CONSTANT) {
+        // Constants are evaluated only once.
+        const int slot = (int)m_slots.size();
+        m_slots.push_back(dynamic_cast<const Lepton::Operation::Constant&>(
+                operation).getValue());
+        temporaries.push_back({node, slot});
+        return slot;
+    }
+
+    std::vector<int> arguments;
+    for (const auto& child : node.getChildren()) {
+        arguments.push_back(
+                compileNode(child, expression, variables, temporaries));
+    }
+    bool consecutive = true;
+    for (int i = 1; i < (int)arguments.size(); ++i) {
+        if (arguments[i] != arguments[i - 1] + 1) consecutive = false;
+    }
+    if (consecutive) arguments.resize(1);
+    const int target = (int)m_slots.size();
+    m_slots.push_back(0.0);
+    m_steps.push_back(
+            {SimTK::ClonePtr<Lepton::Operation>(operation.clone()),
+                    std::move(arguments), target});
+    temporaries.push_back({node, target});
+    return target;
+}
+
+CompiledExpressions::Workspace CompiledExpressions::createWorkspace() const {
+    // The slots are followed by room for the arguments of a step whose
+    // arguments are not in consecutive slots.
+    Workspace workspace(m_slots);
+    workspace.resize(m_slots.size() + m_maxNumArguments, 0.0);
+    return workspace;
+}
+
+void CompiledExpressions::evaluate(const double* variables,
+        Workspace& workspace, bool derivatives) const {
+    OPENSIM_THROW_IF(derivatives && !hasDerivatives(), Exception,
+            "The derivatives of the expressions were not compiled.");
+    OPENSIM_THROW_IF(workspace.size() != m_slots.size() + m_maxNumArguments,
+            Exception, "Expected a workspace created by createWorkspace().");
+    std::copy(variables, variables + m_numVariables, workspace.begin());
+    double* w = workspace.data();
+    if (m_nativeFunction) {
+        m_nativeFunction(w, derivatives ? 1 : 0);
+        return;
+    }
+    // Operations other than Variable ignore the map of variables.
+    static const std::map<std::string, double> noVariables;
+    const int numSteps = derivatives ? (int)m_steps.size() : m_numValueSteps;
+    double* scratch = w + m_slots.size();
+    for (int istep = 0; istep < numSteps; ++istep) {
+        const Step& step = m_steps[istep];
+        double* arguments;
+        if (step.arguments.size() == 1) {
+            arguments = w + step.arguments[0];
+        } else {
+            for (int i = 0; i < (int)step.arguments.size(); ++i) {
+                scratch[i] = w[step.arguments[i]];
+            }
+            arguments = scratch;
+        }
+        w[step.target] = step.operation->evaluate(arguments, noVariables);
+    }
+}
+
+std::string CompiledExpressions::generateSource(const std::string& name) const {
+    // Slots that are neither variables nor computed by a step hold
+    // constants, which are written as literals.
+    std::vector<bool> isComputed(m_slots.size(), false);
+    std::fill(isComputed.begin(), isComputed.begin() + m_numVariables, true);
+    for (const auto& step : m_steps) isComputed[step.target] = true;
+    auto slot = [&](int i) {
+        return isComputed[i] ? "w[" + std::to_string(i) + "]"
+                             : toLiteral(m_slots[i]);
+    };
+
+    std::ostringstream source;
+    source << "#include <cmath>\n"
+              "#include <limits>\n"
+              "\n"
+              "// Same as Lepton::Operation::PowerConstant.\n"
+              "static inline double opensim_powi(double base, int exponent) {\n"
+              "    if (exponent < 0) {\n"
+              "        exponent = -exponent;\n"
+              "        base = 1.0 / base;\n"
+              "    }\n"
+              "    double result = 1.0;\n"
+              "    while (exponent != 0) {\n"
+              "        if ((exponent & 1) == 1) result *= base;\n"
+              "        base *= base;\n"
+              "        exponent = exponent >> 1;\n"
+              "    }\n"
+              "    return result;\n"
+              "}\n"
+              "\n"
+              "extern \"C\" void " << name << "(double* w, int derivatives) {\n";
+    for (int istep = 0; istep < (int)m_steps.size(); ++istep) {
+        if (istep == m_numValueSteps) {
+            source << "    if (!derivatives) return;\n";
+        }
+        const Step& step = m_steps[istep];
+        const int numArguments = step.operation->getNumArguments();
+        std::vector<std::string> arguments;
+        for (int i = 0; i < numArguments; ++i) {
+            arguments.push_back(slot(step.arguments.size() == 1
+                                             ? step.arguments[0] + i
+                                             : step.arguments[i]));
+        }
+        const std::string code = translate(*step.operation, arguments);
+        if (code.empty()) return "";
+        source << "    w[" << step.target << "] = " << code << ";\n";
+    }
+    source << "}\n";
+    return source.str();
+}
+
+void CompiledExpressions::setNativeCodeEnabled(bool enabled) {
+    auto& settings = getNativeCodeSettings();
+    std::lock_guard<std::mutex> lock(settings.mutex);
+    settings.enabled = enabled;
+}
+
+bool CompiledExpressions::getNativeCodeEnabled() {
+    auto& settings = getNativeCodeSettings();
+    std::lock_guard<std::mutex> lock(settings.mutex);
+    return settings.enabled;
+}
+
+void CompiledExpressions::setNativeCodeCompiler(const std::string& compiler) {
+    auto& settings = getNativeCodeSettings();
+    std::lock_guard<std::mutex> lock(settings.mutex);
+    settings.compiler = compiler;
+}
+
+std::string CompiledExpressions::getNativeCodeCompiler() {
+    auto& settings = getNativeCodeSettings();
+    std::lock_guard<std::mutex> lock(settings.mutex);
+    return settings.compiler;
+}
+
+void CompiledExpressions::setNativeCodeCacheDirectory(
+        const std::string& directory) {
+    auto& settings = getNativeCodeSettings();
+    std::lock_guard<std::mutex> lock(settings.mutex);
+    settings.cacheDirectory = directory;
+}
+
+std::string CompiledExpressions::getNativeCodeCacheDirectory() {
+    auto& settings = getNativeCodeSettings();
+    std::lock_guard<std::mutex> lock(settings.mutex);
+    return settings.cacheDirectory;
+}
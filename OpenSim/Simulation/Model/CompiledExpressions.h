@@ -0,0 +1,202 @@
+#ifndef OPENSIM_COMPILED_EXPRESSIONS_H_
+#define OPENSIM_COMPILED_EXPRESSIONS_H_
+/* -------------------------------------------------------------------------- *
+ *                      OpenSim:  CompiledExpressions.h                       *
+ * -------------------------------------------------------------------------- *
+ * The OpenSim API is a toolkit for musculoskeletal modeling and simulation.  *
+ * See http://opensim.stanford.edu and the NOTICE file for more information.  *
+ * OpenSim is developed at Stanford University and supported by the US        *
+ * National Institutes of Health (U54 GM072970, R24 HD065690) and by DARPA    *
+ * through the Warrior Web program.                                           *
+ *                                                                            *
+ * Copyright (c) 2005-2021 Stanford University and the Authors                *
+ * Author(s): OpenSim Team                                                    *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include <OpenSim/Simulation/osimSimulationDLL.h>
+
+#include <SimTKcommon/internal/ClonePtr.h>
+#include <lepton/ExpressionTreeNode.h>
+#include <lepton/Operation.h>
+#include <string>
+#include <vector>
+
+namespace OpenSim {
+
+/** Evaluate one or more Lepton expressions of the same variables, for use by
+components whose behavior is defined by user-provided expressions (e.g.,
+ExpressionBasedBushingForce).
+
+The expressions are compiled into a single sequence of operations when this
+object is constructed. Each variable is bound to a fixed slot, so evaluating
+the expressions requires neither parsing nor looking up variables by name
+(as Lepton::ExpressionProgram does with its map of variables).
+Subexpressions that appear more than once, within an expression or across
+expressions, are evaluated only once, and constant subexpressions are
+evaluated when compiling.
+
+Optionally, the partial derivatives of each expression with respect to each
+variable are differentiated symbolically and compiled into the same sequence
+of operations; they are evaluated only if requested.
+
+The intermediate results are computed in a Workspace, which the caller
+provides, so that evaluate() does not modify this object: concurrent
+evaluations (e.g., of different States of one Model) are safe as long as
+each uses its own Workspace. A component can keep its Workspace in a cache
+variable, so that each State has its own.
+
+@code
+CompiledExpressions program({"-k*x^2", "2*k*x"}, {"x", "k"});
+CompiledExpressions::Workspace workspace = program.createWorkspace();
+const double values[] = {0.1, 10.0};
+program.evaluate(values, workspace);
+double energy = program.getValue(workspace, 0);
+@endcode
+
+<b>Native code.</b> If enabled with setNativeCodeEnabled() (or the
+environment variable OPENSIM_NATIVE_EXPRESSIONS=1), the constructor also
+translates the program into C++ source code, compiles it into a shared
+library with the system compiler (see setNativeCodeCompiler()), and loads
+it; evaluate() then calls the compiled function. The libraries are cached
+on disk (see setNativeCodeCacheDirectory() and NativeCodeCache), keyed by
+the generated source, so a model is compiled only the first time it is
+loaded; within a process, each library is loaded once. A library is loaded
+only from a cache directory that is private to the current user. If the code cannot be compiled or loaded (e.g.,
+there is no compiler, or on Windows, where this is not supported), a warning
+is logged and the expressions are interpreted as usual. Compiling takes on
+the order of a second, so this pays off only for long simulations or
+optimizations with large expressions. */
+class OSIMSIMULATION_API CompiledExpressions {
+public:
+    CompiledExpressions() = default;
+    /** @param expressions The expressions to evaluate; each may use any
+        subset of the variables.
+        @param variables The names of the variables, in the order in which
+        their values are passed to evaluate().
+        @param withDerivatives Also compile the partial derivatives of each
+        expression with respect to each variable.
+        @throws Lepton::Exception if an expression cannot be parsed.
+        @throws Exception if an expression uses a variable that is not in
+        `variables`. */
+    CompiledExpressions(const std::vector<std::string>& expressions,
+            const std::vector<std::string>& variables,
+            bool withDerivatives = false);
+
+    /** Memory in which evaluate() computes the expressions; see
+        createWorkspace(). */
+    using Workspace = std::vector<double>;
+
+    int getNumExpressions() const { return (int)m_valueSlots.size(); }
+    int getNumVariables() const { return m_numVariables; }
+    bool hasDerivatives() const { return !m_derivativeSlots.empty(); }
+
+    /** A Workspace for evaluating these expressions. A Workspace must not
+        be used by two evaluations at the same time. */
+    Workspace createWorkspace() const;
+
+    /** Evaluate the expressions (and, if `derivatives` is true, their
+        derivatives) at the given values of the variables; `variables` must
+        contain getNumVariables() values, in the order passed to the
+        constructor. The results are available through getValue() and
+        getDerivative() until the next call to evaluate() with the same
+        `workspace`.
+        @throws Exception if `derivatives` is true and the derivatives were
+        not compiled, or if `workspace` was not created by
+        createWorkspace(). */
+    void evaluate(const double* variables, Workspace& workspace,
+            bool derivatives = false) const;
+
+    /** The value of the expression with index `iexpr`, as of the last call
+        to evaluate() with `workspace`. */
+    double getValue(const Workspace& workspace, int iexpr) const {
+        return workspace[m_valueSlots[iexpr]];
+    }
+    /** The partial derivative of the expression with index `iexpr` with
+        respect to the variable with index `ivar`, as of the last call to
+        evaluate() with `workspace` and `derivatives` true. */
+    double getDerivative(
+            const Workspace& workspace, int iexpr, int ivar) const {
+        return workspace[m_derivativeSlots[iexpr * m_numVariables + ivar]];
+    }
+
+    /** Whether evaluate() calls native code compiled from the expressions
+        (see the class description). */
+    bool usesNativeCode() const { return m_nativeFunction != nullptr; }
+
+    /** C++ source code for a function, with C linkage, that evaluates the
+        expressions in the same way as evaluate():
+        @code
+        void name(double* workspace, int derivatives);
+        @endcode
+        @returns an empty string if the expressions use an operation that
+        cannot be translated (i.e., a custom function). */
+    std::string generateSource(const std::string& name) const;
+
+    /** @name Native code settings
+    These settings affect CompiledExpressions constructed afterwards, and
+    can be changed from any thread. */
+    /// @{
+    static void setNativeCodeEnabled(bool enabled);
+    static bool getNativeCodeEnabled();
+    /** The command that invokes the C++ compiler (default: the environment
+        variable CXX, or "c++"). It is called with the arguments
+        `-O2 -shared -fPIC -o <library> <source>`. The command may contain
+        arguments, but no characters that the shell interprets (see
+        NativeCodeCache::getLibrary()). */
+    static void setNativeCodeCompiler(const std::string& compiler);
+    static std::string getNativeCodeCompiler();
+    /** The directory in which compiled expressions are stored (default:
+        NativeCodeCache::getDefaultDirectory("expressions"), e.g.,
+        `~/.cache/opensim/expressions`). The directory is created with mode
+        0700 if it does not exist, and it is used only if it is owned by the
+        current user and not writable by others. */
+    static void setNativeCodeCacheDirectory(const std::string& directory);
+    static std::string getNativeCodeCacheDirectory();
+    /// @}
+
+private:
+    using NativeFunction = void (*)(double*, int);
+
+    struct Step {
+        SimTK::ClonePtr<Lepton::Operation> operation;
+        // Slots of the arguments. If the arguments are in consecutive slots,
+        // this contains only the first slot.
+        std::vector<int> arguments;
+        int target;
+    };
+    struct Temporary;
+
+    int compileNode(const Lepton::ExpressionTreeNode& node,
+            const std::string& expression,
+            const std::vector<std::string>& variables,
+            std::vector<Temporary>& temporaries);
+
+    int m_numVariables = 0;
+    std::vector<Step> m_steps;
+    // The steps that compute the derivatives follow those that compute the
+    // values.
+    int m_numValueSteps = 0;
+    std::vector<int> m_valueSlots;
+    std::vector<int> m_derivativeSlots;
+    // The initial contents of a Workspace: the first m_numVariables slots
+    // hold the values of the variables, and the constants are filled in.
+    std::vector<double> m_slots;
+    // Room for arguments at the end of a Workspace.
+    int m_maxNumArguments = 0;
+    // Points into a library that stays loaded until the process exits.
+    NativeFunction m_nativeFunction = nullptr;
+};
+
+} // namespace OpenSim
+
+#endif // OPENSIM_COMPILED_EXPRESSIONS_H_
@@ -52,6 +52,7 @@ ContactMesh::ContactMesh(const std::string& filename,
         SimTK::PolygonalMesh mesh;
         mesh.loadFile(filename);
         _geometry.reset(new SimTK::ContactGeometry::TriangleMesh(mesh));
+        _geometryPath = IO::makeAbsolutePath(filename);
         _decorativeGeometry.reset(new SimTK::DecorativeMesh(mesh));
     }
 }
@@ -76,11 +77,6 @@ void ContactMesh::constructProperties()
     constructProperty_filename("");
 }
 
-void ContactMesh::extendFinalizeFromProperties() {
-    _geometry.reset();
-    _decorativeGeometry.reset();
-}
-
 const std::string& ContactMesh::getFilename() const
 {
     return get_filename();
@@ -90,14 +86,20 @@ void ContactMesh::setFilename(const std::string& filename)
 {
     set_filename(filename);
     _geometry.reset();
+    _geometryPath.clear();
     _decorativeGeometry.reset();
 }
 
 SimTK::ContactGeometry::TriangleMesh* ContactMesh::
     loadMesh(const std::string& filename) const
 {
-    SimTK::PolygonalMesh mesh;
-    std::ifstream file;
+    SimTK::PolygonalMesh mesh = loadPolygonalMesh(filename);
+    _decorativeGeometry.reset(new SimTK::DecorativeMesh(mesh));
+    return new SimTK::ContactGeometry::TriangleMesh(mesh);
+}
+
+std::string ContactMesh::resolveMeshPath(const std::string& filename) const
+{
     assert (_model);
 
     auto cwd = IO::CwdChanger::noop();
@@ -105,7 +107,14 @@ SimTK::ContactGeometry::TriangleMesh* ContactMesh::
             && (_model->getInputFileName()!="Unassigned")) {
         cwd = IO::CwdChanger::changeToParentOf(_model->getInputFileName());
     }
+    return IO::makeAbsolutePath(filename);
+}
 
+SimTK::PolygonalMesh ContactMesh::
+    loadPolygonalMesh(const std::string& filename) const
+{
+    SimTK::PolygonalMesh mesh;
+    std::ifstream file;
     file.open(filename.c_str());
     if (file.fail()){
         throw Exception("Error loading mesh file: "+filename+". "
@@ -114,14 +123,18 @@ SimTK::ContactGeometry::TriangleMesh* ContactMesh::
     }
     file.close();
     mesh.loadFile(filename);
-    _decorativeGeometry.reset(new SimTK::DecorativeMesh(mesh));
-    return new SimTK::ContactGeometry::TriangleMesh(mesh);
+    return mesh;
 }
 
 SimTK::ContactGeometry ContactMesh::createSimTKContactGeometry() const
 {
-    if (!_geometry)
-        _geometry.reset(loadMesh(get_filename()));
+    // Keep a mesh that was loaded (possibly by the object this one was copied
+    // from) from the same file.
+    const std::string path = resolveMeshPath(get_filename());
+    if (!_geometry || _geometryPath != path) {
+        _geometry.reset(loadMesh(path));
+        _geometryPath = path;
+    }
     return *_geometry;
 }
 
@@ -137,8 +150,14 @@ void ContactMesh::generateDecorations(bool fixed, const ModelDisplayHints& hints
     if (fixed) { return; }
 
     // Guard against the case where the Force was disabled or mesh failed to load.
-    if (_decorativeGeometry == nullptr) return;
+    if (_geometry == nullptr) return;
     if (!hints.get_show_contact_geometry()) return;
+    // A mesh shared with the object this one was copied from does not come
+    // with decorative geometry; read it now.
+    if (_decorativeGeometry == nullptr) {
+        _decorativeGeometry.reset(
+                new SimTK::DecorativeMesh(loadPolygonalMesh(_geometryPath)));
+    }
     // B: base Frame (Body or Ground)
     // F: PhysicalFrame that this ContactGeometry is connected to
     // P: the frame defined (relative to F) by the location and orientation
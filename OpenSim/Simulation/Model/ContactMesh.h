@@ -102,17 +102,28 @@ private:
     // INITIALIZATION
     void setNull();
     void constructProperties();
-    void extendFinalizeFromProperties() override;
 
     /** Load the mesh from a file.
     @param filename   string containing the file to be loaded
     @return SimTK::ContactGeometry::TriangleMesh* heap allocated Contact mesh */
     SimTK::ContactGeometry::TriangleMesh* loadMesh(const std::string& filename) const;
+    /** Get the absolute path of a mesh file, resolving relative paths with
+    respect to the directory containing the model file. */
+    std::string resolveMeshPath(const std::string& filename) const;
+    /** Read the mesh file at an absolute path. */
+    SimTK::PolygonalMesh loadPolygonalMesh(const std::string& filename) const;
 //=============================================================================
 // DATA
 //=============================================================================
-    mutable SimTK::ResetOnCopy<std::unique_ptr<SimTK::ContactGeometry::TriangleMesh>>
+    // The triangle mesh (and its bounding-volume tree) is immutable once
+    // loaded, so copies of this ContactMesh (e.g., in a cloned Model) share
+    // it instead of reading the file and rebuilding the tree again.
+    // _geometryPath is the absolute path of the file from which _geometry
+    // was loaded; the same filename property may refer to different files
+    // for models in different directories.
+    mutable std::shared_ptr<const SimTK::ContactGeometry::TriangleMesh>
         _geometry;
+    mutable std::string _geometryPath;
     mutable SimTK::ResetOnCopy<std::unique_ptr<SimTK::DecorativeMesh>>
         _decorativeGeometry;
 
@@ -28,6 +28,8 @@
 
 #include "simbody/internal/ElasticFoundationForce.h"
 
+#include <atomic>
+
 namespace OpenSim {
 
 //==============================================================================
@@ -59,6 +61,8 @@ void ElasticFoundationForce::extendAddToSystem(SimTK::MultibodySystem& system) c
     SimTK::ContactSetIndex set = contacts.createContactSet();
     SimTK::ElasticFoundationForce force(_model->updForceSubsystem(), contacts, set);
     force.setTransitionVelocity(transitionVelocity);
+    std::vector<SimTK::MobilizedBodyIndex> mobods;
+    std::vector<bool> isMesh;
     for (int i = 0; i < contactParametersSet.getSize(); ++i)
     {
         ContactParameters& params = contactParametersSet.get(i);
@@ -83,7 +87,9 @@ void ElasticFoundationForce::extendAddToSystem(SimTK::MultibodySystem& system) c
             const auto X_BP = X_BF * X_FP;
             contacts.addBody(set, geom.getFrame().getMobilizedBody(),
                     geom.createSimTKContactGeometry(), X_BP);
-            if (dynamic_cast<const ContactMesh*>(&geom) != NULL) {
+            mobods.push_back(geom.getFrame().getMobilizedBodyIndex());
+            isMesh.push_back(dynamic_cast<const ContactMesh*>(&geom) != NULL);
+            if (isMesh.back()) {
                 force.setBodyParameters(
                         SimTK::ContactSurfaceIndex(contacts.getNumBodies(set)-1), 
                         params.getStiffness(), params.getDissipation(),
@@ -94,6 +100,27 @@ void ElasticFoundationForce::extendAddToSystem(SimTK::MultibodySystem& system) c
         }
     }
 
+    // The contact subsystem tests every pair of geometries in the set, but
+    // pairs fixed to the same body, and pairs without a mesh (which this
+    // force ignores), cannot produce a net force. We warn about such pairs
+    // once per process, since the system is often recreated.
+    int numUselessPairs = 0;
+    for (int i = 0; i < (int)mobods.size(); ++i)
+        for (int j = 0; j < i; ++j)
+            if (mobods[i] == mobods[j] || !(isMesh[i] || isMesh[j]))
+                ++numUselessPairs;
+    static std::atomic<bool> warnedAboutUselessPairs{false};
+    if (numUselessPairs > 0 && !warnedAboutUselessPairs.exchange(true)) {
+        log_warn("ElasticFoundationForce '{}': {} of its {} pairs of contact "
+                 "geometries are fixed to the same body or include no "
+                 "ContactMesh, so they cannot produce a net force. Consider "
+                 "using a separate ElasticFoundationForce for each group of "
+                 "geometries that can touch. This warning is shown only "
+                 "once.",
+                getName(), numUselessPairs,
+                mobods.size() * (mobods.size() - 1) / 2);
+    }
+
     // Beyond the const Component get the index so we can access the SimTK::Force later
     ElasticFoundationForce* mutableThis = const_cast<ElasticFoundationForce *>(this);
     mutableThis->_index = force.getForceIndex();
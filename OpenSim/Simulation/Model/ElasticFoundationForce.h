@@ -36,6 +36,17 @@ places a spring at the center of each face of each ContactMesh it acts on.
 Those springs interact with all objects (both meshes and other objects) the 
 mesh comes in contact with.
 
+Contact is detected by Simbody for every pair of geometries of this force
+whenever the positions change, whether or not the force is needed. Pairs
+whose bounding spheres do not overlap are skipped cheaply, and each mesh
+keeps a bounding-volume tree of its faces, so the cost is dominated by
+pairs of meshes that are close. Pairs fixed to the same body, and pairs
+without a ContactMesh, cannot produce a net force; to avoid detecting
+contact between them, use one ElasticFoundationForce for each group of
+geometries that can touch (their number is logged at the debug level).
+Meshes that include only the surfaces that can touch (e.g., articular
+cartilage) are much cheaper than meshes of entire bones.
+
 @author Peter Eastman **/
 class OSIMSIMULATION_API ElasticFoundationForce : public Force {
 OpenSim_DECLARE_CONCRETE_OBJECT(ElasticFoundationForce, Force);
@@ -208,6 +208,15 @@ void ExpressionBasedBushingForce::extendFinalizeFromProperties()
     setFyExpression(get_Fy_expression());
     setFzExpression(get_Fz_expression());
 
+    // Compile the 6 expressions into one program, so that subexpressions
+    // shared by the expressions are evaluated once, along with their
+    // derivatives for calcStiffnessMatrix().
+    _stiffnessExpressions = CompiledExpressions(
+            {get_Mx_expression(), get_My_expression(), get_Mz_expression(),
+             get_Fx_expression(), get_Fy_expression(), get_Fz_expression()},
+            {"theta_x", "theta_y", "theta_z", "delta_x", "delta_y", "delta_z"},
+            true);
+
     // fill damping matrix with damping from vector property
     for (int i = 0; i<3; i++) {
         _dampingMatrix[i][i] = get_rotational_damping(0)[i];
@@ -215,59 +224,65 @@ void ExpressionBasedBushingForce::extendFinalizeFromProperties()
     }
 }
 
-/** Set the expression for the Mx function and create it's lepton program */
-void ExpressionBasedBushingForce::setMxExpression(std::string expression) 
+void ExpressionBasedBushingForce::extendAddToSystem(
+        SimTK::MultibodySystem& system) const
+{
+    Super::extendAddToSystem(system);
+    // Scratch memory; its validity is not used.
+    _workspaceCV = addCacheVariable("expression_workspace",
+            _stiffnessExpressions.createWorkspace(), SimTK::Stage::Topology);
+}
+
+// Remove whitespace from an expression, and parse it to report syntax errors
+// when the expression is set rather than when the model is finalized.
+static std::string stripAndValidateExpression(std::string expression)
 {
     expression.erase( remove_if(expression.begin(), expression.end(), ::isspace), 
                         expression.end() );
-    set_Mx_expression(expression);
-    MxProg = Lepton::Parser::parse(expression).optimize().createProgram();
+    Lepton::Parser::parse(expression);
+    return expression;
 }
 
-/** Set the expression for the My function and create it's lepton program */
+/** Set the expression for the Mx function; it is compiled in
+    extendFinalizeFromProperties(). */
+void ExpressionBasedBushingForce::setMxExpression(std::string expression) 
+{
+    set_Mx_expression(stripAndValidateExpression(expression));
+}
+
+/** Set the expression for the My function; it is compiled in
+    extendFinalizeFromProperties(). */
 void ExpressionBasedBushingForce::setMyExpression(std::string expression) 
 {
-    
-    expression.erase( remove_if(expression.begin(), expression.end(), ::isspace), 
-                        expression.end() );
-    set_My_expression(expression);
-    MyProg = Lepton::Parser::parse(expression).optimize().createProgram();
+    set_My_expression(stripAndValidateExpression(expression));
 }
 
-/** Set the expression for the Mz function and create it's lepton program */
+/** Set the expression for the Mz function; it is compiled in
+    extendFinalizeFromProperties(). */
 void ExpressionBasedBushingForce::setMzExpression(std::string expression) 
 {
-    expression.erase( remove_if(expression.begin(), expression.end(), ::isspace), 
-                        expression.end() );
-    set_Mz_expression(expression);
-    MzProg = Lepton::Parser::parse(expression).optimize().createProgram();
+    set_Mz_expression(stripAndValidateExpression(expression));
 }
 
-/** Set the expression for the Fx function and create it's lepton program */
+/** Set the expression for the Fx function; it is compiled in
+    extendFinalizeFromProperties(). */
 void ExpressionBasedBushingForce::setFxExpression(std::string expression) 
 {
-    expression.erase( remove_if(expression.begin(), expression.end(), ::isspace), 
-                        expression.end() );
-    set_Fx_expression(expression);
-    FxProg = Lepton::Parser::parse(expression).optimize().createProgram();
+    set_Fx_expression(stripAndValidateExpression(expression));
 }
 
-/** Set the expression for the Fy function and create it's lepton program */
+/** Set the expression for the Fy function; it is compiled in
+    extendFinalizeFromProperties(). */
 void ExpressionBasedBushingForce::setFyExpression(std::string expression) 
 {
-    expression.erase( remove_if(expression.begin(), expression.end(), ::isspace), 
-                        expression.end() );
-    set_Fy_expression(expression);
-    FyProg = Lepton::Parser::parse(expression).optimize().createProgram();
+    set_Fy_expression(stripAndValidateExpression(expression));
 }
 
-/** Set the expression for the Fz function and create it's lepton program */
+/** Set the expression for the Fz function; it is compiled in
+    extendFinalizeFromProperties(). */
 void ExpressionBasedBushingForce::setFzExpression(std::string expression) 
 {
-    expression.erase( remove_if(expression.begin(), expression.end(), ::isspace), 
-                        expression.end() );
-    set_Fz_expression(expression);
-    FzProg = Lepton::Parser::parse(expression).optimize().createProgram();
+    set_Fz_expression(stripAndValidateExpression(expression));
 }
 //=============================================================================
 // COMPUTATION
@@ -280,25 +295,33 @@ SimTK::Vec6 ExpressionBasedBushingForce::
     // the deviation of the two frames measured by dq
     Vec6 dq = computeDeflection(s);
 
-    Vec6 fk = Vec6(0.0);
-
-    std::map<std::string, double> deflectionVars;
-    deflectionVars["theta_x"] = dq[0];
-    deflectionVars["theta_y"] = dq[1];
-    deflectionVars["theta_z"] = dq[2];
-    deflectionVars["delta_x"] = dq[3];
-    deflectionVars["delta_y"] = dq[4];
-    deflectionVars["delta_z"] = dq[5];
+    auto& workspace = updCacheVariableValue(s, _workspaceCV);
+    _stiffnessExpressions.evaluate(&dq[0], workspace);
+    Vec6 fk;
+    for (int i = 0; i < 6; ++i) {
+        fk[i] = _stiffnessExpressions.getValue(workspace, i);
+    }
 
+    return -fk;
+}
 
-    fk[0] = MxProg.evaluate(deflectionVars);
-    fk[1] = MyProg.evaluate(deflectionVars);
-    fk[2] = MzProg.evaluate(deflectionVars);
-    fk[3] = FxProg.evaluate(deflectionVars);
-    fk[4] = FyProg.evaluate(deflectionVars);
-    fk[5] = FzProg.evaluate(deflectionVars);
+/* Calculate the derivative of the expressions with respect to the
+   deflection. */
+SimTK::Mat66 ExpressionBasedBushingForce::
+    calcStiffnessMatrix(const SimTK::State& s) const
+{
+    Vec6 dq = computeDeflection(s);
 
-    return -fk;
+    auto& workspace = updCacheVariableValue(s, _workspaceCV);
+    _stiffnessExpressions.evaluate(&dq[0], workspace, true);
+    Mat66 stiffness;
+    for (int i = 0; i < 6; ++i) {
+        for (int j = 0; j < 6; ++j) {
+            stiffness[i][j] =
+                    _stiffnessExpressions.getDerivative(workspace, i, j);
+        }
+    }
+    return stiffness;
 }
 
 /* Calculate the bushing force contribution due to its damping. */
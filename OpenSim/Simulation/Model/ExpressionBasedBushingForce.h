@@ -27,6 +27,7 @@
 // INCLUDE
 #include "Force.h"
 #include <OpenSim/Simulation/Model/TwoFrameLinker.h>
+#include "CompiledExpressions.h"
 
 namespace OpenSim {
 
@@ -222,6 +223,16 @@ public:
         on frame2 from frame1 in the basis of the deflection (dq). */
     SimTK::Vec6 calcStiffnessForce(const SimTK::State& state) const;
 
+    /** Calculate the stiffness of the bushing: the partial derivatives of
+        the expressions (Mx, My, Mz, Fx, Fy, Fz; rows) with respect to the
+        deflections (theta_x, theta_y, theta_z, delta_x, delta_y, delta_z;
+        columns), at the current deflection between the bushing frames. The
+        derivatives are obtained by symbolically differentiating the
+        expressions when the properties are finalized. For small changes in
+        the deflection, the change in calcStiffnessForce() is the negative of
+        this matrix times the change in deflection. */
+    SimTK::Mat66 calcStiffnessMatrix(const SimTK::State& state) const;
+
     /** Calculate the bushing force contribution due to its damping. This is a
         function of the deflection rate between the bushing frames. It is the 
         force on frame2 from frame1 in the basis of the deflection rate (dqdot).*/
@@ -266,14 +277,18 @@ private:
     // Implement ModelComponent interface.
     //--------------------------------------------------------------------------
     void extendFinalizeFromProperties() override;
+    void extendAddToSystem(SimTK::MultibodySystem& system) const override;
 
     void setNull();
     void constructProperties();
 
     SimTK::Mat66 _dampingMatrix{ 0.0 };
 
-    // parser programs for efficiently evaluating the expressions
-    Lepton::ExpressionProgram MxProg, MyProg, MzProg, FxProg, FyProg, FzProg;
+    // The 6 expressions (Mx, My, Mz, Fx, Fy, Fz), compiled with their
+    // derivatives as functions of the 6 deflections (in the order of dq).
+    CompiledExpressions _stiffnessExpressions;
+    // Each State has its own workspace for evaluating the expressions.
+    mutable CacheVariable<CompiledExpressions::Workspace> _workspaceCV;
 
 //==============================================================================
 };  // END of class ExpressionBasedBushingForce
@@ -26,8 +26,6 @@
 //=============================================================================
 #include "ExpressionBasedCoordinateForce.h"
 #include <OpenSim/Simulation/Model/Model.h>
-#include <lepton/Parser.h>
-#include <lepton/ParsedExpression.h>
 
 using namespace OpenSim;
 using namespace std;
@@ -82,6 +80,21 @@ void ExpressionBasedCoordinateForce::constructProperties()
     constructProperty_expression( zero );
 }
 
+//=============================================================================
+// Compile the expression, with q and qdot bound to fixed slots.
+//=============================================================================
+void ExpressionBasedCoordinateForce::extendFinalizeFromProperties()
+{
+    Super::extendFinalizeFromProperties();
+
+    string& expression = upd_expression();
+    expression.erase(
+            remove_if(expression.begin(), expression.end(), ::isspace), 
+                      expression.end() );
+
+    _forceExpression = CompiledExpressions({expression}, {"q", "qdot"});
+}
+
 //=============================================================================
 // Connect this force element to the rest of the model.
 //=============================================================================
@@ -92,13 +105,6 @@ void ExpressionBasedCoordinateForce::extendConnectToModel(Model& aModel)
     string errorMessage;
     const string& coordName = get_coordinate();
 
-    string& expression = upd_expression();
-    expression.erase(
-            remove_if(expression.begin(), expression.end(), ::isspace), 
-                      expression.end() );
-    
-    _forceProg = Lepton::Parser::parse(expression).optimize().createProgram();
-
     // Look up the coordinate
     if (!_model->updCoordinateSet().contains(coordName)) {
         errorMessage = "ExpressionBasedCoordinateForce: Invalid coordinate (" + coordName + ") specified in " + getName();
@@ -118,6 +124,9 @@ void ExpressionBasedCoordinateForce::
 {
     Super::extendAddToSystem(system);    // Base class first.
     this->_forceMagnitudeCV = addCacheVariable("force_magnitude", 0.0, SimTK::Stage::Velocity);
+    // Scratch memory; its validity is not used.
+    this->_workspaceCV = addCacheVariable("expression_workspace",
+            _forceExpression.createWorkspace(), SimTK::Stage::Topology);
 }
 
 //=============================================================================
@@ -135,12 +144,10 @@ void ExpressionBasedCoordinateForce::computeForce(const SimTK::State& s,
 double ExpressionBasedCoordinateForce::calcExpressionForce(const SimTK::State& s ) const
 {
     using namespace SimTK;
-    double q = _coord->getValue(s);
-    double qdot = _coord->getSpeedValue(s);
-    std::map<std::string, double> forceVars;
-    forceVars["q"] = q;
-    forceVars["qdot"] = qdot;
-    double forceMag = _forceProg.evaluate(forceVars);
+    const double forceVars[] = {_coord->getValue(s), _coord->getSpeedValue(s)};
+    auto& workspace = updCacheVariableValue(s, _workspaceCV);
+    _forceExpression.evaluate(forceVars, workspace);
+    double forceMag = _forceExpression.getValue(workspace, 0);
     setCacheVariableValue(s, _forceMagnitudeCV, forceMag);
     return forceMag;
 }
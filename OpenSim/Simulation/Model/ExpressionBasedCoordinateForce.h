@@ -24,7 +24,7 @@
  * -------------------------------------------------------------------------- */
 // INCLUDE
 #include "Force.h"
-#include <lepton/ExpressionProgram.h>
+#include "CompiledExpressions.h"
 
 namespace OpenSim {
 
@@ -118,6 +118,7 @@ protected:
 //==============================================================================
 // ModelComponent interface
 //==============================================================================
+    void extendFinalizeFromProperties() override;
     void extendConnectToModel(Model& model) override;
     void extendAddToSystem(SimTK::MultibodySystem& system) const override;
 
@@ -126,8 +127,10 @@ private:
     void setNull();
     void constructProperties();
 
-    // parser programs for efficiently evaluating the expressions
-    Lepton::ExpressionProgram _forceProg;
+    // The compiled expression, a function of q and qdot (in that order).
+    CompiledExpressions _forceExpression;
+    // Each State has its own workspace for evaluating the expression.
+    mutable CacheVariable<CompiledExpressions::Workspace> _workspaceCV;
 
     // Corresponding generalized coordinate to which the force
     // is applied.
@@ -26,8 +26,6 @@
 //=============================================================================
 #include "ExpressionBasedPointToPointForce.h"
 #include <OpenSim/Simulation/Model/Model.h>
-#include <lepton/Parser.h>
-#include <lepton/ParsedExpression.h>
 
 using namespace OpenSim;
 using namespace std;
@@ -105,6 +103,21 @@ void ExpressionBasedPointToPointForce::constructProperties()
     constructProperty_expression( zero );
 }
 
+//=============================================================================
+// Compile the expression, with d and ddot bound to fixed slots.
+//=============================================================================
+void ExpressionBasedPointToPointForce::extendFinalizeFromProperties()
+{
+    Super::extendFinalizeFromProperties();
+
+    string& expression = upd_expression();
+    expression.erase(
+            remove_if(expression.begin(), expression.end(), ::isspace), 
+                      expression.end() );
+
+    _forceExpression = CompiledExpressions({expression}, {"d", "ddot"});
+}
+
 //=============================================================================
 // Connect this force element to the rest of the model.
 //=============================================================================
@@ -131,13 +144,6 @@ void ExpressionBasedPointToPointForce::extendConnectToModel(Model& model)
 
     if(getName() == "")
         setName("expressionP2PForce_"+body1Name+"To"+body2Name);
-
-    string& expression = upd_expression();
-    expression.erase(
-            remove_if(expression.begin(), expression.end(), ::isspace), 
-                      expression.end() );
-    
-    _forceProg = Lepton::Parser::parse(expression).optimize().createProgram();
 }
 
 //=============================================================================
@@ -149,6 +155,9 @@ extendAddToSystem(SimTK::MultibodySystem& system) const
     Super::extendAddToSystem(system);    // Base class first.
 
     this->_forceMagnitudeCV = addCacheVariable("force_magnitude", 0.0, SimTK::Stage::Velocity);
+    // Scratch memory; its validity is not used.
+    this->_workspaceCV = addCacheVariable("expression_workspace",
+            _forceExpression.createWorkspace(), SimTK::Stage::Topology);
 
     // Beyond the const Component get access to underlying SimTK elements
     ExpressionBasedPointToPointForce* mutableThis =
@@ -187,11 +196,10 @@ void ExpressionBasedPointToPointForce::computeForce(const SimTK::State& s,
     //speed along the line connecting the two bodies
     const double ddot = dot(vRel, r_G)/d;
 
-    std::map<std::string, double> forceVars;
-    forceVars["d"] = d;
-    forceVars["ddot"] = ddot;
-
-    double forceMag = _forceProg.evaluate(forceVars);
+    const double forceVars[] = {d, ddot};
+    auto& workspace = updCacheVariableValue(s, _workspaceCV);
+    _forceExpression.evaluate(forceVars, workspace);
+    double forceMag = _forceExpression.getValue(workspace, 0);
     setCacheVariableValue(s, _forceMagnitudeCV, forceMag);
 
     const Vec3 f1_G = (forceMag/d) * r_G;
@@ -24,7 +24,7 @@
  * -------------------------------------------------------------------------- */
 
 #include "Force.h"
-#include <lepton/ExpressionProgram.h>
+#include "CompiledExpressions.h"
 
 namespace SimTK {
 class MobilizedBody;
@@ -162,6 +162,7 @@ protected:
     //-----------------------------------------------------------------------------
     // ModelComponent interface
     //-----------------------------------------------------------------------------
+    void extendFinalizeFromProperties() override;
     void extendConnectToModel(Model& model) override;
     void extendAddToSystem(SimTK::MultibodySystem& system) const override;
 
@@ -169,8 +170,10 @@ private:
     void setNull();
     void constructProperties();
 
-    // parser programs for efficiently evaluating the expressions
-    Lepton::ExpressionProgram _forceProg;
+    // The compiled expression, a function of d and ddot (in that order).
+    CompiledExpressions _forceExpression;
+    // Each State has its own workspace for evaluating the expression.
+    mutable CacheVariable<CompiledExpressions::Workspace> _workspaceCV;
 
     // Temporary solution until implemented with Sockets
     SimTK::ReferencePtr<const PhysicalFrame> _body1;
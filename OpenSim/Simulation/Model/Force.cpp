@@ -89,7 +89,11 @@ void Force::extendAddToSystem(SimTK::MultibodySystem& system) const
 {
     Super::extendAddToSystem(system);
 
-    ForceAdapter* adapter = new ForceAdapter(*this);
+    // If requested, the Model computes this force along with other forces on
+    // multiple threads (see Model::extendAddToSystemAfterSubcomponents()).
+    const bool computedInParallel =
+            _model->getNumForceThreads() != 1 && shouldBeParallelized();
+    ForceAdapter* adapter = new ForceAdapter(*this, computedInParallel);
     SimTK::Force::Custom force(_model->updForceSubsystem(), adapter);
 
      // Beyond the const Component get the index so we can access the SimTK::Force later
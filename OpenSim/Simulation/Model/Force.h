@@ -65,12 +65,15 @@ public:
 //=============================================================================
 
     /**
-    * Tell SimBody to parallelize this force. Should be 
-    * set to true for any forces that will take time to 
-    * complete their calcForce method. Note that all forces
-    * that set this flag to false will be put in series on a
-    * thread that is running in parallel with other forces
-    * that marked this flag as true.
+    * Return true if this force's computeForce() may be invoked concurrently
+    * with that of other forces, and if it takes long enough to be worth doing
+    * so. If Model::setNumForceThreads() requests more than one thread, the
+    * Model computes all such forces on multiple threads. The force must then
+    * only write to the body and generalized forces passed to computeForce()
+    * and to its own cache variables (or those of its subcomponents). The
+    * Model computes its controls and the transforms and velocities in ground
+    * of all Frame%s (which are cached lazily) before computing the forces in
+    * parallel; any other shared cache must not be written by the force.
     */
     virtual bool shouldBeParallelized() const
     {
@@ -229,6 +232,7 @@ private:
     void constructProperties();
 
     friend class ForceAdapter;
+    friend class ParallelForceAdapter;
 
 //=============================================================================
 };  // END of class Force
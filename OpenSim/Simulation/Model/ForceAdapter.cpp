@@ -25,6 +25,9 @@
 // INCLUDES
 //=============================================================================
 #include "ForceAdapter.h"
+#include "Model.h"
+
+#include <algorithm>
 
 //=============================================================================
 // STATICS
@@ -35,7 +38,8 @@ using SimTK::Vec3;
 //=============================================================================
 // CONSTRUCTOR(S) AND DESTRUCTOR
 //=============================================================================
-ForceAdapter::ForceAdapter(const Force& force) : _force(&force)
+ForceAdapter::ForceAdapter(const Force& force, bool computedInParallel) :
+    _force(&force), _computedInParallel(computedInParallel)
 {
 }
 
@@ -46,6 +50,8 @@ void ForceAdapter::calcForce(const SimTK::State& state,
     SimTK::Vector_<SimTK::SpatialVec>& bodyForces,SimTK::Vector_<SimTK::Vec3>& particleForces,
     SimTK::Vector& mobilityForces) const
 {
+    // The ParallelForceAdapter applies this force.
+    if (_computedInParallel) return;
     _force->computeForce(state, bodyForces, mobilityForces);
 }
 
@@ -55,5 +61,115 @@ SimTK::Real ForceAdapter::calcPotentialEnergy(const SimTK::State& state) const
 }
 
 bool ForceAdapter::shouldBeParallelized() const {
-    return _force->shouldBeParallelized(); 
-}
\ No newline at end of file
+    // Forces that can be computed concurrently are computed on multiple
+    // threads by the ParallelForceAdapter, which first computes the lazily
+    // evaluated quantities that the forces share (e.g., the model controls
+    // and the transforms of Frames).
+    // Simbody does not know to do so, so we do not let it parallelize.
+    return false;
+}
+
+//=============================================================================
+// PARALLEL FORCE ADAPTER
+//=============================================================================
+// Computes the forces in one chunk (a contiguous range of forces) into that
+// chunk's accumulators.
+class ParallelForceAdapter::ComputeForcesTask
+        : public SimTK::ParallelExecutor::Task {
+public:
+    ComputeForcesTask(const SimTK::State& state,
+            const std::vector<const Force*>& forces, int numChunks,
+            std::vector<SimTK::Vector_<SimTK::SpatialVec>>& bodyForces,
+            std::vector<SimTK::Vector>& mobilityForces) :
+            _state(state), _forces(forces), _numChunks(numChunks),
+            _bodyForces(bodyForces), _mobilityForces(mobilityForces) {}
+    void execute(int ichunk) override {
+        const int numForces = (int)_forces.size();
+        const int begin = ichunk * numForces / _numChunks;
+        const int end = (ichunk + 1) * numForces / _numChunks;
+        auto& bodyForces = _bodyForces[ichunk];
+        auto& mobilityForces = _mobilityForces[ichunk];
+        bodyForces.setToZero();
+        mobilityForces.setToZero();
+        for (int iforce = begin; iforce < end; ++iforce) {
+            computeForce(*_forces[iforce], _state, bodyForces,
+                    mobilityForces);
+        }
+    }
+private:
+    const SimTK::State& _state;
+    const std::vector<const Force*>& _forces;
+    const int _numChunks;
+    std::vector<SimTK::Vector_<SimTK::SpatialVec>>& _bodyForces;
+    std::vector<SimTK::Vector>& _mobilityForces;
+};
+
+void ParallelForceAdapter::computeForce(const Force& force,
+        const SimTK::State& state,
+        SimTK::Vector_<SimTK::SpatialVec>& bodyForces,
+        SimTK::Vector& mobilityForces)
+{
+    force.computeForce(state, bodyForces, mobilityForces);
+}
+
+ParallelForceAdapter::ParallelForceAdapter(const Model& model,
+        std::vector<const Force*> forces, int numThreads) :
+    _model(&model), _forces(std::move(forces))
+{
+    for (const auto& frame : model.getComponentList<Frame>()) {
+        _frames.push_back(&frame);
+    }
+    if (numThreads < 1) {
+        numThreads = SimTK::ParallelExecutor::getNumProcessors();
+    }
+    // A few chunks per thread help balance the load when the forces differ
+    // in cost, while keeping the cost of summing the accumulators small.
+    _numChunks = std::max(1, std::min((int)_forces.size(), 4 * numThreads));
+    _executor.reset(new SimTK::ParallelExecutor(numThreads));
+}
+
+void ParallelForceAdapter::calcForce(const SimTK::State& state,
+    SimTK::Vector_<SimTK::SpatialVec>& bodyForces,SimTK::Vector_<SimTK::Vec3>& particleForces,
+    SimTK::Vector& mobilityForces) const
+{
+    // Determine which forces are enabled here, rather than on the threads.
+    std::vector<const Force*> forces;
+    forces.reserve(_forces.size());
+    for (const Force* force : _forces) {
+        if (force->appliesForce(state)) forces.push_back(force);
+    }
+    if (forces.empty()) return;
+    const int numChunks = std::min((int)forces.size(), _numChunks);
+
+    // Forces share the model's controls and the Frames' transforms and
+    // velocities in ground (e.g., through the path points of muscles on the
+    // same body), all of which are computed lazily into cache variables;
+    // compute them now so that the threads only read them.
+    _model->getControls(state);
+    for (const Frame* frame : _frames) {
+        frame->getTransformInGround(state);
+        frame->getVelocityInGround(state);
+    }
+
+    // Each chunk of forces is added into its own accumulators.
+    std::vector<SimTK::Vector_<SimTK::SpatialVec>> chunkBodyForces(
+            numChunks, SimTK::Vector_<SimTK::SpatialVec>(bodyForces.size()));
+    std::vector<SimTK::Vector> chunkMobilityForces(
+            numChunks, SimTK::Vector(mobilityForces.size()));
+    ComputeForcesTask task(state, forces, numChunks, chunkBodyForces,
+            chunkMobilityForces);
+    _executor->execute(task, numChunks);
+
+    // Sum the chunks in order, so the result does not depend on how the
+    // chunks were scheduled.
+    for (int ichunk = 0; ichunk < numChunks; ++ichunk) {
+        bodyForces += chunkBodyForces[ichunk];
+        mobilityForces += chunkMobilityForces[ichunk];
+    }
+}
+
+SimTK::Real ParallelForceAdapter::calcPotentialEnergy(
+        const SimTK::State& state) const
+{
+    return 0;
+}
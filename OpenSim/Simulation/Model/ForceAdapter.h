@@ -30,13 +30,22 @@
 
 #include <SimTKsimbody.h>
 
+#include <memory>
+#include <vector>
+
 namespace OpenSim {
 
+class Frame;
+
 //=============================================================================
 //=============================================================================
 /**
  * This acts as an adapter to allow a Force or Actuator to be used as a SimTK::Force.
  *
+ * If the Force is computed by a ParallelForceAdapter instead, this adapter
+ * still provides the Force's potential energy and allows enabling and
+ * disabling the Force, but calcForce() does nothing.
+ *
  * @authors Peter Eastman
  */
 class OSIMSIMULATION_API ForceAdapter : public SimTK::Force::Custom::Implementation
@@ -46,13 +55,14 @@ class OSIMSIMULATION_API ForceAdapter : public SimTK::Force::Custom::Implementat
 //=============================================================================
 private:
     const Force* _force;
+    bool _computedInParallel;
 
 //=============================================================================
 // METHODS
 //=============================================================================
 public:
     // CONSTRUCTION AND DESTRUCTION
-    ForceAdapter(const Force& force);
+    ForceAdapter(const Force& force, bool computedInParallel = false);
 
     // CALC FORCES (Called by Simbody)
     void calcForce(const SimTK::State& state,
@@ -69,6 +79,60 @@ public:
     // to OpenSim Force elements.
 };
 
+//=============================================================================
+//=============================================================================
+/**
+ * This adapter computes a group of Forces, whose computeForce() may be invoked
+ * concurrently, on multiple threads. The Forces are split into contiguous
+ * chunks; each chunk is computed into its own body and mobility force
+ * accumulators, and the accumulators are then added to Simbody's, in order.
+ * The Model creates this adapter if Model::setNumForceThreads() requests
+ * more than one thread.
+ *
+ * Before the threads start, the Model's controls and the transforms and
+ * velocities in ground of all Frames are computed, since the Forces share
+ * these lazily evaluated cache variables.
+ *
+ * Disabled Forces are skipped. The potential energy of the Forces is
+ * provided by their own ForceAdapter%s.
+ */
+class OSIMSIMULATION_API ParallelForceAdapter
+        : public SimTK::Force::Custom::Implementation
+{
+//=============================================================================
+// DATA
+//=============================================================================
+private:
+    const Model* _model;
+    std::vector<const Force*> _forces;
+    std::vector<const Frame*> _frames;
+    int _numChunks;
+    std::unique_ptr<SimTK::ParallelExecutor> _executor;
+
+//=============================================================================
+// METHODS
+//=============================================================================
+public:
+    // CONSTRUCTION AND DESTRUCTION
+    /** If numThreads is less than 1, we use one thread per processor. */
+    ParallelForceAdapter(const Model& model, std::vector<const Force*> forces,
+            int numThreads);
+
+    // CALC FORCES (Called by Simbody)
+    void calcForce(const SimTK::State& state,
+        SimTK::Vector_<SimTK::SpatialVec>& bodyForces,SimTK::Vector_<SimTK::Vec3>& particleForces,
+        SimTK::Vector& mobilityForces) const override;
+
+    // CALC POTENTIAL ENERGY (Called by Simbody)
+    SimTK::Real calcPotentialEnergy(const SimTK::State& state) const override;
+
+private:
+    class ComputeForcesTask;
+    static void computeForce(const Force& force, const SimTK::State& state,
+            SimTK::Vector_<SimTK::SpatialVec>& bodyForces,
+            SimTK::Vector& mobilityForces);
+};
+
 } // end of namespace OpenSim
 
 #endif // OPENSIM_FORCE_ADAPTER_H_
@@ -27,6 +27,8 @@
 
 #include "simbody/internal/HuntCrossleyForce.h"
 
+#include <atomic>
+
 namespace OpenSim {
 
 //==============================================================================
@@ -61,6 +63,7 @@ void HuntCrossleyForce::extendAddToSystem(SimTK::MultibodySystem& system) const
     SimTK::ContactSetIndex set = contacts.createContactSet();
     SimTK::HuntCrossleyForce force(_model->updForceSubsystem(), contacts, set);
     force.setTransitionVelocity(transitionVelocity);
+    std::vector<SimTK::MobilizedBodyIndex> mobods;
     for (int i = 0; i < contactParametersSet.getSize(); ++i)
     {
         ContactParameters& params = contactParametersSet.get(i);
@@ -85,6 +88,7 @@ void HuntCrossleyForce::extendAddToSystem(SimTK::MultibodySystem& system) const
             const auto X_BP = X_BF * X_FP;
             contacts.addBody(set, geom.getFrame().getMobilizedBody(),
                     geom.createSimTKContactGeometry(), X_BP);
+            mobods.push_back(geom.getFrame().getMobilizedBodyIndex());
             force.setBodyParameters(
                     SimTK::ContactSurfaceIndex(contacts.getNumBodies(set)-1),
                     params.getStiffness(), params.getDissipation(),
@@ -93,6 +97,24 @@ void HuntCrossleyForce::extendAddToSystem(SimTK::MultibodySystem& system) const
         }
     }
 
+    // The contact subsystem tests every pair of geometries in the set, but
+    // pairs fixed to the same body cannot produce a net force. We warn about
+    // such pairs once per process, since the system is often recreated.
+    int numSameBodyPairs = 0;
+    for (int i = 0; i < (int)mobods.size(); ++i)
+        for (int j = 0; j < i; ++j)
+            if (mobods[i] == mobods[j]) ++numSameBodyPairs;
+    static std::atomic<bool> warnedAboutSameBodyPairs{false};
+    if (numSameBodyPairs > 0 && !warnedAboutSameBodyPairs.exchange(true)) {
+        log_warn("HuntCrossleyForce '{}': {} of its {} pairs of contact "
+                 "geometries are fixed to the same body, so they cannot "
+                 "produce a net force. Consider using a separate "
+                 "HuntCrossleyForce for each group of geometries that can "
+                 "touch. This warning is shown only once.",
+                getName(), numSameBodyPairs,
+                mobods.size() * (mobods.size() - 1) / 2);
+    }
+
     // Beyond the const Component get the index so we can access the
     // SimTK::Force later.
     HuntCrossleyForce* mutableThis = const_cast<HuntCrossleyForce *>(this);
@@ -35,6 +35,12 @@ namespace OpenSim {
 contact theory to model the interactions between a set of ContactSpheres and 
 ContactHalfSpaces.
 
+Contact is detected by Simbody for every pair of geometries of this force
+whenever the positions change; pairs whose bounding spheres do not overlap
+are skipped cheaply. Pairs fixed to the same body cannot produce a net
+force; to avoid testing them, use one HuntCrossleyForce for each group of
+geometries that can touch (their number is logged at the debug level).
+
 @author Peter Eastman **/
 class OSIMSIMULATION_API HuntCrossleyForce : public Force {
 OpenSim_DECLARE_CONCRETE_OBJECT(HuntCrossleyForce, Force);
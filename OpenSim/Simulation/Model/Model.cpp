@@ -33,6 +33,7 @@
 #include "BodySet.h"
 #include "ComponentSet.h"
 #include "ContactGeometrySet.h"
+#include "ForceAdapter.h"
 #include "ControllerSet.h"
 #include "CoordinateSet.h"
 #include "ForceSet.h"
@@ -1012,6 +1013,28 @@ void Model::extendAddToSystem(SimTK::MultibodySystem& system) const
     mutableThis->_modelControlsIndex = modelControls.getSubsystemMeasureIndex();
 }
 
+void Model::extendAddToSystemAfterSubcomponents(
+        SimTK::MultibodySystem& system) const
+{
+    Super::extendAddToSystemAfterSubcomponents(system);
+
+    if (getNumForceThreads() == 1) return;
+
+    // Forces that can be computed concurrently did not apply themselves
+    // (see Force::extendAddToSystem()); compute them all in one
+    // SimTK::Force that distributes them among threads.
+    std::vector<const Force*> forces;
+    for (const auto& force : getComponentList<Force>()) {
+        if (force.shouldBeParallelized()) forces.push_back(&force);
+    }
+    if (forces.empty()) return;
+    log_debug("Model '{}': computing {} forces on multiple threads.",
+            getName(), forces.size());
+    Model* mutableThis = const_cast<Model*>(this);
+    SimTK::Force::Custom(mutableThis->updForceSubsystem(),
+            new ParallelForceAdapter(*this, forces, getNumForceThreads()));
+}
+
 
 // Add any Component derived from ModelComponent to the Model
 void Model::addModelComponent(ModelComponent* component)
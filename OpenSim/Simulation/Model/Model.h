@@ -514,6 +514,22 @@ public:
     SimTK::GeneralForceSubsystem& updForceSubsystem() 
     {   return *_forceSubsystem; }
 
+    /** Compute the Force%s that support it (those for which
+    Force::shouldBeParallelized() returns true, e.g., Muscle%s) on multiple
+    threads when realizing to Stage::Dynamics. Each thread adds its forces to
+    its own body and mobility force accumulators, and the accumulators are
+    summed once all forces have been computed. Other forces are still computed
+    serially. The default is 1 (all forces computed serially); use a value
+    less than 1 to use one thread per processor. Parallel evaluation pays off
+    for models with many expensive forces (e.g., muscles with wrapping
+    surfaces); forces are summed in a different order than in serial, so
+    results can differ at the level of roundoff. The setting takes effect at
+    the next call to initSystem(). **/
+    void setNumForceThreads(int numThreads) {_numForceThreads = numThreads;}
+    /** Return the number of threads used to compute forces, as set with
+    setNumForceThreads(). **/
+    int getNumForceThreads() const {return _numForceThreads;}
+
     /**@}**/
 
     /**@name  Realize the Simbody System and State to Computational Stage
@@ -1053,6 +1069,8 @@ public:
 
     void extendConnectToModel(Model& model)  override;
     void extendAddToSystem(SimTK::MultibodySystem& system) const override; 
+    void extendAddToSystemAfterSubcomponents(
+            SimTK::MultibodySystem& system) const override;
     void extendInitStateFromProperties(SimTK::State& state) const override;
     /**@}**/
 
@@ -1095,6 +1113,8 @@ private:
 
     // To provide access to private _modelComponents member.
     friend class Component; 
+    // To copy the XML document of a cached Model to its copies.
+    friend class ModelCache;
 
 //==============================================================================
 // DATA MEMBERS
@@ -1165,6 +1185,10 @@ private:
     // Global flag used to disable all Controllers.
     bool _allControllersEnabled;
 
+    // Number of threads used to compute Forces that can be computed in
+    // parallel; see setNumForceThreads().
+    int _numForceThreads = 1;
+
 
     //                      SIMBODY MULTIBODY SYSTEM
     // We dynamically allocate these because they are not available at
@@ -431,6 +431,12 @@ protected:
     /** Potential energy stored by the muscle */
     double computePotentialEnergy(const SimTK::State& state) const override;
 
+    /** Muscles can be computed in parallel (see Model::setNumForceThreads()):
+    besides their own cache variables (and those of their GeometryPath), they
+    only read the model controls and the transforms and velocities of Frame%s,
+    which the Model computes before distributing the forces among threads. */
+    bool shouldBeParallelized() const override { return true; }
+
     /** Override PathActuator virtual to calculate a preferred color for the 
     muscle path based on activation. **/
     SimTK::Vec3 computePathColor(const SimTK::State& state) const override;
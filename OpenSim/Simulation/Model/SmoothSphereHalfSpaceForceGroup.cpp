@@ -0,0 +1,373 @@
+/* -------------------------------------------------------------------------- *
+ *               OpenSim: SmoothSphereHalfSpaceForceGroup.cpp                 *
+ * -------------------------------------------------------------------------- *
+ * The OpenSim API is a toolkit for musculoskeletal modeling and simulation.  *
+ * See http://opensim.stanford.edu and the NOTICE file for more information.  *
+ * OpenSim is developed at Stanford University and supported by the US        *
+ * National Institutes of Health (U54 GM072970, R24 HD065690) and by DARPA    *
+ * through the Warrior Web program.                                           *
+ *                                                                            *
+ * Copyright (c) 2005-2021 Stanford University and the Authors                *
+ * Author(s): OpenSim Team                                                    *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "SmoothSphereHalfSpaceForceGroup.h"
+
+#include "SmoothSphereHalfSpaceForce.h"
+
+#include <OpenSim/Simulation/Model/Model.h>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace OpenSim;
+
+namespace {
+// Columns of the workspace. Each column holds one quantity for all spheres.
+enum WorkspaceColumn {
+    Indentation,
+    IndentationVelocity,
+    SlipVelocityX,
+    SlipVelocityY,
+    SlipVelocityZ,
+    NormalForce,
+    FrictionPerSlipVelocity,
+    NumWorkspaceColumns
+};
+}
+
+//=============================================================================
+//  SMOOTH SPHERE HALF SPACE FORCE GROUP
+//=============================================================================
+SmoothSphereHalfSpaceForceGroup::SmoothSphereHalfSpaceForceGroup() {
+    constructProperties();
+}
+
+SmoothSphereHalfSpaceForceGroup::SmoothSphereHalfSpaceForceGroup(
+        const std::string& name, const ContactHalfSpace& contactHalfSpace) {
+    setName(name);
+    connectSocket_half_space(contactHalfSpace);
+
+    constructProperties();
+}
+
+void SmoothSphereHalfSpaceForceGroup::constructProperties() {
+    constructProperty_spheres();
+    constructProperty_stiffness(1.0);
+    constructProperty_dissipation(0.0);
+    constructProperty_static_friction(0.0);
+    constructProperty_dynamic_friction(0.0);
+    constructProperty_viscous_friction(0.0);
+    constructProperty_transition_velocity(0.01);
+    constructProperty_constant_contact_force(1e-5);
+    constructProperty_hertz_smoothing(300.0);
+    constructProperty_hunt_crossley_smoothing(50.0);
+    constructProperty_force_visualization_radius(0.01);
+    constructProperty_force_visualization_scale_factor();
+}
+
+void SmoothSphereHalfSpaceForceGroup::addSphere(
+        const ContactSphere& contactSphere) {
+    append_spheres(contactSphere.getAbsolutePathString());
+}
+
+void SmoothSphereHalfSpaceForceGroup::setContactParameters(
+        const SmoothSphereHalfSpaceForce& force) {
+    set_stiffness(force.get_stiffness());
+    set_dissipation(force.get_dissipation());
+    set_static_friction(force.get_static_friction());
+    set_dynamic_friction(force.get_dynamic_friction());
+    set_viscous_friction(force.get_viscous_friction());
+    set_transition_velocity(force.get_transition_velocity());
+    set_constant_contact_force(force.get_constant_contact_force());
+    set_hertz_smoothing(force.get_hertz_smoothing());
+    set_hunt_crossley_smoothing(force.get_hunt_crossley_smoothing());
+}
+
+void SmoothSphereHalfSpaceForceGroup::extendConnectToModel(Model& model) {
+    Super::extendConnectToModel(model);
+    m_spheres.clear();
+    for (int i = 0; i < getProperty_spheres().size(); ++i) {
+        const std::string& path = get_spheres(i);
+        OPENSIM_THROW_IF_FRMOBJ(!hasComponent<ContactSphere>(path), Exception,
+                "Could not find ContactSphere '{}'.", path);
+        m_spheres.emplace_back(&getComponent<ContactSphere>(path));
+    }
+}
+
+void SmoothSphereHalfSpaceForceGroup::extendAddToSystem(
+        SimTK::MultibodySystem& system) const {
+    Super::extendAddToSystem(system);
+
+    m_sphereBodies.clear();
+    m_sphereLocationsInBody.clear();
+    m_sphereRadii.clear();
+    for (const auto& sphere : m_spheres) {
+        m_sphereBodies.push_back(sphere->getFrame().getMobilizedBodyIndex());
+        m_sphereLocationsInBody.push_back(
+                sphere->getFrame().findTransformInBaseFrame() *
+                sphere->get_location());
+        m_sphereRadii.push_back(sphere->getRadius());
+    }
+
+    const auto& halfSpace = getConnectee<ContactHalfSpace>("half_space");
+    m_halfSpaceBody = halfSpace.getFrame().getMobilizedBodyIndex();
+    m_halfSpaceFrameInBody = halfSpace.getFrame().findTransformInBaseFrame() *
+                             halfSpace.getTransform();
+
+    const int numSpheres = (int)m_spheres.size();
+    this->m_contactForcesCV = addCacheVariable("contact_forces",
+            SimTK::Vector_<SimTK::Vec3>(numSpheres, SimTK::Vec3(0)),
+            SimTK::Stage::Velocity);
+    this->m_contactPointsCV = addCacheVariable("contact_points",
+            SimTK::Vector_<SimTK::Vec3>(numSpheres, SimTK::Vec3(0)),
+            SimTK::Stage::Velocity);
+    this->m_workspaceCV = addCacheVariable("workspace",
+            SimTK::Matrix(numSpheres, NumWorkspaceColumns, 0.0),
+            SimTK::Stage::Velocity);
+}
+
+void SmoothSphereHalfSpaceForceGroup::extendRealizeInstance(
+        const SimTK::State& state) const {
+    Super::extendRealizeInstance(state);
+    if (!getProperty_force_visualization_scale_factor().empty()) {
+        m_forceVizScaleFactor = get_force_visualization_scale_factor();
+    } else {
+        const Model& model = getModel();
+        const double mass = model.getTotalMass(state);
+        const double weight = mass * model.getGravity().norm();
+        m_forceVizScaleFactor = 1 / weight;
+    }
+}
+
+//=============================================================================
+//  COMPUTATION
+//=============================================================================
+const SimTK::Vector_<SimTK::Vec3>&
+SmoothSphereHalfSpaceForceGroup::getContactForces(
+        const SimTK::State& state) const {
+    if (!isCacheVariableValid(state, m_contactForcesCV)) {
+        calcContactForces(state);
+    }
+    return getCacheVariableValue(state, m_contactForcesCV);
+}
+
+const SimTK::Vector_<SimTK::Vec3>&
+SmoothSphereHalfSpaceForceGroup::getContactPoints(
+        const SimTK::State& state) const {
+    if (!isCacheVariableValid(state, m_contactPointsCV)) {
+        calcContactForces(state);
+    }
+    return getCacheVariableValue(state, m_contactPointsCV);
+}
+
+void SmoothSphereHalfSpaceForceGroup::calcContactForces(
+        const SimTK::State& state) const {
+    using SimTK::Vec3;
+    const int numSpheres = (int)m_sphereBodies.size();
+    auto& forces = updCacheVariableValue(state, m_contactForcesCV);
+    auto& points = updCacheVariableValue(state, m_contactPointsCV);
+    auto& workspace = updCacheVariableValue(state, m_workspaceCV);
+    if (numSpheres == 0) {
+        markCacheVariableValid(state, m_contactForcesCV);
+        markCacheVariableValid(state, m_contactPointsCV);
+        return;
+    }
+
+    // The workspace is a column-major matrix, so each quantity is stored
+    // contiguously.
+    double* indentation = &workspace(0, Indentation);
+    double* indentationVel = &workspace(0, IndentationVelocity);
+    double* slipVelX = &workspace(0, SlipVelocityX);
+    double* slipVelY = &workspace(0, SlipVelocityY);
+    double* slipVelZ = &workspace(0, SlipVelocityZ);
+    double* normalForce = &workspace(0, NormalForce);
+    double* frictionPerSlipVel = &workspace(0, FrictionPerSlipVelocity);
+    const double* radius = m_sphereRadii.data();
+
+    // Gather the kinematics of the contacts.
+    // --------------------------------------
+    const auto& matter = getModel().getMatterSubsystem();
+    const auto& halfSpaceBody = matter.getMobilizedBody(m_halfSpaceBody);
+    const SimTK::Transform& X_GH = halfSpaceBody.getBodyTransform(state);
+    const SimTK::SpatialVec& V_GH = halfSpaceBody.getBodyVelocity(state);
+    const SimTK::Transform X_GP = X_GH * m_halfSpaceFrameInBody;
+    // The half space occupies x > 0 in its frame.
+    const Vec3 normal = X_GP.R() * Vec3(-1, 0, 0);
+    for (int i = 0; i < numSpheres; ++i) {
+        const auto& body = matter.getMobilizedBody(m_sphereBodies[i]);
+        const SimTK::Transform& X_GB = body.getBodyTransform(state);
+        const SimTK::SpatialVec& V_GB = body.getBodyVelocity(state);
+        const Vec3 center = X_GB * m_sphereLocationsInBody[i];
+        indentation[i] = radius[i] - dot(center - X_GP.p(), normal);
+        // The force is applied halfway into the indentation.
+        points[i] = center - (radius[i] - 0.5 * indentation[i]) * normal;
+        const Vec3 velSphere = V_GB[1] + V_GB[0] % (points[i] - X_GB.p());
+        const Vec3 velHalfSpace = V_GH[1] + V_GH[0] % (points[i] - X_GH.p());
+        const Vec3 vel = velSphere - velHalfSpace;
+        const double velNormal = dot(vel, normal);
+        const Vec3 velTangent = vel - velNormal * normal;
+        indentationVel[i] = -velNormal;
+        slipVelX[i] = velTangent[0];
+        slipVelY[i] = velTangent[1];
+        slipVelZ[i] = velTangent[2];
+    }
+
+    // Compute the force magnitudes for all spheres.
+    // ---------------------------------------------
+    const double k = 0.5 * std::pow(get_stiffness(), 2.0 / 3.0);
+    const double c = get_dissipation();
+    const double us = get_static_friction();
+    const double ud = get_dynamic_friction();
+    const double uv = get_viscous_friction();
+    const double vt = get_transition_velocity();
+    const double cf = get_constant_contact_force();
+    const double bd = get_hertz_smoothing();
+    const double bv = get_hunt_crossley_smoothing();
+    for (int i = 0; i < numSpheres; ++i) {
+        const double x = indentation[i];
+        const double xdot = indentationVel[i];
+        // Hertz force, smoothed so that it is nonzero without contact.
+        const double fH = (4.0 / 3.0) * k * std::sqrt(radius[i] * k) *
+                          std::pow(std::sqrt(x * x + cf), 1.5);
+        // Hunt-Crossley force.
+        const double fHd = fH * (1 + 1.5 * c * xdot);
+        const double fn = fHd * (0.5 + 0.5 * std::tanh(bd * x)) *
+                          (0.5 + 0.5 * std::tanh(bv * (xdot + 2 / (3 * c))));
+        // Friction force.
+        const double vslip = std::sqrt(slipVelX[i] * slipVelX[i] +
+                                       slipVelY[i] * slipVelY[i] +
+                                       slipVelZ[i] * slipVelZ[i] + cf);
+        const double vrel = vslip / vt;
+        const double ff =
+                fn * (std::min(vrel, 1.0) *
+                                     (ud + 2 * (us - ud) / (1 + vrel * vrel)) +
+                             uv * vslip);
+        normalForce[i] = fn;
+        frictionPerSlipVel[i] = ff / vslip;
+    }
+
+    for (int i = 0; i < numSpheres; ++i) {
+        forces[i] = normalForce[i] * normal -
+                    frictionPerSlipVel[i] *
+                            Vec3(slipVelX[i], slipVelY[i], slipVelZ[i]);
+    }
+
+    markCacheVariableValid(state, m_contactForcesCV);
+    markCacheVariableValid(state, m_contactPointsCV);
+}
+
+void SmoothSphereHalfSpaceForceGroup::computeForce(const SimTK::State& state,
+        SimTK::Vector_<SimTK::SpatialVec>& bodyForces,
+        SimTK::Vector& generalizedForces) const {
+    const auto& forces = getContactForces(state);
+    const auto& points = getContactPoints(state);
+    const auto& matter = getModel().getMatterSubsystem();
+    // The half space receives the sum of the opposite forces.
+    SimTK::SpatialVec onHalfSpace(SimTK::Vec3(0), SimTK::Vec3(0));
+    const SimTK::Vec3& halfSpaceOrigin =
+            matter.getMobilizedBody(m_halfSpaceBody).getBodyOriginLocation(
+                    state);
+    for (int i = 0; i < (int)m_sphereBodies.size(); ++i) {
+        const SimTK::Vec3& sphereOrigin =
+                matter.getMobilizedBody(m_sphereBodies[i])
+                        .getBodyOriginLocation(state);
+        bodyForces[m_sphereBodies[i]] += SimTK::SpatialVec(
+                (points[i] - sphereOrigin) % forces[i], forces[i]);
+        onHalfSpace[0] += (points[i] - halfSpaceOrigin) % forces[i];
+        onHalfSpace[1] += forces[i];
+    }
+    bodyForces[m_halfSpaceBody] -= onHalfSpace;
+}
+
+//=============================================================================
+//  REPORTING
+//=============================================================================
+OpenSim::Array<std::string>
+SmoothSphereHalfSpaceForceGroup::getRecordLabels() const {
+    OpenSim::Array<std::string> labels("");
+    auto appendLabels = [&](const std::string& prefix) {
+        for (const auto* quantity : {".force", ".torque"}) {
+            for (const auto* axis : {".X", ".Y", ".Z"}) {
+                labels.append(prefix + quantity + axis);
+            }
+        }
+    };
+    for (const auto& sphere : m_spheres) {
+        appendLabels(getName() + "." + sphere->getName());
+    }
+    appendLabels(getName() + ".HalfSpace");
+    return labels;
+}
+
+OpenSim::Array<double> SmoothSphereHalfSpaceForceGroup::getRecordValues(
+        const SimTK::State& state) const {
+    OpenSim::Array<double> values(1);
+
+    const auto& forces = getContactForces(state);
+    const auto& points = getContactPoints(state);
+    const auto& matter = getModel().getMatterSubsystem();
+    SimTK::Vec3 forceOnHalfSpace(0);
+    SimTK::Vec3 torqueOnHalfSpace(0);
+    const SimTK::Vec3& halfSpaceOrigin =
+            matter.getMobilizedBody(m_halfSpaceBody).getBodyOriginLocation(
+                    state);
+    for (int i = 0; i < (int)m_sphereBodies.size(); ++i) {
+        const SimTK::Vec3& sphereOrigin =
+                matter.getMobilizedBody(m_sphereBodies[i])
+                        .getBodyOriginLocation(state);
+        const SimTK::Vec3 torque = (points[i] - sphereOrigin) % forces[i];
+        values.append(3, &forces[i][0]);
+        values.append(3, &torque[0]);
+        forceOnHalfSpace -= forces[i];
+        torqueOnHalfSpace -= (points[i] - halfSpaceOrigin) % forces[i];
+    }
+    values.append(3, &forceOnHalfSpace[0]);
+    values.append(3, &torqueOnHalfSpace[0]);
+
+    return values;
+}
+
+void SmoothSphereHalfSpaceForceGroup::generateDecorations(bool fixed,
+        const ModelDisplayHints& hints, const SimTK::State& state,
+        SimTK::Array_<SimTK::DecorativeGeometry>& geometry) const {
+    Super::generateDecorations(fixed, hints, state, geometry);
+
+    if (!fixed && (state.getSystemStage() >= SimTK::Stage::Dynamics) &&
+            hints.get_show_forces()) {
+        const auto& forces = getContactForces(state);
+        for (int i = 0; i < (int)m_spheres.size(); ++i) {
+            const ContactSphere& sphere = *m_spheres[i];
+
+            // Scale the contact force vector and compute the cylinder length.
+            const SimTK::Vec3 scaledContactForce =
+                    m_forceVizScaleFactor * forces[i];
+            const SimTK::Real length(scaledContactForce.norm());
+
+            // Compute the force visualization transform.
+            const SimTK::Vec3 contactSpherePosition =
+                    sphere.getFrame().findStationLocationInGround(
+                            state, sphere.get_location());
+            const SimTK::Transform forceVizTransform(
+                    SimTK::Rotation(SimTK::UnitVec3(scaledContactForce),
+                            SimTK::YAxis),
+                    contactSpherePosition + scaledContactForce / 2.0);
+
+            SimTK::DecorativeCylinder forceViz(
+                    get_force_visualization_radius(), 0.5 * length);
+            forceViz.setTransform(forceVizTransform);
+            forceViz.setColor(SimTK::Vec3(0.0, 0.6, 0.0));
+            geometry.push_back(forceViz);
+        }
+    }
+}
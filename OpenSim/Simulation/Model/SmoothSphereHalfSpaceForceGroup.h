@@ -0,0 +1,189 @@
+#ifndef OPENSIM_SMOOTH_SPHERE_HALF_SPACE_FORCE_GROUP_H_
+#define OPENSIM_SMOOTH_SPHERE_HALF_SPACE_FORCE_GROUP_H_
+/* -------------------------------------------------------------------------- *
+ *                OpenSim: SmoothSphereHalfSpaceForceGroup.h                  *
+ * -------------------------------------------------------------------------- *
+ * The OpenSim API is a toolkit for musculoskeletal modeling and simulation.  *
+ * See http://opensim.stanford.edu and the NOTICE file for more information.  *
+ * OpenSim is developed at Stanford University and supported by the US        *
+ * National Institutes of Health (U54 GM072970, R24 HD065690) and by DARPA    *
+ * through the Warrior Web program.                                           *
+ *                                                                            *
+ * Copyright (c) 2005-2021 Stanford University and the Authors                *
+ * Author(s): OpenSim Team                                                    *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "Force.h"
+#include "ContactHalfSpace.h"
+#include "ContactSphere.h"
+
+namespace OpenSim {
+
+class SmoothSphereHalfSpaceForce;
+
+/** Contact between many spheres and one half space, using the same smooth
+contact model and the same contact parameters for each sphere as
+SmoothSphereHalfSpaceForce. A model of foot-ground contact usually has a
+dozen or more spheres in contact with the floor; one of these forces can
+replace all of the corresponding SmoothSphereHalfSpaceForce%s.
+
+This force evaluates all of its spheres at once: it computes the contact
+forces for all spheres in one loop and then applies the forces to the bodies
+in one pass. This avoids the overhead of evaluating each sphere as a
+separate Force, which matters in direct collocation, where contact forces
+are computed at every mesh point in every iteration. The contact forces are cached in the State, so reporting
+and visualizing them does not compute them again.
+
+The spheres are identified by their paths in the property `spheres` (see
+addSphere()), and the half space by the socket `half_space`.
+
+@note This force does not compute potential energy.
+@see SmoothSphereHalfSpaceForce */
+class OSIMSIMULATION_API SmoothSphereHalfSpaceForceGroup : public Force {
+    OpenSim_DECLARE_CONCRETE_OBJECT(SmoothSphereHalfSpaceForceGroup, Force);
+
+public:
+    //=========================================================================
+    // PROPERTIES
+    //=========================================================================
+    OpenSim_DECLARE_LIST_PROPERTY(spheres, std::string,
+            "Paths to the ContactSpheres in contact with the half space.");
+    OpenSim_DECLARE_PROPERTY(stiffness, double,
+            "The stiffness constant (i.e., plain strain modulus), "
+            "default is 1 (N/m^2)");
+    OpenSim_DECLARE_PROPERTY(dissipation, double,
+            "The dissipation coefficient, default is 0 (s/m).");
+    OpenSim_DECLARE_PROPERTY(static_friction, double,
+            "The coefficient of static friction, default is 0.");
+    OpenSim_DECLARE_PROPERTY(dynamic_friction, double,
+            "The coefficient of dynamic friction, default is 0.");
+    OpenSim_DECLARE_PROPERTY(viscous_friction, double,
+            "The coefficient of viscous friction, default is 0.");
+    OpenSim_DECLARE_PROPERTY(transition_velocity, double,
+            "The transition velocity, default is 0.01 (m/s).");
+    OpenSim_DECLARE_PROPERTY(constant_contact_force, double,
+            "The constant that enforces non-null derivatives, "
+            "default is 1e-5 (N).");
+    OpenSim_DECLARE_PROPERTY(hertz_smoothing, double,
+            "The parameter that determines the smoothness of the transition "
+            "of the tanh used to smooth the Hertz force. The larger the "
+            "steeper the transition but the worse for optimization, "
+            "default is 300.");
+    OpenSim_DECLARE_PROPERTY(hunt_crossley_smoothing, double,
+            "The parameter that determines the smoothness of the transition "
+            "of the tanh used to smooth the Hunt-Crossley force. The larger "
+            "the steeper the transition but the worse for optimization, "
+            "default is 50.");
+    OpenSim_DECLARE_PROPERTY(force_visualization_radius, double,
+            "The radius of the cylinders that visualize contact "
+            "forces generated by this force component. Default: 0.01 m");
+    OpenSim_DECLARE_OPTIONAL_PROPERTY(force_visualization_scale_factor, double,
+            "(Optional) The scale factor that determines the length of the "
+            "cylinders that visualize contact forces generated by this force "
+            "component. A cylinder will be one meter long when the contact "
+            "force magnitude is equal to this value. If this property is not "
+            "specified, the total weight of the model is used "
+            "as the scale factor.")
+
+    //=========================================================================
+    // SOCKETS
+    //=========================================================================
+    OpenSim_DECLARE_SOCKET(half_space, ContactHalfSpace,
+            "The half-space participating in the contacts.");
+
+    //=========================================================================
+    // PUBLIC METHODS
+    //=========================================================================
+    SmoothSphereHalfSpaceForceGroup();
+
+    SmoothSphereHalfSpaceForceGroup(const std::string& name,
+            const ContactHalfSpace& contactHalfSpace);
+
+    /** Add a sphere in contact with the half space. The sphere must be part
+    of the same model as this force; it is stored by its absolute path. */
+    void addSphere(const ContactSphere& contactSphere);
+    int getNumSpheres() const { return getProperty_spheres().size(); }
+
+    /** Copy the contact parameters (stiffness, dissipation, friction, and
+    smoothing) of a SmoothSphereHalfSpaceForce, so that this force models
+    the same contact for each of its spheres. */
+    void setContactParameters(const SmoothSphereHalfSpaceForce& force);
+
+    /** The contact force applied to each sphere by the half space, expressed
+    in ground, in the order of the `spheres` property. The half space is
+    subject to the opposite forces. */
+    const SimTK::Vector_<SimTK::Vec3>& getContactForces(
+            const SimTK::State& state) const;
+    /** The point (expressed in ground) at which the contact force of each
+    sphere is applied. */
+    const SimTK::Vector_<SimTK::Vec3>& getContactPoints(
+            const SimTK::State& state) const;
+
+    //=========================================================================
+    // REPORTING
+    //=========================================================================
+    /// Obtain names of the quantities (column labels) of the force values to
+    /// be reported. For each sphere, the three forces (XYZ) and three torques
+    /// (XYZ) applied to the sphere's body by its contact, followed by the
+    /// three forces and three torques applied to the half space by all of the
+    /// contacts. Forces and torques are expressed in the ground frame, and
+    /// torques are about the origins of the bodies.
+    OpenSim::Array<std::string> getRecordLabels() const override;
+    /// Obtain the values to be reported that correspond to the labels. The
+    /// values are expressed in the ground frame.
+    OpenSim::Array<double> getRecordValues(
+            const SimTK::State& state) const override;
+
+protected:
+    void extendConnectToModel(Model& model) override;
+    void extendAddToSystem(SimTK::MultibodySystem& system) const override;
+    void extendRealizeInstance(const SimTK::State& state) const override;
+    void computeForce(const SimTK::State& state,
+            SimTK::Vector_<SimTK::SpatialVec>& bodyForces,
+            SimTK::Vector& generalizedForces) const override;
+    void generateDecorations(bool fixed, const ModelDisplayHints& hints,
+            const SimTK::State& state,
+            SimTK::Array_<SimTK::DecorativeGeometry>& geometry) const override;
+
+private:
+    void constructProperties();
+    // Compute the contact forces and points of all spheres and store them in
+    // the cache.
+    void calcContactForces(const SimTK::State& state) const;
+
+    std::vector<SimTK::ReferencePtr<const ContactSphere>> m_spheres;
+
+    // Quantities that depend only on the topology, computed in
+    // extendAddToSystem().
+    mutable std::vector<SimTK::MobilizedBodyIndex> m_sphereBodies;
+    mutable std::vector<SimTK::Vec3> m_sphereLocationsInBody;
+    mutable std::vector<double> m_sphereRadii;
+    mutable SimTK::MobilizedBodyIndex m_halfSpaceBody;
+    mutable SimTK::Transform m_halfSpaceFrameInBody;
+
+    mutable CacheVariable<SimTK::Vector_<SimTK::Vec3>> m_contactForcesCV;
+    mutable CacheVariable<SimTK::Vector_<SimTK::Vec3>> m_contactPointsCV;
+    // Workspace for the structure-of-arrays kernel: one column per quantity,
+    // one row per sphere.
+    mutable CacheVariable<SimTK::Matrix> m_workspaceCV;
+
+    mutable double m_forceVizScaleFactor;
+
+//=============================================================================
+}; // END of class SmoothSphereHalfSpaceForceGroup
+//=============================================================================
+//=============================================================================
+
+} // namespace OpenSim
+
+#endif // OPENSIM_SMOOTH_SPHERE_HALF_SPACE_FORCE_GROUP_H_
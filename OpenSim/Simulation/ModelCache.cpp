@@ -0,0 +1,239 @@
+/* -------------------------------------------------------------------------- *
+ *                         OpenSim:  ModelCache.cpp                           *
+ * -------------------------------------------------------------------------- *
+ * The OpenSim API is a toolkit for musculoskeletal modeling and simulation.  *
+ * See http://opensim.stanford.edu and the NOTICE file for more information.  *
+ * OpenSim is developed at Stanford University and supported by the US        *
+ * National Institutes of Health (U54 GM072970, R24 HD065690) and by DARPA    *
+ * through the Warrior Web program.                                           *
+ *                                                                            *
+ * Copyright (c) 2005-2021 Stanford University and the Authors                *
+ * Author(s): OpenSim Team                                                    *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "ModelCache.h"
+
+#include <OpenSim/Common/CommonUtilities.h>
+#include <OpenSim/Common/XMLDocument.h>
+
+#include <ctime>
+#include <fstream>
+
+#include <sys/stat.h>
+#include <sys/types.h>
+
+using namespace OpenSim;
+
+namespace {
+// Find the files from which objects in this object's properties were read
+// (via a file="..." attribute). Included files are read relative to the
+// directory containing the top-level document, so that is how we resolve
+// them here.
+void collectIncludedFiles(const Object& object,
+        const std::string& topLevelFileName, std::vector<std::string>& files) {
+    for (int iprop = 0; iprop < object.getNumProperties(); ++iprop) {
+        const auto& prop = object.getPropertyByIndex(iprop);
+        if (!prop.isObjectProperty()) continue;
+        for (int ival = 0; ival < prop.size(); ++ival) {
+            const Object& child = prop.getValueAsObject(ival);
+            if (!child.getInlined() && !child.getDocumentFileName().empty()) {
+                files.push_back(
+                        convertRelativeFilePathToAbsoluteFromXMLDocument(
+                                topLevelFileName,
+                                child.getDocumentFileName()));
+            }
+            collectIncludedFiles(child, topLevelFileName, files);
+        }
+    }
+}
+
+// Copying an Object does not copy its association with an XML document, so
+// mark the copies of objects that were read from included files as such;
+// otherwise, printing the copy would inline them.
+void restoreIncludedFiles(const Object& prototype, Object& copy) {
+    for (int iprop = 0; iprop < prototype.getNumProperties(); ++iprop) {
+        const auto& prop = prototype.getPropertyByIndex(iprop);
+        if (!prop.isObjectProperty()) continue;
+        auto& copyProp = copy.updPropertyByIndex(iprop);
+        for (int ival = 0; ival < prop.size(); ++ival) {
+            const Object& child = prop.getValueAsObject(ival);
+            Object& copyChild = copyProp.updValueAsObject(ival);
+            if (!child.getInlined()) {
+                copyChild.setInlined(false, child.getDocumentFileName());
+            }
+            restoreIncludedFiles(child, copyChild);
+        }
+    }
+}
+
+// Get the size and modification time of a file; returns false if the file
+// does not exist.
+bool getFileStatus(const std::string& fileName, long long& size,
+        long long& modificationTime) {
+    struct stat status;
+    if (stat(fileName.c_str(), &status) != 0) return false;
+    size = (long long)status.st_size;
+    modificationTime = (long long)status.st_mtime;
+    return true;
+}
+} // anonymous namespace
+
+std::unique_ptr<Model> ModelCache::load(const std::string& fileName) {
+    const std::string key = getKey(fileName);
+
+    std::shared_ptr<const Entry> entry;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const auto it = m_entries.find(key);
+        if (it != m_entries.end()) entry = it->second;
+    }
+
+    if (entry && isValid(*entry)) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            ++m_numHits;
+        }
+        log_debug("ModelCache: using cached copy of {}.", key);
+        return clonePrototype(*entry, fileName);
+    }
+
+    // Hash the top-level file before reading it so that an edit made while
+    // we are reading causes the next load() to read the file again.
+    auto newEntry = std::make_shared<Entry>();
+    newEntry->files.push_back(signFile(key));
+
+    std::unique_ptr<Model> prototype(new Model(key));
+    std::vector<std::string> includedFiles;
+    collectIncludedFiles(*prototype, key, includedFiles);
+    for (const auto& includedFile : includedFiles) {
+        newEntry->files.push_back(signFile(includedFile));
+    }
+    newEntry->prototype = std::shared_ptr<const Model>(prototype.release());
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_entries[key] = newEntry;
+        ++m_numMisses;
+    }
+
+    return clonePrototype(*newEntry, fileName);
+}
+
+std::unique_ptr<Model> ModelCache::clonePrototype(
+        const Entry& entry, const std::string& fileName) {
+    std::unique_ptr<Model> model;
+    {
+        std::lock_guard<std::mutex> lock(entry.cloneMutex);
+        model.reset(entry.prototype->clone());
+        if (const XMLDocument* document = entry.prototype->getDocument()) {
+            auto* copy = new XMLDocument(*document);
+            copy->copyDefaultObjects(*document);
+            model->setDocument(copy);
+        }
+        if (entry.files.size() > 1) {
+            restoreIncludedFiles(*entry.prototype, *model);
+        }
+    }
+    model->setInputFileName(fileName);
+    return model;
+}
+
+bool ModelCache::contains(const std::string& fileName) const {
+    std::shared_ptr<const Entry> entry;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const auto it = m_entries.find(getKey(fileName));
+        if (it == m_entries.end()) return false;
+        entry = it->second;
+    }
+    return isValid(*entry);
+}
+
+int ModelCache::getNumEntries() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return (int)m_entries.size();
+}
+
+int ModelCache::getNumHits() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_numHits;
+}
+
+int ModelCache::getNumMisses() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_numMisses;
+}
+
+void ModelCache::remove(const std::string& fileName) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.erase(getKey(fileName));
+}
+
+void ModelCache::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.clear();
+    m_numHits = 0;
+    m_numMisses = 0;
+}
+
+std::uint64_t ModelCache::hashFile(const std::string& fileName) {
+    std::ifstream stream(fileName, std::ios::in | std::ios::binary);
+    OPENSIM_THROW_IF(!stream.good(), Exception,
+            "Could not open file '{}'.", fileName);
+
+    // 64-bit FNV-1a.
+    std::uint64_t hash = 14695981039346656037ULL;
+    char buffer[4096];
+    while (stream) {
+        stream.read(buffer, sizeof(buffer));
+        const std::streamsize count = stream.gcount();
+        for (std::streamsize i = 0; i < count; ++i) {
+            hash ^= static_cast<unsigned char>(buffer[i]);
+            hash *= 1099511628211ULL;
+        }
+    }
+    return hash;
+}
+
+ModelCache::FileSignature ModelCache::signFile(const std::string& path) {
+    FileSignature signature;
+    signature.path = path;
+    OPENSIM_THROW_IF(!getFileStatus(path, signature.size,
+                             signature.modificationTime),
+            Exception, "Could not open file '{}'.", path);
+    // The time is taken after the status and before hashing. A file whose
+    // modification time is not earlier than this time could be edited again
+    // without changing its modification time, so isValid() always hashes
+    // such files again.
+    signature.hashTime = (long long)std::time(nullptr);
+    signature.hash = hashFile(path);
+    return signature;
+}
+
+bool ModelCache::isValid(const Entry& entry) {
+    for (const auto& file : entry.files) {
+        long long size, modificationTime;
+        if (!getFileStatus(file.path, size, modificationTime)) return false;
+        if (size != file.size) return false;
+        if (modificationTime == file.modificationTime &&
+                modificationTime < file.hashTime) {
+            continue;
+        }
+        if (hashFile(file.path) != file.hash) return false;
+    }
+    return true;
+}
+
+std::string ModelCache::getKey(const std::string& fileName) {
+    return SimTK::Pathname::getAbsolutePathname(fileName);
+}
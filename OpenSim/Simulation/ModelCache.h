@@ -0,0 +1,142 @@
+#ifndef OPENSIM_MODEL_CACHE_H_
+#define OPENSIM_MODEL_CACHE_H_
+/* -------------------------------------------------------------------------- *
+ *                          OpenSim:  ModelCache.h                            *
+ * -------------------------------------------------------------------------- *
+ * The OpenSim API is a toolkit for musculoskeletal modeling and simulation.  *
+ * See http://opensim.stanford.edu and the NOTICE file for more information.  *
+ * OpenSim is developed at Stanford University and supported by the US        *
+ * National Institutes of Health (U54 GM072970, R24 HD065690) and by DARPA    *
+ * through the Warrior Web program.                                           *
+ *                                                                            *
+ * Copyright (c) 2005-2021 Stanford University and the Authors                *
+ * Author(s): OpenSim Team                                                    *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "osimSimulationDLL.h"
+#include <OpenSim/Simulation/Model/Model.h>
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace OpenSim {
+
+/** Keeps fully-deserialized copies of Model files in memory so that loading
+the same .osim file repeatedly does not parse the XML document again.
+
+The first time a file is loaded, the Model is read from XML as usual and kept
+as a prototype, along with a content hash of the .osim file and of every file
+it includes via a `file="..."` attribute (e.g., an external ForceSet).
+Subsequent loads of the same file recompute these hashes and, if none of the
+files changed on disk, return a copy of the prototype instead of re-reading
+the XML. If any file changed, the entry is replaced by a freshly-read Model.
+
+@code
+ModelCache cache;
+std::unique_ptr<Model> model = cache.load("subject01.osim");
+model->initSystem();
+@endcode
+
+The returned Model is a copy (see Model::clone()), so it can be edited
+freely without affecting the cache or other copies. Unlike a plain copy, it
+keeps the association with its XML document(s), so that printing it writes
+objects that were read from included files back to those files. Loading is thread-safe;
+multiple threads may call load() on the same cache concurrently. Copying a
+Model is not guaranteed to be safe while the same Model is being copied on
+another thread, so copies of the same prototype are made one at a time
+(copies of different files are made concurrently).
+
+@note The cache lives only as long as this object; there is no on-disk
+snapshot. It therefore speeds up repeated loads within one process (e.g., a
+long-running service, or one copy of a model per thread), but the first load
+of a file in each process still parses the XML. A persisted snapshot would
+need a binary encoding of every property type, which OpenSim does not have
+and which would have to track the XML's versioning and defaults.
+
+@note A file is hashed again only if its size or modification time differs
+from when it was cached (or if it was modified in the same second in which
+it was hashed, since modification times may have a resolution of one
+second). Files are still compared by content, so the cache remains valid
+across `touch` and file copies, although such files are hashed on every
+load. Only files referenced through `file` attributes are tracked; other
+external resources (mesh files, data files referenced by components) are not
+part of the key.
+@ingroup simulationutil */
+class OSIMSIMULATION_API ModelCache {
+public:
+    ModelCache() = default;
+
+    /** Obtain a copy of the Model in the given file, reading the file only
+    if it (or one of its included files) is not already cached or has changed
+    since it was cached.
+    @throws Exception if the file cannot be read. */
+    std::unique_ptr<Model> load(const std::string& fileName);
+
+    /** Does the cache hold a valid (up-to-date) entry for this file? This
+    hashes the file and its includes, but never reads the XML. */
+    bool contains(const std::string& fileName) const;
+
+    /** Number of files held in the cache. */
+    int getNumEntries() const;
+    /** Number of calls to load() that were served from the cache. */
+    int getNumHits() const;
+    /** Number of calls to load() that required reading the XML file. */
+    int getNumMisses() const;
+
+    /** Remove the entry for the given file, if any. */
+    void remove(const std::string& fileName);
+    /** Remove all entries and reset the hit/miss counters. */
+    void clear();
+
+    /** Hash the bytes of a file (64-bit FNV-1a). This is the hash used to
+    decide if a cached entry is still valid.
+    @throws Exception if the file cannot be opened. */
+    static std::uint64_t hashFile(const std::string& fileName);
+
+private:
+    struct FileSignature {
+        std::string path;
+        std::uint64_t hash;
+        /** Size and modification time of the file before it was hashed, and
+        the time at which it was hashed. */
+        long long size;
+        long long modificationTime;
+        long long hashTime;
+    };
+    struct Entry {
+        std::vector<FileSignature> files;
+        std::shared_ptr<const Model> prototype;
+        /** Serializes the copies of the prototype. */
+        mutable std::mutex cloneMutex;
+    };
+
+    static std::unique_ptr<Model> clonePrototype(const Entry& entry,
+            const std::string& fileName);
+
+    static FileSignature signFile(const std::string& path);
+    static bool isValid(const Entry& entry);
+    static std::string getKey(const std::string& fileName);
+
+    std::map<std::string, std::shared_ptr<const Entry>> m_entries;
+    int m_numHits = 0;
+    int m_numMisses = 0;
+    mutable std::mutex m_mutex;
+};
+
+} // namespace OpenSim
+
+#endif // OPENSIM_MODEL_CACHE_H_
@@ -0,0 +1,282 @@
+/* -------------------------------------------------------------------------- *
+ *               OpenSim:  RealTimeIMUInverseKinematics.cpp                   *
+ * -------------------------------------------------------------------------- *
+ * The OpenSim API is a toolkit for musculoskeletal modeling and simulation.  *
+ * See http://opensim.stanford.edu and the NOTICE file for more information.  *
+ * OpenSim is developed at Stanford University and supported by the US        *
+ * National Institutes of Health (U54 GM072970, R24 HD065690) and by DARPA    *
+ * through the Warrior Web program.                                           *
+ *                                                                            *
+ * Copyright (c) 2005-2021 Stanford University and the Authors                *
+ * Author(s): OpenSim Team                                                    *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "RealTimeIMUInverseKinematics.h"
+
+#include "BufferedOrientationsReference.h"
+#include "InverseKinematicsSolver.h"
+
+#include <algorithm>
+
+using namespace OpenSim;
+
+RealTimeIMUInverseKinematics::RealTimeIMUInverseKinematics(
+        const Model& model, std::vector<std::string> sensorNames,
+        const Set<OrientationWeight>* orientationWeights)
+        : m_model(new Model(model)), m_sensorNames(std::move(sensorNames)) {
+    OPENSIM_THROW_IF(m_sensorNames.empty(), Exception,
+            "Expected at least one sensor name.");
+    if (orientationWeights) {
+        m_orientationWeights.reset(
+                new Set<OrientationWeight>(*orientationWeights));
+    }
+    m_model->setUseVisualizer(false);
+    m_state = m_model->initSystem();
+
+    // InverseKinematicsSolver silently ignores sensors that are not in the
+    // model, but a live stream with a misnamed sensor is almost certainly a
+    // mistake.
+    std::vector<std::string> frameNames;
+    for (const auto& frame : m_model->getComponentList<PhysicalFrame>()) {
+        frameNames.push_back(frame.getName());
+    }
+    for (const auto& name : m_sensorNames) {
+        OPENSIM_THROW_IF(std::find(frameNames.begin(), frameNames.end(),
+                                 name) == frameNames.end(),
+                Exception, "Expected the model to have a PhysicalFrame for "
+                           "sensor '{}', but it does not.", name);
+    }
+}
+
+RealTimeIMUInverseKinematics::~RealTimeIMUInverseKinematics() { stop(); }
+
+void RealTimeIMUInverseKinematics::setAccuracy(double accuracy) {
+    OPENSIM_THROW_IF(m_solver != nullptr, Exception,
+            "Cannot change the accuracy after the first frame is solved.");
+    m_accuracy = accuracy;
+}
+
+void RealTimeIMUInverseKinematics::setTimeBudget(double timeBudget) {
+    OPENSIM_THROW_IF(!(timeBudget > 0), Exception,
+            "Expected a positive time budget, but got {}.", timeBudget);
+    OPENSIM_THROW_IF(isRunning(), Exception,
+            "Cannot change the time budget while the worker thread is "
+            "running.");
+    m_timeBudget = timeBudget;
+}
+
+void RealTimeIMUInverseKinematics::setSolutionCallback(
+        std::function<void(const Solution&)> callback) {
+    OPENSIM_THROW_IF(isRunning(), Exception,
+            "Cannot set the solution callback while the worker thread is "
+            "running.");
+    m_callback = std::move(callback);
+}
+
+std::vector<std::string>
+RealTimeIMUInverseKinematics::getCoordinateNames() const {
+    std::vector<std::string> names;
+    const auto& coordinates = m_model->getCoordinateSet();
+    for (int i = 0; i < coordinates.getSize(); ++i) {
+        names.push_back(coordinates[i].getName());
+    }
+    return names;
+}
+
+void RealTimeIMUInverseKinematics::pushFrame(double time,
+        const SimTK::RowVector_<SimTK::Rotation>& orientations) {
+    OPENSIM_THROW_IF(orientations.size() != (int)m_sensorNames.size(),
+            Exception, "Expected {} orientations, but got {}.",
+            m_sensorNames.size(), orientations.size());
+    Frame frame{time, 0, orientations, Clock::now()};
+    {
+        std::lock_guard<std::mutex> lock(m_framesMutex);
+        frame.index = m_nextFrameIndex++;
+        ++m_numFramesReceived;
+        m_frames.push_back(std::move(frame));
+    }
+    m_framesCondition.notify_one();
+}
+
+bool RealTimeIMUInverseKinematics::popFrame(Frame& frame) {
+    std::lock_guard<std::mutex> lock(m_framesMutex);
+    if (m_frames.empty()) return false;
+    const auto now = Clock::now();
+    while (m_frames.size() > 1) {
+        const double waited = std::chrono::duration<double>(
+                now - m_frames.front().arrival).count();
+        if (waited + m_meanSolveTime <= m_timeBudget) break;
+        m_frames.pop_front();
+        ++m_numFramesDropped;
+    }
+    frame = std::move(m_frames.front());
+    m_frames.pop_front();
+    return true;
+}
+
+bool RealTimeIMUInverseKinematics::solveNext() {
+    OPENSIM_THROW_IF(isRunning(), Exception,
+            "Cannot call solveNext() while the worker thread is running.");
+    Frame frame;
+    if (!popFrame(frame)) return false;
+    solve(frame);
+    return true;
+}
+
+void RealTimeIMUInverseKinematics::initializeSolver(const Frame& frame) {
+    // The reference holds only the first frame; subsequent frames are passed
+    // through its queue, one at a time, right before they are tracked.
+    TimeSeriesTable_<SimTK::Rotation> firstFrame;
+    firstFrame.setColumnLabels(m_sensorNames);
+    firstFrame.appendRow(frame.time, frame.orientations);
+    m_orientationsReference = std::make_shared<BufferedOrientationsReference>(
+            firstFrame, m_orientationWeights.get());
+
+    SimTK::Array_<CoordinateReference> coordinateReferences;
+    std::unique_ptr<InverseKinematicsSolver> solver(
+            new InverseKinematicsSolver(*m_model, nullptr,
+                    m_orientationsReference, coordinateReferences));
+    solver->setAccuracy(m_accuracy);
+    m_state.setTime(frame.time);
+    solver->assemble(m_state);
+    solver->setAdvanceTimeFromReference(true);
+    m_solver = std::move(solver);
+}
+
+void RealTimeIMUInverseKinematics::solve(const Frame& frame) {
+    const auto start = Clock::now();
+    const bool tracking = m_solver != nullptr;
+    try {
+        if (tracking) {
+            m_orientationsReference->putValues(
+                    frame.time, frame.orientations);
+            m_solver->track(m_state);
+        } else {
+            initializeSolver(frame);
+        }
+    } catch (const std::exception& ex) {
+        log_warn("RealTimeIMUInverseKinematics: failed to solve frame {} "
+                 "(time {}): {}", frame.index, frame.time, ex.what());
+        std::lock_guard<std::mutex> lock(m_solutionMutex);
+        ++m_statistics.numFramesFailed;
+        return;
+    }
+    const double solveTime =
+            std::chrono::duration<double>(Clock::now() - start).count();
+    if (tracking) {
+        // Exponential moving average, so that the estimate follows changes
+        // in the load of the machine.
+        m_meanSolveTime = m_meanSolveTime == 0
+                                  ? solveTime
+                                  : 0.9 * m_meanSolveTime + 0.1 * solveTime;
+    }
+    publish(frame, solveTime, tracking);
+}
+
+void RealTimeIMUInverseKinematics::publish(
+        const Frame& frame, double solveTime, bool inStatistics) {
+    Solution solution;
+    solution.time = frame.time;
+    solution.frameIndex = frame.index;
+    const auto& coordinates = m_model->getCoordinateSet();
+    solution.coordinates.resize(coordinates.getSize());
+    for (int i = 0; i < coordinates.getSize(); ++i) {
+        solution.coordinates[i] = coordinates[i].getValue(m_state);
+    }
+    solution.solveTime = solveTime;
+    solution.latency = std::chrono::duration<double>(
+            Clock::now() - frame.arrival).count();
+
+    {
+        std::lock_guard<std::mutex> lock(m_solutionMutex);
+        m_latestSolution = solution;
+        auto& stats = m_statistics;
+        ++stats.numFramesSolved;
+        if (inStatistics) {
+            ++m_numTimedFrames;
+            m_sumLatency += solution.latency;
+            m_sumSolveTime += solveTime;
+            stats.meanLatency = m_sumLatency / m_numTimedFrames;
+            stats.meanSolveTime = m_sumSolveTime / m_numTimedFrames;
+            stats.maxLatency = m_numTimedFrames == 1
+                    ? solution.latency
+                    : std::max(stats.maxLatency, solution.latency);
+            stats.maxSolveTime = m_numTimedFrames == 1
+                    ? solveTime
+                    : std::max(stats.maxSolveTime, solveTime);
+            if (solution.latency > m_timeBudget) ++stats.numBudgetOverruns;
+        }
+    }
+    if (m_callback) m_callback(solution);
+}
+
+void RealTimeIMUInverseKinematics::start() {
+    OPENSIM_THROW_IF(isRunning(), Exception,
+            "The worker thread is already running.");
+    m_stopRequested = false;
+    m_thread = std::thread([this]() {
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(m_framesMutex);
+                m_framesCondition.wait(lock, [this]() {
+                    return m_stopRequested || !m_frames.empty();
+                });
+                if (m_stopRequested) return;
+            }
+            Frame frame;
+            if (popFrame(frame)) solve(frame);
+        }
+    });
+}
+
+void RealTimeIMUInverseKinematics::stop() {
+    if (!isRunning()) return;
+    {
+        std::lock_guard<std::mutex> lock(m_framesMutex);
+        m_stopRequested = true;
+    }
+    m_framesCondition.notify_one();
+    m_thread.join();
+}
+
+RealTimeIMUInverseKinematics::Solution
+RealTimeIMUInverseKinematics::getLatestSolution() const {
+    std::lock_guard<std::mutex> lock(m_solutionMutex);
+    return m_latestSolution;
+}
+
+RealTimeIMUInverseKinematics::LatencyStatistics
+RealTimeIMUInverseKinematics::getLatencyStatistics() const {
+    LatencyStatistics stats;
+    {
+        std::lock_guard<std::mutex> lock(m_solutionMutex);
+        stats = m_statistics;
+    }
+    std::lock_guard<std::mutex> lock(m_framesMutex);
+    stats.numFramesReceived = m_numFramesReceived;
+    stats.numFramesDropped = m_numFramesDropped;
+    return stats;
+}
+
+void RealTimeIMUInverseKinematics::resetLatencyStatistics() {
+    {
+        std::lock_guard<std::mutex> lock(m_solutionMutex);
+        m_statistics = LatencyStatistics();
+        m_sumLatency = 0;
+        m_sumSolveTime = 0;
+        m_numTimedFrames = 0;
+    }
+    std::lock_guard<std::mutex> lock(m_framesMutex);
+    m_numFramesReceived = 0;
+    m_numFramesDropped = 0;
+}
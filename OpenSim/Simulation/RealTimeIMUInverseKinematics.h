@@ -0,0 +1,236 @@
+#ifndef OPENSIM_REAL_TIME_IMU_INVERSE_KINEMATICS_H_
+#define OPENSIM_REAL_TIME_IMU_INVERSE_KINEMATICS_H_
+/* -------------------------------------------------------------------------- *
+ *                OpenSim:  RealTimeIMUInverseKinematics.h                    *
+ * -------------------------------------------------------------------------- *
+ * The OpenSim API is a toolkit for musculoskeletal modeling and simulation.  *
+ * See http://opensim.stanford.edu and the NOTICE file for more information.  *
+ * OpenSim is developed at Stanford University and supported by the US        *
+ * National Institutes of Health (U54 GM072970, R24 HD065690) and by DARPA    *
+ * through the Warrior Web program.                                           *
+ *                                                                            *
+ * Copyright (c) 2005-2021 Stanford University and the Authors                *
+ * Author(s): OpenSim Team                                                    *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "osimSimulationDLL.h"
+#include <OpenSim/Simulation/Model/Model.h>
+#include <OpenSim/Simulation/OrientationsReference.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace OpenSim {
+
+class BufferedOrientationsReference;
+class InverseKinematicsSolver;
+
+/** Solve inverse kinematics from a live stream of IMU orientations, e.g., to
+provide real-time feedback.
+
+A producer (e.g., the thread that reads the IMUs) pushes frames of sensor
+orientations with pushFrame(). A consumer solves them, either on a worker
+thread started with start(), or by calling solveNext() on a thread of its
+own. Each solved frame is published as a Solution, which can be polled with
+getLatestSolution() or received through a callback (see
+setSolutionCallback()).
+
+The model, its State, and the InverseKinematicsSolver are created once and
+reused for all frames. The first frame is solved with
+InverseKinematicsSolver::assemble(); subsequent frames are solved with
+InverseKinematicsSolver::track(), starting from the solution of the previous
+frame, which is much faster.
+
+<b>Time budget.</b> The latency of a frame is the time from pushFrame() to
+the publication of its solution. To keep the latency bounded when solving
+falls behind the rate at which frames arrive, a frame that is waiting to be
+solved is dropped if a newer frame is waiting and the frame could not be
+solved within the time budget (based on the mean time spent solving a
+frame). The newest frame is never dropped. The statistics in
+LatencyStatistics report the number of dropped frames and the number of
+frames whose latency exceeded the budget.
+
+@code
+RealTimeIMUInverseKinematics ik(model,
+        {"pelvis_imu", "femur_r_imu", "tibia_r_imu"});
+ik.setTimeBudget(0.01);
+ik.setSolutionCallback([](const RealTimeIMUInverseKinematics::Solution& s) {
+    sendToDisplay(s.time, s.coordinates);
+});
+ik.start();
+while (streaming) {
+    ik.pushFrame(time, readIMUOrientations());
+}
+ik.stop();
+log_info("Mean latency: {} s.", ik.getLatencyStatistics().meanLatency);
+@endcode
+
+The orientations are expressed in ground, as in OrientationsReference; use
+OpenSenseUtilities to convert sensor data to the OpenSim ground frame
+beforehand.
+
+@ingroup simulationutil */
+class OSIMSIMULATION_API RealTimeIMUInverseKinematics {
+public:
+    /** The solution of a frame. */
+    struct Solution {
+        /** The time of the frame, as passed to pushFrame(). */
+        double time = SimTK::NaN;
+        /** The index of the frame, counting the frames passed to
+        pushFrame() (including dropped frames) from 0. */
+        int frameIndex = -1;
+        /** The values of the model's coordinates, in the order of the
+        model's CoordinateSet (see getCoordinateNames()). */
+        SimTK::Vector coordinates;
+        /** Time (in seconds) from pushFrame() to the publication of this
+        solution. */
+        double latency = SimTK::NaN;
+        /** Time (in seconds) spent solving the frame. */
+        double solveTime = SimTK::NaN;
+    };
+
+    /** Counts of frames and the latency of solved frames. The first frame
+    (which is assembled) is excluded from the latencies and solve times. */
+    struct LatencyStatistics {
+        int numFramesReceived = 0;
+        int numFramesSolved = 0;
+        int numFramesDropped = 0;
+        /** Frames for which the solver threw an exception. */
+        int numFramesFailed = 0;
+        /** Solved frames whose latency exceeded the time budget. */
+        int numBudgetOverruns = 0;
+        double meanLatency = SimTK::NaN;
+        double maxLatency = SimTK::NaN;
+        double meanSolveTime = SimTK::NaN;
+        double maxSolveTime = SimTK::NaN;
+    };
+
+    /** The model is copied and its system is built. The model must contain
+    a PhysicalFrame for each sensor name; each frame pushed with pushFrame()
+    contains the orientations of these sensors, in the order of
+    sensorNames. The relative weights of the sensors can be provided with
+    orientationWeights (the default weight is 1). */
+    RealTimeIMUInverseKinematics(const Model& model,
+            std::vector<std::string> sensorNames,
+            const Set<OrientationWeight>* orientationWeights = nullptr);
+    ~RealTimeIMUInverseKinematics();
+
+    RealTimeIMUInverseKinematics(const RealTimeIMUInverseKinematics&) = delete;
+    RealTimeIMUInverseKinematics& operator=(
+            const RealTimeIMUInverseKinematics&) = delete;
+
+    /** Accuracy of the solver (see AssemblySolver::setAccuracy()); the
+    default is 1e-4, as in IMUInverseKinematicsTool. This cannot be changed
+    after the first frame is solved. */
+    void setAccuracy(double accuracy);
+    double getAccuracy() const { return m_accuracy; }
+
+    /** The latency (in seconds) that a frame should not exceed (default:
+    0.01 s, for streaming at 100 Hz). Set to SimTK::Infinity to solve every
+    frame regardless of latency. Must be set before start(). */
+    void setTimeBudget(double timeBudget);
+    double getTimeBudget() const { return m_timeBudget; }
+
+    /** Invoked with each solution, on the thread that solved the frame.
+    Must be set before start(). */
+    void setSolutionCallback(std::function<void(const Solution&)> callback);
+
+    const Model& getModel() const { return *m_model; }
+    const std::vector<std::string>& getSensorNames() const {
+        return m_sensorNames;
+    }
+    /** The names of the coordinates in Solution::coordinates. */
+    std::vector<std::string> getCoordinateNames() const;
+
+    /** Queue a frame of sensor orientations (in the order of
+    getSensorNames()) to be solved. This can be called from any thread. */
+    void pushFrame(double time,
+            const SimTK::RowVector_<SimTK::Rotation>& orientations);
+
+    /** Solve the next frame, if any, on the calling thread (frames may be
+    dropped first; see the class description).
+    @returns false if no frame was waiting.
+    @throws Exception if the worker thread is running. */
+    bool solveNext();
+
+    /** Start a worker thread that solves frames as they arrive. */
+    void start();
+    /** Stop the worker thread, after it finishes the frame it is solving.
+    Frames that are still waiting remain queued. */
+    void stop();
+    bool isRunning() const { return m_thread.joinable(); }
+
+    /** The most recently published solution (its frameIndex is -1 if no
+    frame has been solved yet). This can be called from any thread. */
+    Solution getLatestSolution() const;
+    /** This can be called from any thread. */
+    LatencyStatistics getLatencyStatistics() const;
+    void resetLatencyStatistics();
+
+private:
+    using Clock = std::chrono::steady_clock;
+    struct Frame {
+        double time;
+        int index;
+        SimTK::RowVector_<SimTK::Rotation> orientations;
+        Clock::time_point arrival;
+    };
+
+    // Take the frame to solve next from the queue, dropping frames that
+    // cannot be solved within the time budget.
+    bool popFrame(Frame& frame);
+    void solve(const Frame& frame);
+    void initializeSolver(const Frame& frame);
+    void publish(const Frame& frame, double solveTime, bool inStatistics);
+
+    std::unique_ptr<Model> m_model;
+    std::vector<std::string> m_sensorNames;
+    std::unique_ptr<Set<OrientationWeight>> m_orientationWeights;
+    double m_accuracy = 1e-4;
+    double m_timeBudget = 0.01;
+    std::function<void(const Solution&)> m_callback;
+
+    // Used only by the thread that solves frames.
+    SimTK::State m_state;
+    double m_meanSolveTime = 0;
+    std::shared_ptr<BufferedOrientationsReference> m_orientationsReference;
+    std::unique_ptr<InverseKinematicsSolver> m_solver;
+
+    std::deque<Frame> m_frames;
+    int m_nextFrameIndex = 0;
+    int m_numFramesReceived = 0;
+    int m_numFramesDropped = 0;
+    mutable std::mutex m_framesMutex;
+    std::condition_variable m_framesCondition;
+
+    Solution m_latestSolution;
+    LatencyStatistics m_statistics;
+    double m_sumLatency = 0;
+    double m_sumSolveTime = 0;
+    int m_numTimedFrames = 0;
+    mutable std::mutex m_solutionMutex;
+
+    std::thread m_thread;
+    bool m_stopRequested = false;
+};
+
+} // namespace OpenSim
+
+#endif // OPENSIM_REAL_TIME_IMU_INVERSE_KINEMATICS_H_
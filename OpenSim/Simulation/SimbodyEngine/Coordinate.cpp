@@ -644,6 +644,17 @@ void Coordinate::CoordinateStateVariable::
 }
 
 
+SimTK::SystemYIndex Coordinate::CoordinateStateVariable::
+    findSystemYIndex(const SimTK::State& state) const
+{
+    // Y is ordered as [q, u, z].
+    const Coordinate& owner = *((Coordinate *)&getOwner());
+    const SimbodyMatterSubsystem& matter = owner.getModel().getMatterSubsystem();
+    const MobilizedBody& mb = matter.getMobilizedBody(owner.getBodyIndex());
+    return SimTK::SystemYIndex(state.getQStart(matter.getMySubsystemIndex()) +
+            mb.getFirstQIndex(state) + owner.getMobilizerQIndex());
+}
+
 //-----------------------------------------------------------------------------
 // Coordinate::SpeedStateVariable
 //-----------------------------------------------------------------------------
@@ -671,6 +682,18 @@ double Coordinate::SpeedStateVariable::
     return mb.getUDotAsVector(state)[owner.getMobilizerQIndex()];
 }
 
+SimTK::SystemYIndex Coordinate::SpeedStateVariable::
+    findSystemYIndex(const SimTK::State& state) const
+{
+    // Y is ordered as [q, u, z].
+    const Coordinate& owner = *((Coordinate *)&getOwner());
+    const SimbodyMatterSubsystem& matter = owner.getModel().getMatterSubsystem();
+    const MobilizedBody& mb = matter.getMobilizedBody(owner.getBodyIndex());
+    return SimTK::SystemYIndex(state.getNQ() +
+            state.getUStart(matter.getMySubsystemIndex()) +
+            mb.getFirstUIndex(state) + owner.getMobilizerQIndex());
+}
+
 void Coordinate::SpeedStateVariable::
     setDerivative(const SimTK::State& state, double deriv) const
 {
@@ -25,10 +25,14 @@
 
 #include "StatesTrajectory.h"
 #include "osimSimulationDLL.h"
+#include <algorithm>
+#include <exception>
 #include <regex>
+#include <thread>
 
 #include <SimTKcommon/internal/State.h>
 
+#include <OpenSim/Common/OutputPlan.h>
 #include <OpenSim/Common/Reporter.h>
 #include <OpenSim/Common/Storage.h>
 #include <OpenSim/Simulation/Model/Model.h>
@@ -191,62 +195,21 @@ OSIMSIMULATION_API void checkOrderSystemControls(const Model& model);
 OSIMSIMULATION_API void checkLabelsMatchModelStates(
         const Model& model, const std::vector<std::string>& labels);
 
-/// Calculate the requested outputs using the model in the problem and the
-/// provided states and controls tables
-/// The controls table is used to set the model's controls vector.
-/// We assume the states and controls tables contain the same time points.
-/// The output paths can be regular expressions. For example,
-/// ".*activation" gives the activation of all muscles.
-///
-/// The output paths must correspond to outputs that match the type provided in
-/// the template argument, otherwise they are not included in the report.
-///
-/// Controls missing from the controls table are given a value of 0.
-///
-/// @note The provided trajectory is not modified to satisfy kinematic
-/// constraints, but SimTK::Motions in the Model (e.g., PositionMotion) are
-/// applied. Therefore, this function expects that you've provided a trajectory
-/// that already satisfies kinematic constraints. If your provided trajectory
-/// does not satisfy kinematic constraints, many outputs will be incorrect.
-/// For example, in a model with a patella whose location is determined by a
-/// CoordinateCouplerConstraint, the length of a muscle that crosses the patella
-/// will be incorrect.
-/// @ingroup simulationutil
+/// The serial implementation of analyze(), which initializes and uses the
+/// provided model rather than a copy of it.
 template <typename T>
-TimeSeriesTable_<T> analyze(Model model, const TimeSeriesTable& statesTable,
+TimeSeriesTable_<T> analyzeWithModel(Model& model,
+        const TimeSeriesTable& statesTable,
         const TimeSeriesTable& controlsTable,
         const std::vector<std::string>& outputPaths) {
-
     // Initialize the system so we can access the outputs.
     model.initSystem();
-    // Create the reporter object to which we'll add the output data to create
-    // the report.
-    auto* reporter = new TableReporter_<T>();
-    // Loop through all the outputs for all components in the model, and if
-    // the output path matches one provided in the argument and the output type
-    // agrees with the template argument type, add it to the report.
-    for (const auto& comp : model.getComponentList()) {
-        for (const auto& outputName : comp.getOutputNames()) {
-            const auto& output = comp.getOutput(outputName);
-            auto thisOutputPath = output.getPathName();
-            for (const auto& outputPathArg : outputPaths) {
-                if (std::regex_match(
-                        thisOutputPath, std::regex(outputPathArg))) {
-                    // Make sure the output type agrees with the template.
-                    if (dynamic_cast<const Output<T>*>(&output)) {
-                        log_debug("Adding output {} of type {}.",
-                                output.getPathName(), output.getTypeName());
-                        reporter->addToReport(output);
-                    } else {
-                        log_warn("Ignoring output {} of type {}.",
-                                output.getPathName(), output.getTypeName());
-                    }
-                }
-            }
-        }
-    }
-    model.addComponent(reporter);
-    model.initSystem();
+    // Resolve the outputs whose path matches one provided in the argument and
+    // whose type agrees with the template argument type. We evaluate these
+    // directly into preallocated storage rather than via a TableReporter_,
+    // which would grow its table one row at a time.
+    OutputPlan<T> plan;
+    plan.addOutputsMatching(model, outputPaths);
 
     const auto statesTraj =
             StatesTrajectory::createFromStatesTable(model, statesTable);
@@ -257,12 +220,8 @@ TimeSeriesTable_<T> analyze(Model model, const TimeSeriesTable& statesTable,
             createSystemControlIndexMap(model);
     SimTK::Vector controls((int)controlsTable.getNumColumns(), 0.0);
 
-    OPENSIM_THROW_IF(statesTable.getNumRows() != controlsTable.getNumRows(),
-            Exception,
-            "Expected statesTable and controlsTable to contain the "
-            "same number of rows, but statesTable contains {} rows "
-            "and controlsTable contains {} rows.",
-            statesTable.getNumRows(), controlsTable.getNumRows());
+    std::vector<double> times(statesTraj.getSize());
+    SimTK::Matrix_<T> values((int)statesTraj.getSize(), plan.getNumChannels());
 
     // Loop through the states trajectory to create the report.
     for (int itime = 0; itime < (int)statesTraj.getSize(); ++itime) {
@@ -284,11 +243,124 @@ TimeSeriesTable_<T> analyze(Model model, const TimeSeriesTable& statesTable,
         model.realizeVelocity(state);
         model.setControls(state, controls);
 
-        // Generate report results for the current state.
+        // Evaluate the outputs for the current state. We realize to Report
+        // rather than to plan.getRequiredStage(), since an output may read
+        // cache variables computed at a later stage than the one it declares.
         model.realizeReport(state);
+        times[itime] = state.getTime();
+        auto row = values.updRow(itime);
+        plan.evaluate(state, row);
     }
 
-    return reporter->getTable();
+    return TimeSeriesTable_<T>(times, values, plan.getLabels());
+}
+
+/// Calculate the requested outputs using the model in the problem and the
+/// provided states and controls tables
+/// The controls table is used to set the model's controls vector.
+/// We assume the states and controls tables contain the same time points.
+/// The output paths can be regular expressions. For example,
+/// ".*activation" gives the activation of all muscles.
+///
+/// The output paths must correspond to outputs that match the type provided in
+/// the template argument, otherwise they are not included in the report.
+///
+/// Controls missing from the controls table are given a value of 0.
+///
+/// @note The provided trajectory is not modified to satisfy kinematic
+/// constraints, but SimTK::Motions in the Model (e.g., PositionMotion) are
+/// applied. Therefore, this function expects that you've provided a trajectory
+/// that already satisfies kinematic constraints. If your provided trajectory
+/// does not satisfy kinematic constraints, many outputs will be incorrect.
+/// For example, in a model with a patella whose location is determined by a
+/// CoordinateCouplerConstraint, the length of a muscle that crosses the patella
+/// will be incorrect.
+///
+/// Set numThreads to a value other than 1 to evaluate the rows of the tables
+/// in parallel: the rows are split into numThreads contiguous blocks, each of
+/// which is evaluated on its own copy of the model, and the results are
+/// assembled in order. The result is the same as with numThreads = 1. If
+/// numThreads is less than 1, we use the number of hardware threads. Each
+/// thread initializes its own copy of the model, so parallel evaluation pays
+/// off for long trajectories or expensive outputs.
+/// @ingroup simulationutil
+template <typename T>
+TimeSeriesTable_<T> analyze(Model model, const TimeSeriesTable& statesTable,
+        const TimeSeriesTable& controlsTable,
+        const std::vector<std::string>& outputPaths, int numThreads = 1) {
+
+    OPENSIM_THROW_IF(statesTable.getNumRows() != controlsTable.getNumRows(),
+            Exception,
+            "Expected statesTable and controlsTable to contain the "
+            "same number of rows, but statesTable contains {} rows "
+            "and controlsTable contains {} rows.",
+            statesTable.getNumRows(), controlsTable.getNumRows());
+
+    const int numRows = (int)statesTable.getNumRows();
+    if (numThreads < 1) {
+        numThreads = (int)std::thread::hardware_concurrency();
+    }
+    numThreads = std::max(1, std::min(numThreads, numRows));
+    if (numThreads == 1) {
+        return analyzeWithModel<T>(
+                model, statesTable, controlsTable, outputPaths);
+    }
+
+    // Prepare the inputs for each block on this thread, so that the worker
+    // threads do not share any objects. The blocks are split by row index,
+    // so that each row belongs to exactly one block.
+    const auto sliceRows = [](const TimeSeriesTable& table, int begin,
+                                   int end) {
+        const auto& time = table.getIndependentColumn();
+        const int numColumns = (int)table.getNumColumns();
+        TimeSeriesTable block(
+                std::vector<double>(time.begin() + begin, time.begin() + end),
+                numColumns ? SimTK::Matrix(table.getMatrixBlock(
+                                     begin, 0, end - begin, numColumns))
+                           : SimTK::Matrix(end - begin, 0),
+                table.getColumnLabels());
+        block.updTableMetaData() = table.getTableMetaData();
+        return block;
+    };
+    std::vector<std::unique_ptr<Model>> models;
+    std::vector<TimeSeriesTable> statesBlocks;
+    std::vector<TimeSeriesTable> controlsBlocks;
+    for (int ithread = 0; ithread < numThreads; ++ithread) {
+        const int begin = ithread * numRows / numThreads;
+        const int end = (ithread + 1) * numRows / numThreads;
+        models.emplace_back(new Model(model));
+        statesBlocks.push_back(sliceRows(statesTable, begin, end));
+        controlsBlocks.push_back(sliceRows(controlsTable, begin, end));
+    }
+
+    std::vector<TimeSeriesTable_<T>> results(numThreads);
+    std::vector<std::exception_ptr> exceptions(numThreads);
+    std::vector<std::thread> threads;
+    for (int ithread = 0; ithread < numThreads; ++ithread) {
+        threads.emplace_back([&, ithread]() {
+            try {
+                results[ithread] = analyzeWithModel<T>(*models[ithread],
+                        statesBlocks[ithread], controlsBlocks[ithread],
+                        outputPaths);
+            } catch (...) {
+                exceptions[ithread] = std::current_exception();
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    for (const auto& exception : exceptions) {
+        if (exception) std::rethrow_exception(exception);
+    }
+
+    TimeSeriesTable_<T> table = std::move(results[0]);
+    for (int ithread = 1; ithread < numThreads; ++ithread) {
+        const auto& block = results[ithread];
+        const auto& blockTime = block.getIndependentColumn();
+        for (int irow = 0; irow < (int)block.getNumRows(); ++irow) {
+            table.appendRow(blockTime[irow], block.getRowAtIndex(irow));
+        }
+    }
+    return table;
 }
 
 } // end of namespace OpenSim
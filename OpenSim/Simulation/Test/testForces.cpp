@@ -40,6 +40,7 @@
 //
 //==============================================================================
 #include "SimTKcommon/internal/Xml.h"
+#include <cstdlib> // std::system()
 #include <ctime> // clock(), clock_t, CLOCKS_PER_SEC
 
 #include <OpenSim/Analyses/osimAnalyses.h>
@@ -63,6 +64,8 @@ void testTwoFrameLinkerUpdateFromXMLNode();
 void testFunctionBasedBushingForce();
 void testExpressionBasedBushingForceTranslational();
 void testExpressionBasedBushingForceRotational();
+void testExpressionBasedBushingForceStiffnessMatrix();
+void testExpressionBasedBushingForceNativeCode();
 void testElasticFoundation();
 void testHuntCrossleyForce();
 void testSmoothSphereHalfSpaceForce();
@@ -74,6 +77,8 @@ void testSerializeDeserialize();
 void testTranslationalDampingEffect(Model& osimModel, Coordinate& sliderCoord,
         double start_h, Component& componentWithDamping);
 void testBlankevoort1991Ligament();
+void testParallelForces();
+void testSmoothSphereHalfSpaceForceGroup();
 
 int main() {
     SimTK::Array_<std::string> failures;
@@ -122,6 +127,18 @@ int main() {
         failures.push_back("testExpressionBasedBushingForceRotational");
     }
 
+    try { testExpressionBasedBushingForceStiffnessMatrix(); }
+    catch (const std::exception& e) {
+        cout << e.what() << endl;
+        failures.push_back("testExpressionBasedBushingForceStiffnessMatrix");
+    }
+
+    try { testExpressionBasedBushingForceNativeCode(); }
+    catch (const std::exception& e) {
+        cout << e.what() << endl;
+        failures.push_back("testExpressionBasedBushingForceNativeCode");
+    }
+
     try { testElasticFoundation(); }
     catch (const std::exception& e){
         cout << e.what() <<endl; failures.push_back("testElasticFoundation");
@@ -138,6 +155,12 @@ int main() {
         failures.push_back("testSmoothSphereHalfSpaceForce");
     }
 
+    try { testSmoothSphereHalfSpaceForceGroup(); }
+    catch (const std::exception& e){
+        cout << e.what() <<endl;
+        failures.push_back("testSmoothSphereHalfSpaceForceGroup");
+    }
+
     try { testCoordinateLimitForce(); }
     catch (const std::exception& e){
         cout << e.what() <<endl; failures.push_back("testCoordinateLimitForce");
@@ -174,6 +197,12 @@ int main() {
         failures.push_back("testBlankevoort1991Ligament");
     }
 
+    try { testParallelForces(); }
+    catch (const std::exception& e) {
+        cout << e.what() << endl;
+        failures.push_back("testParallelForces");
+    }
+
     if (!failures.empty()) {
         cout << "Done, with failure(s): " << failures << endl;
         return 1;
@@ -1182,6 +1211,120 @@ void testExpressionBasedBushingForceRotational() {
     ASSERT(*copyOfSpring == spring);
 }
 
+void testExpressionBasedBushingForceStiffnessMatrix() {
+    using namespace SimTK;
+
+    // A bushing between ground and a body on a pin joint, so that the only
+    // nonzero deflection is theta_z, which equals the pin's coordinate.
+    Model model;
+    auto* ball = new OpenSim::Body("ball", 1.0, Vec3(0), Inertia(1.0));
+    auto* pin = new PinJoint("pin", model.getGround(), *ball);
+    model.addBody(ball);
+    model.addJoint(pin);
+
+    // The expressions share the subexpression sin(theta_z)^2.
+    const double k = 3.0;
+    auto* bushing = new ExpressionBasedBushingForce("bushing",
+            model.getGround(), Vec3(0), Vec3(0), *ball, Vec3(0), Vec3(0));
+    bushing->setMyExpression("sin(theta_z)^2");
+    bushing->setMzExpression("3*theta_z + 0.5*sin(theta_z)^2");
+    bushing->setFxExpression("theta_z*delta_x + 1");
+    model.addForce(bushing);
+
+    SimTK::State state = model.initSystem();
+    const double q = 0.3;
+    pin->updCoordinate().setValue(state, q);
+    model.realizeVelocity(state);
+
+    const Vec6 fk = bushing->calcStiffnessForce(state);
+    ASSERT_EQUAL(0.0, fk[0], 1e-12);
+    ASSERT_EQUAL(-square(sin(q)), fk[1], 1e-12);
+    ASSERT_EQUAL(-(k * q + 0.5 * square(sin(q))), fk[2], 1e-12);
+    ASSERT_EQUAL(-1.0, fk[3], 1e-12);
+
+    const Mat66 stiffness = bushing->calcStiffnessMatrix(state);
+    Mat66 expected(0);
+    expected[1][2] = sin(2 * q);
+    expected[2][2] = k + 0.5 * sin(2 * q);
+    expected[3][3] = q;
+    for (int i = 0; i < 6; ++i) {
+        for (int j = 0; j < 6; ++j) {
+            ASSERT_EQUAL(expected[i][j], stiffness[i][j], 1e-12);
+        }
+    }
+
+    // Evaluating the stiffness matrix does not disturb the force.
+    ASSERT_EQUAL(fk, bushing->calcStiffnessForce(state), 1e-12);
+
+    // Expressions may only use the deflections.
+    bushing->setMxExpression("theta_w");
+    ASSERT_THROW(OpenSim::Exception, model.finalizeFromProperties());
+}
+
+void testExpressionBasedBushingForceNativeCode() {
+    using namespace SimTK;
+
+    Model model;
+    auto* ball = new OpenSim::Body("ball", 1.0, Vec3(0), Inertia(1.0));
+    auto* free = new FreeJoint("free", model.getGround(), *ball);
+    model.addBody(ball);
+    model.addJoint(free);
+    auto* bushing = new ExpressionBasedBushingForce("bushing",
+            model.getGround(), Vec3(0), Vec3(0), *ball, Vec3(0), Vec3(0));
+    bushing->setMxExpression("10*theta_x + theta_y^3 - 2*theta_y^2.5");
+    bushing->setMyExpression("exp(-delta_x)*cos(theta_y) + max(delta_y, 0)");
+    bushing->setMzExpression("step(theta_z)*sqrt(1 + theta_z^2)");
+    bushing->setFxExpression("100*delta_x + delta_y*delta_z");
+    bushing->setFyExpression("tanh(delta_y/0.01)*abs(delta_x)");
+    bushing->setFzExpression("1000*delta_z^2 - delta_x*delta_z");
+    model.addForce(bushing);
+
+    auto deflect = [&](SimTK::State& state) {
+        const double q[] = {0.1, 0.2, 0.3, 0.01, -0.02, 0.03};
+        for (int i = 0; i < 6; ++i) {
+            model.updCoordinateSet()[i].setValue(state, q[i], false);
+        }
+        model.realizeVelocity(state);
+    };
+    SimTK::State state = model.initSystem();
+    deflect(state);
+    const Vec6 interpretedForce = bushing->calcStiffnessForce(state);
+    const Mat66 interpretedStiffness = bushing->calcStiffnessMatrix(state);
+
+    // The results do not depend on whether the expressions are compiled to
+    // native code (if there is no compiler, they are interpreted again).
+    const bool previousEnabled = CompiledExpressions::getNativeCodeEnabled();
+    const std::string previousDirectory =
+            CompiledExpressions::getNativeCodeCacheDirectory();
+    CompiledExpressions::setNativeCodeEnabled(true);
+    CompiledExpressions::setNativeCodeCacheDirectory("native_expressions");
+    SimTK::State nativeState = model.initSystem();
+    // Where there is a compiler, the expressions must actually be compiled.
+    const CompiledExpressions compiled({bushing->getFxExpression(),
+            bushing->getFzExpression()}, {"delta_x", "delta_y", "delta_z"});
+#ifndef _WIN32
+    const std::string compilerCheck =
+            CompiledExpressions::getNativeCodeCompiler() +
+            " --version > /dev/null 2>&1";
+    if (std::system(compilerCheck.c_str()) == 0) {
+        ASSERT(compiled.usesNativeCode(), __FILE__, __LINE__,
+                "Expected the expressions to be compiled to native code.");
+    }
+#endif
+    CompiledExpressions::setNativeCodeEnabled(previousEnabled);
+    CompiledExpressions::setNativeCodeCacheDirectory(previousDirectory);
+    deflect(nativeState);
+    ASSERT_EQUAL(interpretedForce, bushing->calcStiffnessForce(nativeState),
+            1e-12);
+    const Mat66 nativeStiffness = bushing->calcStiffnessMatrix(nativeState);
+    for (int i = 0; i < 6; ++i) {
+        for (int j = 0; j < 6; ++j) {
+            ASSERT_EQUAL(interpretedStiffness[i][j], nativeStiffness[i][j],
+                    1e-12);
+        }
+    }
+}
+
 // Test our wrapping of elastic foundation in OpenSim
 // Simple simulation of bouncing ball with dissipation should generate contact
 // forces that settle to ball weight.
@@ -2382,3 +2525,164 @@ void testBlankevoort1991Ligament() {
         "reference state be equal to the strain value input "
         "to setSlackLengthFromReferenceStrain().");
 }
+
+void testParallelForces() {
+    // Compute the muscle forces of the same model serially and on multiple
+    // threads; the accelerations must agree to roundoff.
+    Model serialModel("arm26.osim");
+    Model parallelModel("arm26.osim");
+    parallelModel.setNumForceThreads(3);
+    ASSERT(parallelModel.getNumForceThreads() == 3);
+    ASSERT(serialModel.getNumForceThreads() == 1);
+
+    SimTK::State& serialState = serialModel.initSystem();
+    SimTK::State& parallelState = parallelModel.initSystem();
+    ASSERT(parallelModel.getMuscles().getSize() > 3);
+    for (int i = 0; i < serialModel.getMuscles().getSize(); ++i) {
+        const double activation = 0.1 + 0.1 * i;
+        serialModel.getMuscles()[i].setActivation(serialState, activation);
+        parallelModel.getMuscles()[i].setActivation(
+                parallelState, activation);
+    }
+    for (int i = 0; i < serialState.getNU(); ++i) {
+        serialState.updU()[i] = 0.3 * (i + 1);
+        parallelState.updU()[i] = 0.3 * (i + 1);
+    }
+
+    auto compareAccelerations = [&]() {
+        serialModel.realizeAcceleration(serialState);
+        parallelModel.realizeAcceleration(parallelState);
+        for (int i = 0; i < serialState.getNU(); ++i) {
+            ASSERT_EQUAL(serialState.getUDot()[i], parallelState.getUDot()[i],
+                    1e-10 * std::max(1.0, std::abs(serialState.getUDot()[i])),
+                    __FILE__, __LINE__,
+                    "Expected forces computed on multiple threads to match "
+                    "those computed serially.");
+        }
+    };
+    compareAccelerations();
+
+    // Disabled forces are skipped.
+    const SimTK::Vector udotBefore = parallelState.getUDot();
+    serialModel.getMuscles()[0].setAppliesForce(serialState, false);
+    parallelModel.getMuscles()[0].setAppliesForce(parallelState, false);
+    compareAccelerations();
+    ASSERT((udotBefore - parallelState.getUDot()).normRMS() > 0);
+
+    // A copy of the model keeps the setting.
+    Model copy(parallelModel);
+    ASSERT(copy.getNumForceThreads() == 3);
+}
+
+// A SmoothSphereHalfSpaceForceGroup must apply the same forces as one
+// SmoothSphereHalfSpaceForce per sphere.
+void testSmoothSphereHalfSpaceForceGroup() {
+    using SimTK::Vec3;
+    const std::vector<Vec3> locations{
+            {0.1, -0.02, 0.03}, {-0.08, -0.03, -0.02}, {0.02, -0.025, 0.07}};
+    const std::vector<double> radii{0.03, 0.035, 0.025};
+
+    // If grouped is true, the model uses one SmoothSphereHalfSpaceForceGroup
+    // instead of one SmoothSphereHalfSpaceForce per sphere.
+    auto createModel = [&](bool grouped) {
+        Model model;
+        model.setName(grouped ? "grouped" : "individual");
+        auto* foot = new OpenSim::Body("foot", 1.0, Vec3(0),
+                SimTK::Inertia(0.01, 0.02, 0.015));
+        model.addBody(foot);
+        model.addJoint(new FreeJoint("free", model.getGround(), *foot));
+        auto* floor = new ContactHalfSpace(Vec3(0), Vec3(0, 0, -SimTK::Pi / 2),
+                model.getGround(), "floor");
+        model.addContactGeometry(floor);
+
+        SmoothSphereHalfSpaceForce parameters;
+        parameters.set_stiffness(3067776);
+        parameters.set_dissipation(2);
+        parameters.set_static_friction(0.8);
+        parameters.set_dynamic_friction(0.8);
+        parameters.set_viscous_friction(0.5);
+        parameters.set_transition_velocity(0.2);
+
+        auto* group = new SmoothSphereHalfSpaceForceGroup("contact", *floor);
+        group->setContactParameters(parameters);
+        for (int i = 0; i < (int)locations.size(); ++i) {
+            const std::string name = "sphere" + std::to_string(i);
+            auto* sphere = new ContactSphere(radii[i], locations[i], *foot,
+                    name);
+            model.addContactGeometry(sphere);
+            if (grouped) {
+                group->addSphere(*sphere);
+            } else {
+                auto* force = new SmoothSphereHalfSpaceForce(
+                        "contact_" + name, *sphere, *floor);
+                force->set_stiffness(parameters.get_stiffness());
+                force->set_dissipation(parameters.get_dissipation());
+                force->set_static_friction(parameters.get_static_friction());
+                force->set_dynamic_friction(parameters.get_dynamic_friction());
+                force->set_viscous_friction(parameters.get_viscous_friction());
+                force->set_transition_velocity(
+                        parameters.get_transition_velocity());
+                model.addForce(force);
+            }
+        }
+        if (grouped) {
+            model.addForce(group);
+        } else {
+            delete group;
+        }
+        model.finalizeConnections();
+        return model;
+    };
+
+    Model individual = createModel(false);
+    Model grouped = createModel(true);
+    SimTK::State& individualState = individual.initSystem();
+    SimTK::State& groupedState = grouped.initSystem();
+    // A copy must keep the spheres.
+    Model copy(grouped);
+    copy.initSystem();
+    ASSERT(copy.getComponent<SmoothSphereHalfSpaceForceGroup>(
+            "/forceset/contact").getNumSpheres() == 3);
+
+    // The spheres touch the floor at some of these heights and not at
+    // others; the body slides and rotates.
+    const auto& group = grouped.getComponent<SmoothSphereHalfSpaceForceGroup>(
+            "/forceset/contact");
+    for (double height : {0.08, 0.055, 0.05, 0.045}) {
+        for (auto* state : {&individualState, &groupedState}) {
+            state->updQ() = 0;
+            state->updQ()[0] = 0.1;  // Rotations about X, Y, Z.
+            state->updQ()[1] = -0.05;
+            state->updQ()[2] = 0.08;
+            state->updQ()[4] = height;  // Translation along Y.
+            for (int i = 0; i < state->getNU(); ++i) {
+                state->updU()[i] = 0.2 * (i + 1) * (i % 2 ? -1 : 1);
+            }
+        }
+        individual.realizeAcceleration(individualState);
+        grouped.realizeAcceleration(groupedState);
+        for (int i = 0; i < groupedState.getNU(); ++i) {
+            ASSERT_EQUAL(individualState.getUDot()[i],
+                    groupedState.getUDot()[i],
+                    1e-10 * std::max(1.0,
+                                    std::abs(individualState.getUDot()[i])),
+                    __FILE__, __LINE__,
+                    "Expected the grouped contact force to match the "
+                    "individual contact forces.");
+        }
+
+        // The recorded force on each sphere matches that of the
+        // corresponding individual force.
+        const auto values = group.getRecordValues(groupedState);
+        ASSERT(values.size() == 6 * ((int)locations.size() + 1));
+        for (int i = 0; i < (int)locations.size(); ++i) {
+            const auto& force = individual.getComponent<Force>(
+                    "/forceset/contact_sphere" + std::to_string(i));
+            const auto expected = force.getRecordValues(individualState);
+            for (int j = 0; j < 6; ++j) {
+                ASSERT_EQUAL(expected[j], values[6 * i + j],
+                        1e-10 * std::max(1.0, std::abs(expected[j])));
+            }
+        }
+    }
+}
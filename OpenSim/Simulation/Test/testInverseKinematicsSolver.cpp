@@ -32,7 +32,9 @@
 #include <OpenSim/Common/MarkerData.h>
 #include <OpenSim/Common/Constant.h>
 #include <OpenSim/Common/STOFileAdapter.h>
+#include <chrono>
 #include <random>
+#include <thread>
 
 using namespace OpenSim;
 using namespace std;
@@ -88,6 +90,17 @@ void testTrackWithUpdateMarkerWeights();
 // includes intervals with NaNs (no observation)
 void testNumberOfMarkersMismatch();
 void testNumberOfOrientationsMismatch();
+// Verify that RealTimeIMUInverseKinematics solves streamed frames to the same
+// coordinates as the model that generated them, both when driven by the
+// caller and on its worker thread, and that it accounts for every frame.
+void testRealTimeIMUInverseKinematics();
+// Verify that the solver records the most recent calls to assemble() and
+// track() in its ring buffer of performance records.
+void testPerformanceRecords();
+// Verify that track() with least squares reaches the same coordinates as the
+// Assembler for marker and orientation sensor goals, and that it falls back
+// to the Assembler when the model has a constraint.
+void testLeastSquaresTracking();
 
 int main()
 {
@@ -131,6 +144,24 @@ int main()
         failures.push_back("testNumberOfOrientationsMismatch");
     }
 
+    try { testRealTimeIMUInverseKinematics(); }
+    catch (const std::exception& e) {
+        cout << e.what() << endl;
+        failures.push_back("testRealTimeIMUInverseKinematics");
+    }
+
+    try { testPerformanceRecords(); }
+    catch (const std::exception& e) {
+        cout << e.what() << endl;
+        failures.push_back("testPerformanceRecords");
+    }
+
+    try { testLeastSquaresTracking(); }
+    catch (const std::exception& e) {
+        cout << e.what() << endl;
+        failures.push_back("testLeastSquaresTracking");
+    }
+
     if (!failures.empty()) {
         cout << "Done, with failure(s): " << failures << endl;
         return 1;
@@ -210,6 +241,30 @@ void testMarkersReference()
         SimTK_ASSERT_ALWAYS(weights[i] == double(i),
             "Mismatched weight to marker.");
     }
+
+    // Only markers with weights are kept, in the order of the data, and the
+    // values at a time are those of the nearest row.
+    for (size_t r{0}; r < nr; ++r) {
+        for (size_t c{0}; c < nc; ++c) {
+            markerData.updMatrix()(int(r), int(c)) =
+                    SimTK::Vec3(double(r), double(c), 0);
+        }
+    }
+    Set<MarkerWeight> subsetWeights;
+    subsetWeights.adoptAndAppend(new MarkerWeight("E", 1.0));
+    subsetWeights.adoptAndAppend(new MarkerWeight("B", 2.0));
+    MarkersReference markersRef3(markerData, subsetWeights);
+    SimTK_TEST(markersRef3.getNumRefs() == 2);
+    SimTK_TEST(markersRef3.getNames()[0] == "B");
+    SimTK_TEST(markersRef3.getNames()[1] == "E");
+    const auto frame = markersRef3.getValuesViewAtTime(0.21);
+    SimTK::Array_<SimTK::Vec3> values;
+    markersRef3.getValuesAtTime(0.21, values);
+    SimTK_TEST(frame.size() == 2);
+    SimTK_TEST_EQ(frame[0], SimTK::Vec3(2, 1, 0));
+    SimTK_TEST_EQ(frame[1], SimTK::Vec3(2, 4, 0));
+    SimTK_TEST(values.size() == 2);
+    SimTK_TEST_EQ(values[1], frame[1]);
 }
 
 void testOrientationsReference() {
@@ -806,6 +861,306 @@ void testNumberOfOrientationsMismatch()
     }
 }
 
+void testRealTimeIMUInverseKinematics()
+{
+    cout <<
+        "\ntestInverseKinematicsSolver::testRealTimeIMUInverseKinematics()"
+        << endl;
+
+    std::unique_ptr<Model> leg{ constructLegWithOrientationFrames() };
+    const auto& coords = leg->getCoordinateSet();
+
+    SimTK::State state = leg->initSystem();
+    StatesTrajectory states;
+    double dt = 0.01;
+    int N = 51;
+    for (int i = 0; i < N; ++i) {
+        state.updTime() = i*dt;
+        coords[0].setValue(state, i*dt*SimTK::Pi / 3, false);
+        coords[1].setValue(state, -i*dt*SimTK::Pi / 4, false);
+        coords[2].setValue(state, 0.2*sin(2*SimTK::Pi*i*dt), false);
+        leg->assemble(state);
+        states.append(state);
+    }
+    SimTK::RowVector_<SimTK::Rotation> biases(3, SimTK::Rotation());
+    auto orientationsTable = generateOrientationsDataFromModelAndStates(
+            *leg, states, biases, 0.0);
+    const auto& labels = orientationsTable.getColumnLabels();
+
+    RealTimeIMUInverseKinematics realTimeIK(*leg,
+            std::vector<std::string>(labels.begin(), labels.end()));
+    SimTK_TEST(realTimeIK.getCoordinateNames().size() == 3);
+    // Solve every frame, on this thread.
+    realTimeIK.setTimeBudget(SimTK::Infinity);
+    realTimeIK.setAccuracy(1e-6);
+    for (int i = 0; i < N; ++i) {
+        realTimeIK.pushFrame(orientationsTable.getIndependentColumn()[i],
+                orientationsTable.getRowAtIndex(i));
+    }
+    int numSolved = 0;
+    while (realTimeIK.solveNext()) {
+        const auto solution = realTimeIK.getLatestSolution();
+        SimTK_TEST(solution.frameIndex == numSolved);
+        const auto& expected = states.get(numSolved);
+        SimTK_TEST_EQ(solution.time, expected.getTime());
+        for (int j = 0; j < coords.getSize(); ++j) {
+            SimTK_TEST_EQ_TOL(solution.coordinates[j],
+                    coords[j].getValue(expected), 1e-4);
+        }
+        ++numSolved;
+    }
+    SimTK_TEST(numSolved == N);
+    auto stats = realTimeIK.getLatencyStatistics();
+    SimTK_TEST(stats.numFramesReceived == N);
+    SimTK_TEST(stats.numFramesSolved == N);
+    SimTK_TEST(stats.numFramesDropped == 0);
+    SimTK_TEST(stats.numFramesFailed == 0);
+    SimTK_TEST(stats.maxSolveTime >= stats.meanSolveTime);
+    cout << "Mean solve time: " << stats.meanSolveTime << " s." << endl;
+
+    // Stream the frames again (backwards in time, which track() handles as
+    // well) to the worker thread, as fast as we can; frames may be dropped,
+    // but every frame must be accounted for.
+    realTimeIK.resetLatencyStatistics();
+    realTimeIK.setTimeBudget(0.01);
+    int numCallbacks = 0;
+    realTimeIK.setSolutionCallback(
+            [&numCallbacks](const RealTimeIMUInverseKinematics::Solution&) {
+                ++numCallbacks;
+            });
+    realTimeIK.start();
+    SimTK_TEST_MUST_THROW_EXC(realTimeIK.solveNext(), OpenSim::Exception);
+    for (int i = N - 1; i >= 0; --i) {
+        realTimeIK.pushFrame(orientationsTable.getIndependentColumn()[i],
+                orientationsTable.getRowAtIndex(i));
+    }
+    auto numHandled = [&realTimeIK]() {
+        const auto stats = realTimeIK.getLatencyStatistics();
+        return stats.numFramesSolved + stats.numFramesDropped +
+               stats.numFramesFailed;
+    };
+    while (numHandled() < N) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    realTimeIK.stop();
+    stats = realTimeIK.getLatencyStatistics();
+    SimTK_TEST(stats.numFramesReceived == N);
+    SimTK_TEST(stats.numFramesFailed == 0);
+    SimTK_TEST(stats.numFramesSolved == numCallbacks);
+    // The last frame is never dropped.
+    const auto solution = realTimeIK.getLatestSolution();
+    SimTK_TEST(solution.frameIndex == 2*N - 1);
+    for (int j = 0; j < coords.getSize(); ++j) {
+        SimTK_TEST_EQ_TOL(solution.coordinates[j],
+                coords[j].getValue(states.get(0)), 1e-4);
+    }
+    cout << "Solved " << stats.numFramesSolved << " of " << N
+         << " frames; mean latency: " << stats.meanLatency << " s." << endl;
+}
+
+void testPerformanceRecords()
+{
+    cout << "\ntestInverseKinematicsSolver::testPerformanceRecords()" << endl;
+
+    std::unique_ptr<Model> pendulum{ constructPendulumWithMarkers() };
+    const Coordinate& coord = pendulum->getCoordinateSet()[0];
+
+    SimTK::State state = pendulum->initSystem();
+    StatesTrajectory states;
+    double dt = 0.1;
+    int N = 11;
+    for (int i = 0; i < N; ++i) {
+        state.updTime() = i*dt;
+        coord.setValue(state, i*dt*SimTK::Pi / 3);
+        states.append(state);
+    }
+    SimTK::RowVector_<SimTK::Vec3> biases(3, SimTK::Vec3(0));
+    std::shared_ptr<MarkersReference> markersRef(
+            new MarkersReference(generateMarkerDataFromModelAndStates(
+                    *pendulum, states, biases), Set<MarkerWeight>()));
+
+    SimTK::Array_<CoordinateReference> coordRefs;
+    InverseKinematicsSolver ikSolver(*pendulum, markersRef, coordRefs);
+    ikSolver.setAccuracy(1e-6);
+
+    // Disabled by default.
+    coord.setValue(state, 0.0);
+    state.updTime() = 0;
+    ikSolver.assemble(state);
+    SimTK_TEST(ikSolver.getNumPerformanceRecords() == 0);
+    SimTK_TEST(ikSolver.getPerformanceTable().getNumRows() == 0);
+
+    const int capacity = 5;
+    ikSolver.setPerformanceRecordCapacity(capacity);
+    ikSolver.assemble(state);
+    SimTK_TEST(ikSolver.getNumPerformanceRecords() == 1);
+    SimTK_TEST(!ikSolver.getPerformanceRecord(0).isTrack);
+    SimTK_TEST(ikSolver.getPerformanceRecord(0).converged);
+
+    SimTK::Array_<double> markerErrors;
+    const auto& times = markersRef->getMarkerTable().getIndependentColumn();
+    for (double t : times) {
+        state.updTime() = t;
+        ikSolver.track(state);
+        ikSolver.computeCurrentMarkerErrors(markerErrors);
+    }
+
+    // Only the most recent records are kept, oldest first.
+    SimTK_TEST(ikSolver.getNumPerformanceRecords() == capacity);
+    for (int i = 0; i < capacity; ++i) {
+        const auto& record = ikSolver.getPerformanceRecord(i);
+        SimTK_TEST(record.isTrack);
+        SimTK_TEST(record.converged);
+        SimTK_TEST_EQ(record.time, times[N - capacity + i]);
+        SimTK_TEST(record.numGoalEvals > 0);
+        SimTK_TEST(record.solveTime >= record.goalsTime);
+    }
+    SimTK_TEST_MUST_THROW_EXC(
+            ikSolver.getPerformanceRecord(capacity), IndexOutOfRange);
+
+    TimeSeriesTable table = ikSolver.getPerformanceTable();
+    SimTK_TEST(table.getNumRows() == capacity);
+    SimTK_TEST(table.getColumnLabel(5) == "solve_time");
+    SimTK_TEST_EQ(table.getIndependentColumn().back(), times.back());
+    SimTK_TEST_EQ(table.getDependentColumn("solve_time")[capacity - 1],
+            ikSolver.getPerformanceRecord(capacity - 1).solveTime);
+
+    // A call at an earlier time replaces the rows at or after its time (and
+    // the oldest record is dropped from the buffer).
+    state.updTime() = times[N - 2];
+    ikSolver.assemble(state);
+    table = ikSolver.getPerformanceTable();
+    SimTK_TEST(table.getNumRows() == capacity - 2);
+    SimTK_TEST_EQ(table.getIndependentColumn().back(), times[N - 2]);
+    SimTK_TEST(table.getDependentColumn("is_track")[capacity - 3] == 0);
+
+    ikSolver.clearPerformanceRecords();
+    SimTK_TEST(ikSolver.getNumPerformanceRecords() == 0);
+    SimTK_TEST(ikSolver.getPerformanceRecordCapacity() == capacity);
+}
+
+void testLeastSquaresTracking()
+{
+    cout << "\ntestInverseKinematicsSolver::testLeastSquaresTracking()"
+         << endl;
+
+    // Track the same references with both methods; the coordinates must
+    // agree to within the accuracy.
+    const double tol = 1e-6;
+    auto compare = [&](InverseKinematicsSolver& assembler,
+                           InverseKinematicsSolver& leastSquares,
+                           const Model& model, SimTK::State stateA,
+                           const std::vector<double>& times) {
+        SimTK::State stateLS = stateA;
+        assembler.setAccuracy(tol);
+        leastSquares.setAccuracy(tol);
+        leastSquares.setUseLeastSquaresTracking(true);
+        leastSquares.setPerformanceRecordCapacity(1);
+        assembler.assemble(stateA);
+        leastSquares.assemble(stateLS);
+        const auto& coords = model.getCoordinateSet();
+        for (double t : times) {
+            stateA.updTime() = t;
+            stateLS.updTime() = t;
+            assembler.track(stateA);
+            leastSquares.track(stateLS);
+            SimTK_TEST(leastSquares.getPerformanceRecord(0).converged);
+            for (int i = 0; i < coords.getSize(); ++i) {
+                SimTK_TEST_EQ_TOL(coords[i].getValue(stateLS),
+                        coords[i].getValue(stateA), 100 * tol);
+            }
+        }
+    };
+
+    // Orientation sensors.
+    {
+        std::unique_ptr<Model> leg{ constructLegWithOrientationFrames() };
+        const auto& coords = leg->getCoordinateSet();
+        SimTK::State state = leg->initSystem();
+        StatesTrajectory states;
+        for (int i = 0; i < 11; ++i) {
+            state.updTime() = i * 0.1;
+            for (int j = 0; j < coords.getSize(); ++j) {
+                coords[j].setValue(state, 0.3 * (j + 1) * sin(i * 0.1));
+            }
+            states.append(state);
+        }
+        SimTK::RowVector_<SimTK::Rotation> biases(3, SimTK::Rotation());
+        biases[1] *= SimTK::Rotation(0.05, SimTK::ZAxis);
+        auto orientationsTable = generateOrientationsDataFromModelAndStates(
+                *leg, states, biases, 0.0, true);
+        std::shared_ptr<OrientationsReference> orientationsRef(
+                new OrientationsReference(orientationsTable));
+
+        SimTK::Array_<CoordinateReference> coordRefs;
+        InverseKinematicsSolver assembler(
+                *leg, nullptr, orientationsRef, coordRefs);
+        InverseKinematicsSolver leastSquares(
+                *leg, nullptr, orientationsRef, coordRefs);
+        for (int j = 0; j < coords.getSize(); ++j) {
+            coords[j].setValue(state, 0.0);
+        }
+        state.updTime() = 0;
+        compare(assembler, leastSquares, *leg, state,
+                orientationsTable.getIndependentColumn());
+    }
+
+    // Markers, with a coordinate goal.
+    {
+        std::unique_ptr<Model> pendulum{ constructPendulumWithMarkers() };
+        const Coordinate& coord = pendulum->getCoordinateSet()[0];
+        SimTK::State state = pendulum->initSystem();
+        StatesTrajectory states;
+        for (int i = 0; i < 11; ++i) {
+            state.updTime() = i * 0.1;
+            coord.setValue(state, i * 0.1 * SimTK::Pi / 3);
+            states.append(state);
+        }
+        SimTK::RowVector_<SimTK::Vec3> biases(3, SimTK::Vec3(0));
+        biases[1] = SimTK::Vec3(0.01, 0, 0);
+        std::shared_ptr<MarkersReference> markersRef(
+                new MarkersReference(generateMarkerDataFromModelAndStates(
+                        *pendulum, states, biases), Set<MarkerWeight>()));
+
+        SimTK::Array_<CoordinateReference> coordRefs;
+        coordRefs.push_back(
+                CoordinateReference(coord.getName(), Constant(0.5)));
+        coordRefs.back().setWeight(0.01);
+        InverseKinematicsSolver assembler(*pendulum, markersRef, coordRefs);
+        InverseKinematicsSolver leastSquares(*pendulum, markersRef, coordRefs);
+        coord.setValue(state, 0.0);
+        state.updTime() = 0;
+        compare(assembler, leastSquares, *pendulum, state,
+                markersRef->getMarkerTable().getIndependentColumn());
+
+        // A constraint other than a lock requires the Assembler, so the
+        // solvers must still agree.
+        Body* arm = new Body("arm", 1.0, SimTK::Vec3(0),
+                SimTK::Inertia::cylinderAlongY(0.05, 0.5));
+        pendulum->addBody(arm);
+        PinJoint* shoulder = new PinJoint("shoulder", pendulum->getGround(),
+                SimTK::Vec3(0, 2.0, 0), SimTK::Vec3(0), *arm,
+                SimTK::Vec3(0, 0.25, 0), SimTK::Vec3(0));
+        shoulder->updCoordinate().setName("phi");
+        pendulum->addJoint(shoulder);
+        CoordinateCouplerConstraint* coupler = new CoordinateCouplerConstraint();
+        Array<std::string> independent;
+        independent.append(coord.getName());
+        coupler->setIndependentCoordinateNames(independent);
+        coupler->setDependentCoordinateName("phi");
+        coupler->setFunction(LinearFunction(0.5, 0));
+        pendulum->addConstraint(coupler);
+        state = pendulum->initSystem();
+
+        InverseKinematicsSolver constrainedAssembler(
+                *pendulum, markersRef, coordRefs);
+        InverseKinematicsSolver constrainedLeastSquares(
+                *pendulum, markersRef, coordRefs);
+        compare(constrainedAssembler, constrainedLeastSquares, *pendulum,
+                state, markersRef->getMarkerTable().getIndependentColumn());
+    }
+}
+
 Model* constructPendulumWithMarkers()
 {
     Model* pendulum = new Model();
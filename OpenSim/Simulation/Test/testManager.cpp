@@ -47,6 +47,8 @@ Manager Tests:
 #include <OpenSim/Common/LoadOpenSimLibrary.h>
 #include <OpenSim/Simulation/Control/PrescribedController.h>
 #include <OpenSim/Common/Constant.h>
+#include <OpenSim/Common/Storage.h>
+#include <fstream>
 
 using namespace OpenSim;
 using namespace std;
@@ -56,6 +58,7 @@ void testExcitationUpdatesWithManager();
 void testConstructors();
 void testIntegratorInterface();
 void testExceptions();
+void testStatesRecording();
 
 int main()
 {
@@ -97,6 +100,12 @@ int main()
         failures.push_back("testExceptions");
     }
 
+    try { testStatesRecording(); }
+    catch (const std::exception& e) {
+        cout << e.what() << endl;
+        failures.push_back("testStatesRecording");
+    }
+
     if (!failures.empty()) {
         cout << "Done, with failure(s): " << failures << endl;
         return 1;
@@ -478,3 +487,75 @@ void testExceptions()
     manager.setIntegratorAccuracy(1e-4);
     manager.setIntegratorMinimumStepSize(0.01);
 }
+
+void testStatesRecording()
+{
+    cout << "Running testStatesRecording" << endl;
+    LoadOpenSimLibrary("osimActuators");
+    Model arm("arm26.osim");
+    SimTK::State& state = arm.initSystem();
+    arm.equilibrateMuscles(state);
+
+    // The Manager records states by reading Y directly; coordinate values,
+    // speeds, and muscle states are all elements of Y.
+    const auto yIndices = arm.getStateVariableSystemIndices(state);
+    const SimTK::Vector values = arm.getStateVariableValues(state);
+    SimTK_TEST((int)yIndices.size() == arm.getNumStateVariables());
+    for (int i = 0; i < (int)yIndices.size(); ++i) {
+        SimTK_TEST(yIndices[i].isValid());
+        SimTK_TEST(state.getY()[yIndices[i]] == values[i]);
+    }
+
+    // Record into the Manager's buffer (the default) and into a provided
+    // Storage; integrate in multiple calls to exercise appending.
+    Manager manager(arm);
+    manager.setIntegratorMaximumStepSize(0.001);
+    manager.initialize(state);
+    manager.integrate(0.3);
+    const SimTK::State& finalState = manager.integrate(0.6);
+
+    Manager managerWithStorage(arm);
+    managerWithStorage.setStateStorage(*new Storage(512, "states"));
+    managerWithStorage.getStateStorage().setColumnLabels(
+            manager.getStateStorage().getColumnLabels());
+    managerWithStorage.setIntegratorMaximumStepSize(0.001);
+    managerWithStorage.initialize(state);
+    managerWithStorage.integrate(0.3);
+    managerWithStorage.integrate(0.6);
+
+    const TimeSeriesTable table = manager.getStatesTable();
+    const TimeSeriesTable expected = managerWithStorage.getStatesTable();
+    SimTK_TEST(table.getNumRows() > 500);
+    SimTK_TEST(table.getNumRows() == expected.getNumRows());
+    SimTK_TEST(table.getColumnLabels() == expected.getColumnLabels());
+    SimTK_TEST(table.getIndependentColumn() ==
+               expected.getIndependentColumn());
+    SimTK_TEST_EQ(table.getMatrix(), expected.getMatrix());
+    SimTK_TEST_EQ(table.getIndependentColumn().back(), finalState.getTime());
+    SimTK_TEST_EQ(SimTK::Vector(
+            table.getRowAtIndex(table.getNumRows() - 1).transpose()),
+            arm.getStateVariableValues(finalState));
+
+    // The Storage is filled from the buffer when requested.
+    const Storage& storage = manager.getStateStorage();
+    SimTK_TEST(storage.getSize() == (int)table.getNumRows());
+    SimTK_TEST_EQ(storage.exportToTable().getMatrix(), table.getMatrix());
+
+    // A Storage with an output file is written as the states are recorded,
+    // without asking the Manager for the Storage.
+    Manager managerWithFile(arm);
+    managerWithFile.getStateStorage().setOutputFileName(
+            "testManager_states_streamed.sto");
+    managerWithFile.setIntegratorMaximumStepSize(0.001);
+    managerWithFile.initialize(state);
+    managerWithFile.integrate(0.6);
+    std::ifstream file("testManager_states_streamed.sto");
+    std::string line;
+    while (std::getline(file, line) && line != "endheader") {}
+    std::getline(file, line); // column labels
+    int numRowsInFile = 0;
+    while (std::getline(file, line)) {
+        if (!line.empty()) ++numRowsInFile;
+    }
+    SimTK_TEST(numRowsInFile >= (int)table.getNumRows());
+}
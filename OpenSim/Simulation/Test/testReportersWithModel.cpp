@@ -24,6 +24,7 @@
 
 #include <OpenSim/Common/LogSink.h>
 #include <OpenSim/Common/Logger.h>
+#include <OpenSim/Common/OutputPlan.h>
 #include <OpenSim/Common/Reporter.h>
 #include <OpenSim/Simulation/Manager/Manager.h>
 #include <OpenSim/Simulation/Model/Model.h>
@@ -116,9 +117,71 @@ void testTableReporterLabels() {
     SimTK_TEST(headings[1] == "height");
 }
 
+void testOutputPlan() {
+    // Create a model consisting of a falling ball.
+    Model model;
+    model.setName("world");
+
+    auto* ball = new OpenSim::Body("ball", 1., Vec3(0), Inertia(0));
+    model.addBody(ball);
+
+    auto* slider = new SliderJoint("slider", model.getGround(), Vec3(0),
+        Vec3(0,0,Pi/2.), *ball, Vec3(0), Vec3(0,0,Pi/2.));
+    model.addJoint(slider);
+
+    // The plan should produce the same labels as a TableReporter.
+    auto* reporter = new TableReporter();
+    reporter->set_report_time_interval(0.1);
+    const auto& coord = slider->getCoordinate();
+    reporter->addToReport(coord.getOutput("acceleration"));
+    reporter->addToReport(coord.getOutput("speed"));
+    reporter->addToReport(coord.getOutput("value"));
+    model.addComponent(reporter);
+
+    State& state = model.initSystem();
+    Manager manager(model);
+    state.setTime(0.0);
+    manager.initialize(state);
+    state = manager.integrate(1.0);
+
+    // Outputs are matched by regular expression; each output is added once
+    // even if multiple expressions match, and outputs of other types (e.g.,
+    // the SpatialVec acceleration of the ball) are skipped.
+    OutputPlan<double> plan;
+    const int numAdded = plan.addOutputsMatching(model,
+            {".*sliderCoord\\|(value|speed)", ".*\\|acceleration",
+                    ".*\\|value"});
+    SimTK_TEST(numAdded == 3);
+    SimTK_TEST(plan.getNumChannels() == 3);
+    SimTK_TEST(plan.getRequiredStage() == Stage::Acceleration);
+    SimTK_TEST(plan.getLabels() == reporter->getTable().getColumnLabels());
+
+    // Evaluating requires the state to be realized far enough.
+    RowVector row(plan.getNumChannels(), SimTK::NaN);
+    model.realizePosition(state);
+    SimTK_TEST_MUST_THROW_EXC(plan.evaluate(state, row),
+            SimTK::Exception::StageTooLow);
+    // ...but channels of a lower stage can be evaluated already.
+    plan.evaluate(state, Stage::Model, row);
+    SimTK_TEST(row[2] == coord.getValue(state));
+    SimTK_TEST(SimTK::isNaN(row[0]));
+
+    // Columns are in the order in which the outputs were found.
+    model.realizeAcceleration(state);
+    plan.evaluate(state, row);
+    SimTK_TEST(row[0] == coord.getAccelerationValue(state));
+    SimTK_TEST(row[1] == coord.getSpeedValue(state));
+    SimTK_TEST(row[2] == coord.getValue(state));
+
+    // The row must have the correct size.
+    RowVector wrongSize(2);
+    SimTK_TEST_MUST_THROW_EXC(plan.evaluate(state, wrongSize), Exception);
+}
+
 int main() {
     SimTK_START_TEST("testReporters");
         SimTK_SUBTEST(testConsoleReporterLabels);
         SimTK_SUBTEST(testTableReporterLabels);
+        SimTK_SUBTEST(testOutputPlan);
     SimTK_END_TEST();
 };
@@ -21,22 +21,34 @@
  * limitations under the License.                                             *
  * -------------------------------------------------------------------------- */
 
+#include <OpenSim/Actuators/ModelFactory.h>
 #include <OpenSim/Auxiliary/auxiliaryTestFunctions.h>
 #include <OpenSim/Simulation/Model/Model.h>
 #include <OpenSim/Simulation/SimbodyEngine/FreeJoint.h>
 #include <OpenSim/Simulation/SimulationUtilities.h>
+#include <OpenSim/Simulation/ModelCache.h>
+#include <OpenSim/Simulation/EnsembleSimulator.h>
+#include <OpenSim/Simulation/Manager/Manager.h>
+#include <OpenSim/Common/CommonUtilities.h>
 #include <OpenSim/Common/LoadOpenSimLibrary.h>
+#include <OpenSim/Common/XMLDocument.h>
 
 using namespace OpenSim;
 using namespace std;
 
 void testUpdatePre40KinematicsFor40MotionType();
+void testModelCache();
+void testAnalyzeParallel();
+void testEnsembleSimulator();
 
 int main() {
     LoadOpenSimLibrary("osimActuators");
 
     SimTK_START_TEST("testSimulationUtilities");
         SimTK_SUBTEST(testUpdatePre40KinematicsFor40MotionType);
+        SimTK_SUBTEST(testModelCache);
+        SimTK_SUBTEST(testAnalyzeParallel);
+        SimTK_SUBTEST(testEnsembleSimulator);
     SimTK_END_TEST();
 }
 
@@ -193,3 +205,225 @@ void testUpdatePre40KinematicsFor40MotionType() {
 
 
 
+
+void testModelCache() {
+    const std::string modelFile = "testSimulationUtilities_ModelCache.osim";
+    const std::string forcesFile =
+            "testSimulationUtilities_ModelCache_forces.xml";
+    {
+        // The forces are written to (and read from) a separate file.
+        Model model("arm26.osim");
+        model.updForceSet().setInlined(false, forcesFile);
+        model.print(modelFile);
+    }
+    FileRemover fileRemover(modelFile);
+    FileRemover forcesFileRemover(forcesFile);
+
+    ModelCache cache;
+    SimTK_TEST(!cache.contains(modelFile));
+
+    // The first load reads the file; the second is served from the cache.
+    auto first = cache.load(modelFile);
+    SimTK_TEST(cache.getNumMisses() == 1);
+    SimTK_TEST(cache.getNumHits() == 0);
+    SimTK_TEST(cache.contains(modelFile));
+    auto second = cache.load(modelFile);
+    SimTK_TEST(cache.getNumMisses() == 1);
+    SimTK_TEST(cache.getNumHits() == 1);
+    SimTK_TEST(cache.getNumEntries() == 1);
+    SimTK_TEST(second->getInputFileName() == modelFile);
+    SimTK_TEST(second->isEqualTo(*first));
+
+    // Copies keep their documents, so the forces are printed to their own
+    // file instead of being inlined.
+    SimTK_TEST(second->getDocumentFileVersion() ==
+               XMLDocument::getLatestVersion());
+    SimTK_TEST(!second->getForceSet().getInlined());
+    SimTK_TEST(second->getForceSet().getDocumentFileName() == forcesFile);
+
+    // Copies are independent of each other and of the cache.
+    second->setName("edited");
+    auto third = cache.load(modelFile);
+    SimTK_TEST(third->getName() == first->getName());
+    third->initSystem();
+
+    // Changing the file on disk invalidates the entry.
+    {
+        Model model(modelFile);
+        model.setName("changed_on_disk");
+        model.print(modelFile);
+    }
+    SimTK_TEST(!cache.contains(modelFile));
+    auto fourth = cache.load(modelFile);
+    SimTK_TEST(fourth->getName() == "changed_on_disk");
+    SimTK_TEST(cache.getNumMisses() == 2);
+    SimTK_TEST(cache.getNumEntries() == 1);
+
+    cache.clear();
+    SimTK_TEST(cache.getNumEntries() == 0);
+    SimTK_TEST_MUST_THROW_EXC(cache.load("nonexistent_file.osim"), Exception);
+}
+
+void testAnalyzeParallel() {
+    Model model = ModelFactory::createDoublePendulum();
+    model.initSystem();
+    const auto stateNames = createStateVariableNamesInSystemOrder(model);
+    const auto controlNames = createControlNamesFromModel(model);
+
+    const int numRows = 23;
+    std::vector<double> time(numRows);
+    SimTK::Matrix states(numRows, (int)stateNames.size());
+    SimTK::Matrix controls(numRows, (int)controlNames.size());
+    for (int irow = 0; irow < numRows; ++irow) {
+        time[irow] = 0.01 * irow;
+        for (int icol = 0; icol < states.ncol(); ++icol) {
+            states(irow, icol) = std::sin(time[irow] + icol);
+        }
+        for (int icol = 0; icol < controls.ncol(); ++icol) {
+            controls(irow, icol) = std::cos(time[irow] + icol);
+        }
+    }
+    const TimeSeriesTable statesTable(time, states, stateNames);
+    const TimeSeriesTable controlsTable(time, controls, controlNames);
+
+    // The result must not depend on the number of threads, including when
+    // there are more threads than rows.
+    const std::vector<std::string> paths = {".*actuation", ".*speed"};
+    const auto serial = analyze<double>(model, statesTable, controlsTable,
+            paths);
+    SimTK_TEST(serial.getNumColumns() > 0);
+    for (int numThreads : {2, 3, 0, 50}) {
+        const auto parallel = analyze<double>(model, statesTable,
+                controlsTable, paths, numThreads);
+        SimTK_TEST(parallel.getColumnLabels() == serial.getColumnLabels());
+        SimTK_TEST(parallel.getIndependentColumn() ==
+                serial.getIndependentColumn());
+        SimTK_TEST_EQ(SimTK::Matrix(parallel.getMatrix()),
+                SimTK::Matrix(serial.getMatrix()));
+    }
+
+    // The blocks are split by row index, which also works for a controls
+    // table without any columns.
+    const TimeSeriesTable noControlsTable(time);
+    const auto serialNoControls = analyze<double>(model, statesTable,
+            noControlsTable, paths);
+    const auto parallelNoControls = analyze<double>(model, statesTable,
+            noControlsTable, paths, 3);
+    SimTK_TEST(parallelNoControls.getIndependentColumn() == time);
+    SimTK_TEST_EQ(SimTK::Matrix(parallelNoControls.getMatrix()),
+            SimTK::Matrix(serialNoControls.getMatrix()));
+
+    const std::vector<std::string> vec3Paths = {"/bodyset/.*position"};
+    const auto serialVec3 = analyze<SimTK::Vec3>(model, statesTable,
+            controlsTable, vec3Paths);
+    const auto parallelVec3 = analyze<SimTK::Vec3>(model, statesTable,
+            controlsTable, vec3Paths, 4);
+    SimTK_TEST(parallelVec3.getNumRows() == (size_t)numRows);
+    SimTK_TEST_EQ(SimTK::Matrix_<SimTK::Vec3>(parallelVec3.getMatrix()),
+            SimTK::Matrix_<SimTK::Vec3>(serialVec3.getMatrix()));
+}
+
+void testEnsembleSimulator() {
+    Model model = ModelFactory::createDoublePendulum();
+    const double finalTime = 0.5;
+    const double accuracy = 1e-8;
+
+    EnsembleSimulator ensemble(model);
+    ensemble.setFinalTime(finalTime);
+    ensemble.setIntegratorAccuracy(accuracy);
+    const std::vector<double> q0Values = {-0.3, -0.1, 0.0, 0.2, 0.4};
+    for (double q0 : q0Values) {
+        EnsembleSimulator::Member member;
+        member.name = "q0_" + std::to_string(q0);
+        member.stateVariableValues.push_back({"/jointset/j0/q0/value", q0});
+        ensemble.addMember(member);
+    }
+    // A member that modifies the model.
+    {
+        EnsembleSimulator::Member member;
+        member.name = "heavy";
+        member.stateVariableValues.push_back({"/jointset/j0/q0/value", 0.1});
+        member.modifyModel = [](Model& model) {
+            model.updBodySet().get("b1").setMass(5.0);
+        };
+        ensemble.addMember(member);
+    }
+    // A member that fails.
+    {
+        EnsembleSimulator::Member member;
+        member.name = "bad";
+        member.stateVariableValues.push_back({"/jointset/j0/nonexistent", 0});
+        ensemble.addMember(member);
+    }
+
+    // Simulate a member directly, for comparison.
+    auto simulateSerially = [&](double q0, double mass) {
+        Model copy(model);
+        copy.updBodySet().get("b1").setMass(mass);
+        SimTK::State& state = copy.initSystem();
+        copy.setStateVariableValue(state, "/jointset/j0/q0/value", q0);
+        Manager manager(copy);
+        manager.setIntegratorAccuracy(accuracy);
+        manager.initialize(state);
+        manager.integrate(finalTime);
+        return manager.getStatesTable();
+    };
+
+    for (int numThreads : {1, 3}) {
+        ensemble.setNumThreads(numThreads);
+        const auto results = ensemble.run();
+        SimTK_TEST(results.size() == q0Values.size() + 2);
+        for (int i = 0; i < (int)q0Values.size(); ++i) {
+            SimTK_TEST(results[i].success);
+            SimTK_TEST(results[i].name ==
+                    "q0_" + std::to_string(q0Values[i]));
+            const auto expected = simulateSerially(q0Values[i], 1.0);
+            SimTK_TEST(results[i].states.getColumnLabels() ==
+                    expected.getColumnLabels());
+            SimTK_TEST(results[i].states.getIndependentColumn() ==
+                    expected.getIndependentColumn());
+            SimTK_TEST_EQ(SimTK::Matrix(results[i].states.getMatrix()),
+                    SimTK::Matrix(expected.getMatrix()));
+        }
+        const auto& heavy = results[q0Values.size()];
+        SimTK_TEST(heavy.success);
+        const auto expectedHeavy = simulateSerially(0.1, 5.0);
+        SimTK_TEST_EQ(SimTK::Matrix(heavy.states.getMatrix()),
+                SimTK::Matrix(expectedHeavy.getMatrix()));
+        SimTK_TEST(!results.back().success);
+        SimTK_TEST(!results.back().message.empty());
+
+        // The mean and standard deviation at the initial time are those of
+        // the initial q0 values of the successful members.
+        const auto stats = EnsembleSimulator::computeStatistics(results, 11);
+        SimTK_TEST(stats.numMembers == (int)q0Values.size() + 1);
+        SimTK_TEST(stats.mean.getNumRows() == 11);
+        SimTK_TEST_EQ(stats.mean.getIndependentColumn().back(), finalTime);
+        std::vector<double> initialQ0 = q0Values;
+        initialQ0.push_back(0.1);
+        double mean = 0;
+        for (double q0 : initialQ0) mean += q0;
+        mean /= initialQ0.size();
+        double variance = 0;
+        for (double q0 : initialQ0) variance += SimTK::square(q0 - mean);
+        variance /= initialQ0.size() - 1;
+        const int iq0 = (int)stats.mean.getColumnIndex("/jointset/j0/q0/value");
+        SimTK_TEST_EQ(stats.mean.getMatrix()(0, iq0), mean);
+        SimTK_TEST_EQ(stats.standardDeviation.getMatrix()(0, iq0),
+                std::sqrt(variance));
+    }
+
+    // The standard deviation is accurate even if the spread of the members is
+    // small compared to their mean.
+    std::vector<EnsembleSimulator::MemberResult> offsetResults(3);
+    for (int i = 0; i < (int)offsetResults.size(); ++i) {
+        offsetResults[i].success = true;
+        offsetResults[i].states = TimeSeriesTable({0.0, 1.0},
+                SimTK::Matrix(2, 1, 1e9 + 1e-3 * i), {"q"});
+    }
+    const auto offsetStats =
+            EnsembleSimulator::computeStatistics(offsetResults, 3);
+    SimTK_TEST_EQ_TOL(offsetStats.mean.getMatrix()(1, 0), 1e9 + 1e-3, 1e-6);
+    SimTK_TEST_EQ_TOL(
+            offsetStats.standardDeviation.getMatrix()(1, 0), 1e-3, 1e-6);
+}
@@ -41,6 +41,7 @@
 #include "Model/ElasticFoundationForce.h"
 #include "Model/HuntCrossleyForce.h"
 #include "Model/SmoothSphereHalfSpaceForce.h"
+#include "Model/SmoothSphereHalfSpaceForceGroup.h"
 #include "Model/Ligament.h"
 #include "Model/Blankevoort1991Ligament.h"
 #include "Model/JointSet.h"
@@ -118,6 +119,9 @@
 #include "InverseKinematicsSolver.h"
 #include "MarkersReference.h"
 #include "OrientationsReference.h"
+#include "ModelCache.h"
+#include "EnsembleSimulator.h"
+#include "RealTimeIMUInverseKinematics.h"
 #include "MomentArmSolver.h"
 #include "Reference.h"
 #include "Solver.h"
@@ -133,22 +133,29 @@ prepareToOptimize(SimTK::State& s, double *x)
     _forcePerformanceMatrix.resize(nf,nf);
     _forcePerformanceVector.resize(nf);
 
-    Vector f(nf), accelVec(nacc), forceVec(nf);
+    _accelPerformanceColumn.resize(nacc);
+    _forcePerformanceColumn.resize(nf);
 
     // Build matrices and vectors assuming performance is a linear least squares problem.
     // i.e. assume we're solving
     //   min || _accelPerformanceMatrix * x + _accelPerformanceVector ||^2 + || _forcePerformanceMatrix * x + _forcePerformanceVector || ^2
-    f = 0;
-    computePerformanceVectors(s, f, _accelPerformanceVector, _forcePerformanceVector);
-
-
-    for(int j=0; j<nf; j++) {
-        f[j] = 1;
-        computePerformanceVectors(s, f, accelVec, forceVec);
-        for(int i=0; i<nacc; i++) _accelPerformanceMatrix(i,j) = (accelVec[i] - _accelPerformanceVector[i]);
-        for(int i=0; i<nf; i++) _forcePerformanceMatrix(i,j) = (forceVec[i] - _forcePerformanceVector[i]);
-        f[j] = 0;
-    }
+    // The model is realized with zero force and with a unit force in each
+    // actuator (possibly on multiple threads) before the performance vectors
+    // are evaluated.
+    Matrix forces(nf, nf+1, 0.0);
+    for(int j=0; j<nf; j++) forces(j,j+1) = 1;
+
+    _controller->realizeWithOverriddenActuation(s, forces,
+        [&](int col, const SimTK::State& realized) {
+            if(col == 0) {
+                evaluatePerformanceVectors(realized, _accelPerformanceVector, _forcePerformanceVector);
+                return;
+            }
+            const int j = col - 1;
+            evaluatePerformanceVectors(realized, _accelPerformanceColumn, _forcePerformanceColumn);
+            for(int i=0; i<nacc; i++) _accelPerformanceMatrix(i,j) = (_accelPerformanceColumn[i] - _accelPerformanceVector[i]);
+            for(int i=0; i<nf; i++) _forcePerformanceMatrix(i,j) = (_forcePerformanceColumn[i] - _forcePerformanceVector[i]);
+        });
 
 #ifdef USE_LAPACK_DIRECT_SOLVE
     // 
@@ -238,6 +245,24 @@ computePerformanceVectors(SimTK::State& s, const Vector &aF, Vector &rAccelPerfo
 
     _controller->getModel().getMultibodySystem().realize(s, SimTK::Stage::Acceleration );
 
+    evaluatePerformanceVectors(s, rAccelPerformanceVector, rForcePerformanceVector);
+
+    // reset the actuator control
+    for(int i=0;i<fSet.getSize();i++) {
+        auto act = dynamic_cast<const ScalarActuator*>(&fSet[i]);
+        act->overrideActuation(s, false);
+    }
+}
+
+/**
+ * Compute the performance vectors from a state that has been realized to
+ * Stage::Acceleration with the actuator forces overridden.
+ */
+void ActuatorForceTarget::
+evaluatePerformanceVectors(const SimTK::State& s, Vector &rAccelPerformanceVector, Vector &rForcePerformanceVector)
+{
+    const Set<const Actuator> &fSet = _controller->getActuatorSet();
+
     CMC_TaskSet& taskSet = _controller->updTaskSet();
     taskSet.computeAccelerations(s);
     Array<double> &w = taskSet.getWeights();
@@ -253,12 +278,6 @@ computePerformanceVectors(SimTK::State& s, const Vector &aF, Vector &rAccelPerfo
 
     int nacc = aDes.getSize();
     for(int i=0;i<nacc;i++) rAccelPerformanceVector[i] = sqrt(w[i]) * (a[i] - aDes[i]);
-
-    // reset the actuator control
-    for(int i=0;i<fSet.getSize();i++) {
-        auto act = dynamic_cast<const ScalarActuator*>(&fSet[i]);
-        act->overrideActuation(s, false);
-    }
 }
 
 //______________________________________________________________________________
@@ -87,6 +87,8 @@ private:
     SimTK::Vector _performanceGradientVector;
     SimTK::Matrix _accelPerformanceMatrix, _forcePerformanceMatrix;
     SimTK::Vector _accelPerformanceVector, _forcePerformanceVector;
+    /** Work space for a column of the performance matrices. */
+    SimTK::Vector _accelPerformanceColumn, _forcePerformanceColumn;
 
     double *_lapackA;
     double *_lapackB;
@@ -119,6 +121,7 @@ public:
 
 private:
     void computePerformanceVectors(SimTK::State& s, const SimTK::Vector &aF, SimTK::Vector &rAccelPerformanceVector, SimTK::Vector &rForcePerformanceVector);
+    void evaluatePerformanceVectors(const SimTK::State& s, SimTK::Vector &rAccelPerformanceVector, SimTK::Vector &rForcePerformanceVector);
 
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 };  // END class ActuatorForceTarget
@@ -123,20 +123,24 @@ prepareToOptimize(SimTK::State& s, double *x)
 
     _constraintMatrix.resize(nc,nf);
     _constraintVector.resize(nc);
-
-    Vector f(nf), c(nc);
-
-    // Build linear constraint matrix and constant constraint vector
-    f = 0;
-
-    computeConstraintVector(s, f, _constraintVector);
-
-    for(int j=0; j<nf; j++) {
-        f[j] = 1;
-        computeConstraintVector(s, f, c);
-        _constraintMatrix(j) = (c - _constraintVector);
-        f[j] = 0;
-    }
+    _constraintColumn.resize(nc);
+
+    // Build linear constraint matrix and constant constraint vector from the
+    // constraints with zero force and with a unit force in each actuator.
+    // The model is realized for all of these forces (possibly on multiple
+    // threads) before the constraints are evaluated.
+    Matrix forces(nf, nf+1, 0.0);
+    for(int j=0; j<nf; j++) forces(j,j+1) = 1;
+
+    _controller->realizeWithOverriddenActuation(s, forces,
+        [&](int j, const SimTK::State& realized) {
+            if(j == 0) {
+                evaluateConstraintVector(realized, _constraintVector);
+            } else {
+                evaluateConstraintVector(realized, _constraintColumn);
+                _constraintMatrix(j-1) = _constraintColumn - _constraintVector;
+            }
+        });
 #endif
 
     // use temporary copy of state because computeIsokineticForceAssumingInfinitelyStiffTendon
@@ -296,7 +300,6 @@ constraintFunc(const SimTK::Vector &x, const bool new_coefficients, SimTK::Vecto
 void ActuatorForceTargetFast::
 computeConstraintVector(SimTK::State& s, const Vector &x,Vector &c) const
 {
-    CMC_TaskSet&  taskSet = _controller->updTaskSet();
     const Set<const Actuator>& fSet = _controller->getActuatorSet();
 
     int nf = fSet.getSize();
@@ -311,14 +314,7 @@ computeConstraintVector(SimTK::State& s, const Vector &x,Vector &c) const
     }
     _controller->getModel().getMultibodySystem().realize(s, SimTK::Stage::Acceleration );
 
-    taskSet.computeAccelerations(s);
-    Array<double> &w = taskSet.getWeights();
-    Array<double> &aDes = taskSet.getDesiredAccelerations();
-    Array<double> &a = taskSet.getAccelerations();
-
-    // CONSTRAINTS
-    for(int i=0; i<getNumConstraints(); i++)
-        c[i]=w[i]*(aDes[i]-a[i]);
+    evaluateConstraintVector(s, c);
 
     // reset the actuator control 
     for(int i=0;i<fSet.getSize();i++) {
@@ -329,6 +325,24 @@ computeConstraintVector(SimTK::State& s, const Vector &x,Vector &c) const
     _controller->getModel().getMultibodySystem().realizeModel(s);
 }
 //______________________________________________________________________________
+/**
+ * Compute all constraints from a state that has been realized to
+ * Stage::Acceleration with the actuator forces overridden.
+ */
+void ActuatorForceTargetFast::
+evaluateConstraintVector(const SimTK::State& s, Vector &c) const
+{
+    CMC_TaskSet&  taskSet = _controller->updTaskSet();
+    taskSet.computeAccelerations(s);
+    Array<double> &w = taskSet.getWeights();
+    Array<double> &aDes = taskSet.getDesiredAccelerations();
+    Array<double> &a = taskSet.getAccelerations();
+
+    // CONSTRAINTS
+    for(int i=0; i<getNumConstraints(); i++)
+        c[i]=w[i]*(aDes[i]-a[i]);
+}
+//______________________________________________________________________________
 /**
  * Compute the gradient of constraint i given x.
  *
@@ -90,6 +90,8 @@ private:
 
     SimTK::Matrix _constraintMatrix;
     SimTK::Vector _constraintVector;
+    /** Work space for a column of the constraint matrix. */
+    SimTK::Vector _constraintColumn;
     
     // Save a (copy) of the state for state tracking purposes
     SimTK::State    _saveState;
@@ -120,6 +122,7 @@ public:
     CMC* getController() {return (_controller); }
 private:
     void computeConstraintVector(SimTK::State& s, const SimTK::Vector &x, SimTK::Vector &c) const;
+    void evaluateConstraintVector(const SimTK::State& s, SimTK::Vector &c) const;
 
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 };  // END class ActuatorForceTargetFast
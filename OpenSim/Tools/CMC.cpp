@@ -41,6 +41,9 @@
 #include <OpenSim/Simulation/Model/CMCActuatorSubsystem.h>
 #include <OpenSim/Simulation/Model/Model.h>
 
+#include <exception>
+#include <mutex>
+
 using namespace std;
 using SimTK::Vector;
 using namespace OpenSim;
@@ -50,6 +53,32 @@ using namespace SimTK;
 #define MAX_CMC_CONTROL_VALUE 1.00
 
 #define MAX_CONTROLS_FOR_RRA 10000
+
+namespace {
+// Invokes a function for each index on the threads of a ParallelExecutor.
+// An exception thrown on a thread is kept so that it can be rethrown on the
+// calling thread.
+class RealizeOverrideStatesTask : public SimTK::ParallelExecutor::Task {
+public:
+    RealizeOverrideStatesTask(const std::function<void(int)>& func) :
+            _func(func) {}
+    void execute(int index) override {
+        try {
+            _func(index);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (!_exception) _exception = std::current_exception();
+        }
+    }
+    void rethrowIfFailed() const {
+        if (_exception) std::rethrow_exception(_exception);
+    }
+private:
+    const std::function<void(int)>& _func;
+    std::mutex _mutex;
+    std::exception_ptr _exception;
+};
+}
 // Excluding this from Doxygen until it has better documentation! -Sam Hamner
     /// @cond
 class ComputeControlsEventHandler : public PeriodicEventHandler {
@@ -157,6 +186,7 @@ void CMC::copyData( const CMC &aCmc )
    _predictor             = aCmc._predictor;
    _f                     = aCmc._f;
    _taskSet               = aCmc._taskSet;
+   _numThreads            = aCmc._numThreads;
 
 }
 //_____________________________________________________________________________
@@ -203,6 +233,7 @@ setNull()
     _stressTermWeightStore.reset();
     _useCurvatureFilter = false;
     _verbose = false;
+    _numThreads = 1;
     _paramList.setSize(0);
     _controlSet.setSize(0);
     setAuthors("Frank Anderson");
@@ -695,6 +726,107 @@ restoreConfiguration(SimTK::State& s, const SimTK::State& initialState)
     _model->getMatterSubsystem().updU(s) = _model->getMatterSubsystem().getU(initialState);
 }
 
+//_____________________________________________________________________________
+/**
+ * Realize copies of a state with overridden actuation (see the declaration).
+ * The copies are realized in blocks of getNumThreads() columns; the states
+ * of a block are evaluated before the next block is realized.
+ *
+ * With one thread, the copies are realized with the Model itself. With more
+ * than one, each thread realizes its copies with its own copy of the Model:
+ * realizing a state writes to objects owned by the Model (e.g., the PathWrap
+ * objects of wrapped paths, and the search node of each ControlLinear), so
+ * states of one Model cannot be realized concurrently. The controls are
+ * computed once, on the calling thread, and set in each state.
+ */
+void CMC::
+realizeWithOverriddenActuation(const SimTK::State& s,
+    const SimTK::Matrix& aForces,
+    const std::function<void(int, const SimTK::State&)>& aEvaluate)
+{
+    const Set<const Actuator>& fSet = getActuatorSet();
+    const int nf = fSet.getSize();
+    OPENSIM_THROW_IF_FRMOBJ(aForces.nrow() != nf, Exception,
+        "Expected {} rows of actuator forces, but got {}.",
+        nf, aForces.nrow());
+    const int ncol = aForces.ncol();
+    if(ncol == 0) return;
+
+    int numThreads = _numThreads;
+    if(numThreads < 1) numThreads = ParallelExecutor::getNumProcessors();
+    const int blockSize = std::max(1, std::min(numThreads, ncol));
+
+    const MultibodySystem& system = _model->getMultibodySystem();
+    if(blockSize == 1) {
+        SimTK::State state;
+        for(int j=0;j<ncol;j++) {
+            state = s;
+            for(int i=0;i<nf;i++) {
+                auto act = dynamic_cast<const ScalarActuator*>(&fSet[i]);
+                act->overrideActuation(state, true);
+                act->setOverrideActuation(state, aForces(i,j));
+            }
+            system.realize(state, Stage::Acceleration);
+            aEvaluate(j, state);
+        }
+        return;
+    }
+
+    // Copy the Model for each thread. The copies have the same topology as
+    // the Model, so they can realize copies of s.
+    for(int index = (int)_overrideWorkers.size(); index < blockSize;
+            ++index) {
+        _overrideWorkers.emplace_back();
+        OverrideWorker& worker = _overrideWorkers.back();
+        worker.model.reset(new Model(*_model));
+        worker.model->initSystem();
+        for(int i=0;i<nf;i++) {
+            worker.actuators.push_back(
+                &worker.model->getComponent<ScalarActuator>(
+                    fSet[i].getAbsolutePathString()));
+        }
+    }
+
+    // The controls do not depend on the overridden actuation; computing
+    // them here keeps the threads from evaluating the controllers.
+    system.realize(s, Stage::Velocity);
+    const SimTK::Vector controls = _model->getControls(s);
+    const SimTK::StageVersion topologyVersion =
+        system.getSystemTopologyCacheVersion();
+
+    int begin = 0;
+    const std::function<void(int)> realizeColumn = [&](int index) {
+        const int j = begin + index;
+        OverrideWorker& worker = _overrideWorkers[index];
+        const Model& model = *worker.model;
+        SimTK::State& state = worker.state;
+        state = s;
+        state.setSystemTopologyStageVersion(
+            model.getMultibodySystem().getSystemTopologyCacheVersion());
+        for(int i=0;i<nf;i++) {
+            const ScalarActuator* act = worker.actuators[i];
+            act->overrideActuation(state, true);
+            act->setOverrideActuation(state, aForces(i,j));
+        }
+        model.getMultibodySystem().realize(state, Stage::Velocity);
+        model.setControls(state, controls);
+        model.getMultibodySystem().realize(state, Stage::Acceleration);
+        // The state is evaluated with the Model.
+        state.setSystemTopologyStageVersion(topologyVersion);
+    };
+
+    if(!_executor) _executor.reset(new ParallelExecutor(blockSize));
+    for(; begin < ncol; begin += blockSize) {
+        const int end = std::min(begin + blockSize, ncol);
+        RealizeOverrideStatesTask task(realizeColumn);
+        _executor->execute(task, end - begin);
+        task.rethrowIfFailed();
+        for(int j=begin;j<end;j++) {
+            aEvaluate(j, _overrideWorkers[j - begin].state);
+        }
+    }
+}
+
 
 
 //_____________________________________________________________________________
@@ -901,7 +1033,14 @@ computeControls(SimTK::State& s, ControlSet &controlSet)
     _target->setParameterLimits(lowerBounds, upperBounds);
 
     // OPTIMIZER ERROR TRAP
+    // The optimizer and target persist across target intervals. Start from
+    // the forces of the previous interval, moved within the new bounds, so
+    // the optimizer (with IPOPT's "warm_start" option, set by CMCTool)
+    // starts near the solution.
     _f.setSize(N);
+    for(i=0;i<N;i++) {
+        _f[i] = SimTK::clamp(lowerBounds[i], _f[i], upperBounds[i]);
+    }
 
     if(!_target->prepareToOptimize(newState, &_f[0])) {
         // No direct solution, need to run optimizer
@@ -961,6 +1100,30 @@ computeControls(SimTK::State& s, ControlSet &controlSet)
     _model->updAnalysisSet().setOn(true);
 }
 
+//_____________________________________________________________________________
+/**
+ * Set the number of threads used to realize states with overridden
+ * actuation. Values less than 1 use all hardware threads.
+ */
+void CMC::
+setNumThreads(int aNumThreads)
+{
+    if(aNumThreads != _numThreads) {
+        _executor.reset();
+        _overrideWorkers.clear();
+    }
+    _numThreads = aNumThreads;
+}
+//_____________________________________________________________________________
+/**
+ * Get the number of threads used to realize states with overridden
+ * actuation.
+ */
+int CMC::
+getNumThreads() const
+{
+    return(_numThreads);
+}
 //_____________________________________________________________________________
 /**
  * Set whether or not a curvature filter should be applied to the controls.
@@ -35,14 +35,20 @@
 #include <OpenSim/Simulation/Control/ControlSet.h>
 #include <OpenSim/Simulation/Control/TrackingController.h>
 
+#include <functional>
+#include <memory>
+#include <vector>
+
 namespace SimTK {
 class Optimizer;
+class ParallelExecutor;
 }
 
 namespace OpenSim {
 
 class Model;
 class OptimizationTarget;
+class ScalarActuator;
 class VectorFunctionForActuators;
 class CMC_TaskSet;
 
@@ -132,9 +138,24 @@ protected:
     /** Vector function for estimating actuator forces over a specified time
     interval. */
     VectorFunctionForActuators *_predictor;
-    /** Array of actuator forces for achieving the desired accelerations. */
+    /** Array of actuator forces for achieving the desired accelerations.
+    The solution for one target interval is the initial guess for the next. */
     Array<double> _f;
 
+    /** Number of threads used by realizeWithOverriddenActuation(). */
+    int _numThreads;
+    /** A copy of the Model (and of its actuators), and the state it
+    realizes, for each thread used by realizeWithOverriddenActuation(). */
+    struct OverrideWorker {
+        std::unique_ptr<Model> model;
+        std::vector<const ScalarActuator*> actuators;
+        SimTK::State state;
+    };
+    /** Thread pool and Model copies used by realizeWithOverriddenActuation();
+    kept across target intervals to avoid creating them at every interval. */
+    std::unique_ptr<SimTK::ParallelExecutor> _executor;
+    std::vector<OverrideWorker> _overrideWorkers;
+
 
 //=============================================================================
 // METHODS
@@ -183,6 +204,12 @@ public:
     bool getUseCurvatureFilter() const;
     const CMC_TaskSet& getTaskSet() const;
     CMC_TaskSet& updTaskSet() const;
+    /** Set the number of threads used by realizeWithOverriddenActuation()
+    (default: 1). Values less than 1 use all hardware threads. With more
+    than one thread, each thread realizes states with its own copy of the
+    Model, which is created at the first call. */
+    void setNumThreads(int aNumThreads);
+    int getNumThreads() const;
 
 
     ControlSet& updControlSet() { return _controlSet; }
@@ -193,6 +220,23 @@ public:
     void restoreConfiguration(SimTK::State&s, const SimTK::State& initialState);
     void obtainActuatorEquilibrium(SimTK::State& s, double tiReal,double dtReal,
         const Array<double> &x,bool hold);
+    /**
+     * For each column of aForces, realize a copy of s to
+     * Stage::Acceleration with the actuation of each actuator in
+     * getActuatorSet() overridden by the corresponding element of the
+     * column, then invoke aEvaluate with the index of the column and the
+     * realized state. The optimization targets use this to linearize the
+     * tracked accelerations with respect to the actuator forces.
+     *
+     * The states are realized on getNumThreads() threads, each with its own
+     * copy of the Model; the controls are computed once, from s, on the
+     * calling thread. aEvaluate is invoked on the calling thread, in the order of the
+     * columns, so it may use the (non-thread-safe) task set. s is not
+     * modified.
+     */
+    void realizeWithOverriddenActuation(const SimTK::State& s,
+        const SimTK::Matrix& aForces,
+        const std::function<void(int, const SimTK::State&)>& aEvaluate);
 
     //--------------------------------------------------------------------------
     // COMPUTATION
@@ -21,6 +21,7 @@
  * limitations under the License.                                             *
  * -------------------------------------------------------------------------- */
 #include "CMCTool.h"
+#include "ParallelTimeWindows.h"
 #include "CMC.h"
 #include "CMC_TaskSet.h"
 #include "ActuatorForceTarget.h"
@@ -75,6 +76,9 @@ CMCTool::CMCTool() :
     _optimizationConvergenceTolerance(_optimizationConvergenceToleranceProp.getValueDbl()),
     _maxIterations(_maxIterationsProp.getValueInt()),
     _printLevel(_printLevelProp.getValueInt()),
+    _numThreads(_numThreadsProp.getValueInt()),
+    _numParallelTimeWindows(_numParallelTimeWindowsProp.getValueInt()),
+    _parallelTimeWindowOverlap(_parallelTimeWindowOverlapProp.getValueDbl()),
     _verbose(_verboseProp.getValueBool())
 {
     setNull();
@@ -105,6 +109,9 @@ CMCTool::CMCTool(const string &aFileName, bool aLoadModel) :
     _optimizationConvergenceTolerance(_optimizationConvergenceToleranceProp.getValueDbl()),
     _maxIterations(_maxIterationsProp.getValueInt()),
     _printLevel(_printLevelProp.getValueInt()),
+    _numThreads(_numThreadsProp.getValueInt()),
+    _numParallelTimeWindows(_numParallelTimeWindowsProp.getValueInt()),
+    _parallelTimeWindowOverlap(_parallelTimeWindowOverlapProp.getValueDbl()),
     _verbose(_verboseProp.getValueBool())
 {
     setNull();
@@ -175,6 +182,9 @@ CMCTool(const CMCTool &aTool) :
     _optimizationConvergenceTolerance(_optimizationConvergenceToleranceProp.getValueDbl()),
     _maxIterations(_maxIterationsProp.getValueInt()),
     _printLevel(_printLevelProp.getValueInt()),
+    _numThreads(_numThreadsProp.getValueInt()),
+    _numParallelTimeWindows(_numParallelTimeWindowsProp.getValueInt()),
+    _parallelTimeWindowOverlap(_parallelTimeWindowOverlapProp.getValueDbl()),
     _verbose(_verboseProp.getValueBool())
 {
     setNull();
@@ -207,7 +217,11 @@ setNull()
     _optimizationConvergenceTolerance = 1.0e-4;
     _maxIterations = 1000;
     _printLevel = 0;
+    _numThreads = 1;
+    _numParallelTimeWindows = 1;
+    _parallelTimeWindowOverlap = 0.1;
     _verbose = false;
+    _debugFilePrefix = "";
 
     _replaceForceSet = false;   // default should be false for Forward.
     _solveForEquilibriumForAuxiliaryStates = true;
@@ -322,6 +336,31 @@ void CMCTool::setupProperties()
     _printLevelProp.setName("optimizer_print_level");
     _propertySet.append( &_printLevelProp );
 
+    comment = "Number of threads used to compute how the tracked accelerations "
+              "depend on the actuator forces (one realization of the model per "
+              "actuator in each time window). Values less than 1 use all "
+              "hardware threads. Each thread uses its own copy of the model. "
+              "The default is 1.";
+    _numThreadsProp.setComment(comment);
+    _numThreadsProp.setName("num_threads");
+    _propertySet.append( &_numThreadsProp );
+
+    comment = "Number of time windows into which to divide the time range. If greater "
+              "than 1, the windows are solved concurrently (using num_threads threads), "
+              "each with its own copy of the model starting from the desired kinematics, "
+              "and the results are blended where the windows overlap. The default is 1.";
+    _numParallelTimeWindowsProp.setComment(comment);
+    _numParallelTimeWindowsProp.setName("num_parallel_time_windows");
+    _propertySet.append( &_numParallelTimeWindowsProp );
+
+    comment = "Time (in seconds) by which each parallel time window starts before the "
+              "previous window ends. The first half lets the window's muscle states "
+              "settle; the results of adjacent windows are blended over the second half "
+              "(and the same duration after the boundary). The default is 0.1.";
+    _parallelTimeWindowOverlapProp.setComment(comment);
+    _parallelTimeWindowOverlapProp.setName("parallel_time_window_overlap");
+    _propertySet.append( &_parallelTimeWindowOverlapProp );
+
     comment = "True-false flag indicating whether or not to turn on verbose printing for cmc.";
     _verboseProp.setComment(comment);
     _verboseProp.setName("use_verbose_printing");
@@ -364,6 +403,9 @@ operator=(const CMCTool &aTool)
     _optimizerAlgorithm = aTool._optimizerAlgorithm;
     _maxIterations = aTool._maxIterations;
     _printLevel = aTool._printLevel;
+    _numThreads = aTool._numThreads;
+    _numParallelTimeWindows = aTool._numParallelTimeWindows;
+    _parallelTimeWindowOverlap = aTool._parallelTimeWindowOverlap;
     _verbose = aTool._verbose;
 
     return(*this);
@@ -396,14 +438,35 @@ bool CMCTool::run()
     // so that the parsing code behaves properly if called from a different directory
     auto cwd = IO::CwdChanger::changeToParentOf(getDocumentFileName());
 
-    try {
+    if(_numParallelTimeWindows > 1) return runInParallelTimeWindows();
 
     // SET OUTPUT PRECISION
     IO::SetPrecision(_outputPrecision);
 
-    /*bool externalLoads = */createExternalLoads(_externalLoadsFileName, *_model);
+    std::unique_ptr<CMC_TaskSet> taskSet;
+    try {
+        /*bool externalLoads = */createExternalLoads(_externalLoadsFileName, *_model);
+        taskSet.reset(new CMC_TaskSet(_taskSetFileName));
+    } catch(const Exception& x) {
+        x.print(cout);
+        return false;
+    }
+    return track(*taskSet);
+}
+
+//_____________________________________________________________________________
+/**
+ * Track the desired kinematics from the initial to the final time and write
+ * the results; this is the part of run() that is done for each time window.
+ * The external loads must already have been added to the model. This method
+ * changes neither the working directory (relative file names are relative
+ * to the current one) nor the output format of IO, so the time windows can
+ * be tracked concurrently.
+ */
+bool CMCTool::track(CMC_TaskSet& taskSet)
+{
+    try {
 
-    CMC_TaskSet taskSet(_taskSetFileName);           
     //taskSet.print("cmcTasksRT.xml");
     log_info("TaskSet size = {}.", taskSet.getSize());
 
@@ -420,6 +483,7 @@ bool CMCTool::run()
     controller->setUseCurvatureFilter(false);
     controller->setTargetDT(_targetDT);
     controller->setCheckTargetTime(true);
+    controller->setNumThreads(_numThreads);
 
     //Make sure system is up-to-date with model (i.e. added actuators, etc...)
     SimTK::State& s = _model->initSystem();
@@ -506,7 +570,7 @@ bool CMCTool::run()
     // filtered trajectories
     if(desiredPointsFlag) {
         desiredPointsStore->pad(60);
-        desiredPointsStore->print("desiredPoints_padded.sto");
+        desiredPointsStore->print(_debugFilePrefix + "desiredPoints_padded.sto");
         if(_lowpassCutoffFrequency>=0) {
             int order = 50;
             log_info("Low-pass filtering desired points with a cutoff frequency of {}...",
@@ -519,7 +583,7 @@ bool CMCTool::run()
 
     if(desiredKinFlag) {
         desiredKinStore->pad(60);
-        if (_verbose) desiredKinStore->print("desiredKinematics_padded.sto");
+        if (_verbose) desiredKinStore->print(_debugFilePrefix + "desiredKinematics_padded.sto");
         if(_lowpassCutoffFrequency>=0) {
             int order = 50;
             log_info("Low-pass filtering desired kinematics with a cutoff frequency of {}...",
@@ -567,7 +631,7 @@ bool CMCTool::run()
 
         // Print acc for debugging
         Storage *accStore=posSet->constructStorage(2);
-        accStore->print("desiredPoints_splinefit_accelerations.sto");
+        accStore->print(_debugFilePrefix + "desiredPoints_splinefit_accelerations.sto");
         delete accStore; accStore=NULL; 
     }
 
@@ -588,7 +652,7 @@ bool CMCTool::run()
 
         // Print dudt for debugging
         if (_verbose) {
-            dudtStore->print("desiredKinematics_splinefit_accelerations.sto");
+            dudtStore->print(_debugFilePrefix + "desiredKinematics_splinefit_accelerations.sto");
         }
         delete dudtStore; dudtStore=NULL;
     }
@@ -882,6 +946,25 @@ bool CMCTool::run()
 }
 
 
+//_____________________________________________________________________________
+/**
+ * Run the tool concurrently on overlapping time windows and stitch the
+ * results (see ParallelTimeWindows::runTrackingTool()). The working
+ * directory must already be that of the setup file.
+ */
+bool CMCTool::runInParallelTimeWindows()
+{
+    try {
+        // The sequential run integrates up to _tf - _targetDT.
+        const ParallelTimeWindows windows(_ti, _tf - _targetDT,
+            _numParallelTimeWindows, _parallelTimeWindowOverlap);
+        return windows.runTrackingTool(*this);
+    } catch(const Exception& x) {
+        log_error(x.what());
+        return false;
+    }
+}
+
 //=============================================================================
 // UTILITY
 //=============================================================================
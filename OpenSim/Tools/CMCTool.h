@@ -41,6 +41,7 @@
 
 namespace OpenSim {
 
+class CMC_TaskSet;
 class ControlSet;
 class Storage;
 
@@ -119,11 +120,28 @@ private:
     0 = no printing, ..., 3 = detailed printing. */
     PropertyInt _printLevelProp;
     int &_printLevel;
+    /** Number of threads used to linearize the task accelerations with
+    respect to the actuator forces. */
+    PropertyInt _numThreadsProp;
+    int &_numThreads;
+    /** Number of time windows to solve concurrently (1: solve the whole time
+    range at once). */
+    PropertyInt _numParallelTimeWindowsProp;
+    int &_numParallelTimeWindows;
+    /** Overlap of adjacent parallel time windows. */
+    PropertyDbl _parallelTimeWindowOverlapProp;
+    double &_parallelTimeWindowOverlap;
     /** Flag for turning on and off verbose printing. */
     PropertyBool _verboseProp;
     bool &_verbose;
 
     ForceSet _originalForceSet;
+    /** Prepended to the names of the intermediate files that track() writes
+    (e.g., desiredPoints_padded.sto), so that concurrent time windows do not
+    write to the same files. */
+    std::string _debugFilePrefix;
+
+    friend class ParallelTimeWindows;
 
 //=============================================================================
 // METHODS
@@ -140,6 +158,8 @@ public:
 private:
     void setNull();
     void setupProperties();
+    bool track(CMC_TaskSet& taskSet);
+    bool runInParallelTimeWindows();
     /* Get the Set of model actuators for CMC that exclude user specified Actuators */
     Set<Actuator> getActuatorsForCMC(const Array<std::string> &actuatorsByNameOrGroup);
 
@@ -192,6 +212,14 @@ public:
     bool getUseFastTarget() const { return _useFastTarget;};         
     void setUseFastTarget(bool useFastTarget) const {  _useFastTarget=useFastTarget; };
 
+    // Threads
+    int getNumThreads() const { return _numThreads; }
+    void setNumThreads(int numThreads) { _numThreads = numThreads; }
+    int getNumParallelTimeWindows() const { return _numParallelTimeWindows; }
+    void setNumParallelTimeWindows(int numWindows) { _numParallelTimeWindows = numWindows; }
+    double getParallelTimeWindowOverlap() const { return _parallelTimeWindowOverlap; }
+    void setParallelTimeWindowOverlap(double overlap) { _parallelTimeWindowOverlap = overlap; }
+
     // Verbosity
     bool getUseVerbosePrinting() const {return _verbose;};
     void setUseVerbosePrinting(bool verbose) const { _verbose=verbose;};
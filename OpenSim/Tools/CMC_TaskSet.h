@@ -121,6 +121,7 @@ public:
     Model* getModel() const;
 
     const std::string& getDataFileName() const { return _dataFileName; };
+    void setDataFileName(const std::string& aFileName) { _dataFileName = aFileName; }
     // FUNCTIONS
     void setFunctions(FunctionSet &aFuncSet);
     void setFunctionsForVelocity(FunctionSet &aFuncSet);
@@ -168,6 +168,10 @@ void IMUInverseKinematicsTool::runInverseKinematicsWithOrientationsFromFile(
     ikSolver.setAccuracy(accuracy);
 
     auto& times = oRefs.getTimes();
+    if (get_report_solver_performance()) {
+        // One record for assemble() and one for each track().
+        ikSolver.setPerformanceRecordCapacity((int)times.size() + 1);
+    }
     std::shared_ptr<TimeSeriesTable> modelOrientationErrors(
             get_report_errors() ? new TimeSeriesTable()
                                 : nullptr);
@@ -247,6 +251,10 @@ void IMUInverseKinematicsTool::runInverseKinematicsWithOrientationsFromFile(
             STOFileAdapter_<double>::write(*modelOrientationErrors,
                     outName + "_orientationErrors.sto");
         }
+        if (get_report_solver_performance()) {
+            STOFileAdapter_<double>::write(ikSolver.getPerformanceTable(),
+                    outName + "_solverPerformance.sto");
+        }
     } 
     else
         log_info("IMUInverseKinematicsTool: No output files were generated, "
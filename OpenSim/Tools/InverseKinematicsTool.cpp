@@ -34,6 +34,7 @@
 #include <OpenSim/Common/FunctionSet.h>
 #include <OpenSim/Common/GCVSplineSet.h>
 #include <OpenSim/Common/IO.h>
+#include <OpenSim/Common/STOFileAdapter.h>
 #include <OpenSim/Common/Stopwatch.h>
 #include <OpenSim/Common/Storage.h>
 #include <OpenSim/Common/XMLDocument.h>
@@ -170,6 +171,10 @@ bool InverseKinematicsTool::run()
         InverseKinematicsSolver ikSolver(*_model, make_shared<MarkersReference>(markersReference),
             coordinateReferences, get_constraint_weight());
         ikSolver.setAccuracy(get_accuracy());
+        if (get_report_solver_performance()) {
+            // One record for assemble() and one for each track().
+            ikSolver.setPerformanceRecordCapacity(Nframes + 1);
+        }
         s.updTime() = times[start_ix];
         ikSolver.assemble(s);
         kinematicsReporter->begin(s);
@@ -289,6 +294,13 @@ bool InverseKinematicsTool::run()
             delete modelMarkerLocations;
         }
 
+        if (get_report_solver_performance()) {
+            IO::makeDir(getResultsDir());
+            STOFileAdapter::write(ikSolver.getPerformanceTable(),
+                    getResultsDir() + "/" + trialName +
+                            "_ik_solver_performance.sto");
+        }
+
         success = true;
 
         log_info("InverseKinematicsTool completed {} frames in {}.", Nframes,
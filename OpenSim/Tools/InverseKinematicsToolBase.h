@@ -80,6 +80,12 @@ public:
     OpenSim_DECLARE_PROPERTY(output_motion_file, std::string,
             "Name of the resulting inverse kinematics motion (.mot) file.");
 
+    OpenSim_DECLARE_PROPERTY(report_solver_performance, bool,
+            "Flag (true or false) indicating whether or not to write the "
+            "number of iterations and the time taken to solve each frame "
+            "(see AssemblySolver::getPerformanceTable()) to a .sto file in "
+            "the results directory. Default is false.");
+
     //=============================================================================
 // METHODS
 //=============================================================================
@@ -121,6 +127,7 @@ private:
         constructProperty_time_range(range);
         constructProperty_output_motion_file("");
         constructProperty_report_errors(true);
+        constructProperty_report_solver_performance(false);
     };
 
 //=============================================================================
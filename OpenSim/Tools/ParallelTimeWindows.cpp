@@ -0,0 +1,333 @@
+/* -------------------------------------------------------------------------- *
+ *                     OpenSim:  ParallelTimeWindows.cpp                      *
+ * -------------------------------------------------------------------------- *
+ * The OpenSim API is a toolkit for musculoskeletal modeling and simulation.  *
+ * See http://opensim.stanford.edu and the NOTICE file for more information.  *
+ * OpenSim is developed at Stanford University and supported by the US        *
+ * National Institutes of Health (U54 GM072970, R24 HD065690) and by DARPA    *
+ * through the Warrior Web program.                                           *
+ *                                                                            *
+ * Copyright (c) 2005-2021 Stanford University and the Authors                *
+ * Author(s): OpenSim Team                                                    *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "ParallelTimeWindows.h"
+#include "CMCTool.h"
+#include "RRATool.h"
+#include "CMC_TaskSet.h"
+
+#include <OpenSim/Common/IO.h>
+#include <OpenSim/Simulation/Control/ControlSet.h>
+#include <OpenSim/Simulation/Model/AbstractTool.h>
+#include <OpenSim/Simulation/Model/Analysis.h>
+#include <OpenSim/Simulation/Model/Model.h>
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <thread>
+
+using namespace OpenSim;
+
+namespace {
+
+std::string makeAbsolute(const std::string& fileName) {
+    return fileName == "Unassigned" ? fileName
+                                    : IO::makeAbsolutePath(fileName);
+}
+
+// Files that only some of the tracking tools read.
+void makeToolSpecificFilesAbsolute(CMCTool& tool) {
+    tool.setRRAControlsFileName(makeAbsolute(tool.getRRAControlsFileName()));
+}
+void makeToolSpecificFilesAbsolute(RRATool&) {}
+
+} // anonymous namespace
+
+ParallelTimeWindows::ParallelTimeWindows(double initialTime, double finalTime,
+        int numWindows, double overlap) : _overlap(overlap) {
+    OPENSIM_THROW_IF(numWindows < 1, Exception,
+            "Expected at least 1 time window, but got {}.", numWindows);
+    OPENSIM_THROW_IF(finalTime <= initialTime, Exception,
+            "Expected the final time ({}) to be greater than the initial "
+            "time ({}).", finalTime, initialTime);
+    OPENSIM_THROW_IF(overlap < 0, Exception,
+            "Expected a non-negative overlap, but got {}.", overlap);
+    const double length = (finalTime - initialTime) / numWindows;
+    OPENSIM_THROW_IF(numWindows > 1 && overlap > length, Exception,
+            "Expected the overlap ({}) to be no longer than a time window "
+            "({}); use fewer windows or a shorter overlap.", overlap, length);
+    _boundaries.resize(numWindows + 1);
+    for (int i = 0; i < numWindows; ++i) {
+        _boundaries[i] = initialTime + i * length;
+    }
+    _boundaries[numWindows] = finalTime;
+}
+
+double ParallelTimeWindows::getWindowInitialTime(int i) const {
+    if (i == 0) return _boundaries.front();
+    return std::max(_boundaries.front(), _boundaries[i] - _overlap);
+}
+
+double ParallelTimeWindows::getWindowFinalTime(int i) const {
+    if (i == getNumWindows() - 1) return _boundaries.back();
+    return std::min(_boundaries.back(), _boundaries[i + 1] + 0.5 * _overlap);
+}
+
+void ParallelTimeWindows::run(const std::function<void(int)>& solveWindow,
+        int numThreads) const {
+    const int numWindows = getNumWindows();
+    if (numThreads < 1) {
+        numThreads = (int)std::thread::hardware_concurrency();
+    }
+    numThreads = std::max(1, std::min(numThreads, numWindows));
+
+    std::vector<std::exception_ptr> exceptions(numWindows);
+    std::atomic<int> nextWindow(0);
+    auto work = [&]() {
+        int i;
+        while ((i = nextWindow++) < numWindows) {
+            try {
+                solveWindow(i);
+            } catch (...) {
+                exceptions[i] = std::current_exception();
+            }
+        }
+    };
+    if (numThreads == 1) {
+        work();
+    } else {
+        std::vector<std::thread> threads;
+        for (int ithread = 0; ithread < numThreads; ++ithread) {
+            threads.emplace_back(work);
+        }
+        for (auto& thread : threads) thread.join();
+    }
+    for (const auto& exception : exceptions) {
+        if (exception) std::rethrow_exception(exception);
+    }
+}
+
+Storage ParallelTimeWindows::blend(
+        const std::vector<const Storage*>& windowResults) const {
+    const int numWindows = getNumWindows();
+    OPENSIM_THROW_IF((int)windowResults.size() != numWindows, Exception,
+            "Expected results for {} time windows, but got {}.", numWindows,
+            windowResults.size());
+    const int numColumns = windowResults[0]->getColumnLabels().getSize() - 1;
+    for (const auto* result : windowResults) {
+        OPENSIM_THROW_IF(!(result->getColumnLabels() ==
+                                 windowResults[0]->getColumnLabels()),
+                Exception,
+                "Expected the results of all time windows to have the same "
+                "columns, but '{}' differs.", result->getName());
+    }
+
+    Storage blended(*windowResults[0], false);
+    const double halfWidth = 0.5 * _overlap;
+    Array<double> neighbor(0.0, numColumns);
+    Array<double> values(0.0, numColumns);
+    // The weight of the later window rises linearly from 0 to 1 across the
+    // blending region centered on a boundary.
+    auto weightOfLater = [&](double time, double boundary) {
+        return (time - (boundary - halfWidth)) / (2 * halfWidth);
+    };
+    for (int i = 0; i < numWindows; ++i) {
+        const Storage& result = *windowResults[i];
+        const double begin = _boundaries[i];
+        const double end = _boundaries[i + 1];
+        const bool isLast = i == numWindows - 1;
+        for (int irow = 0; irow < result.getSize(); ++irow) {
+            const StateVector& row = *result.getStateVector(irow);
+            const double time = row.getTime();
+            // Each window contributes the rows in [begin, end); the last
+            // window also contributes its final row.
+            if (i > 0 && time < begin) continue;
+            if (!isLast && time >= end) continue;
+            const Array<double>& data = row.getData();
+            for (int icol = 0; icol < numColumns; ++icol) {
+                values[icol] = icol < data.getSize() ? data[icol] : 0;
+            }
+            if (halfWidth > 0 && i > 0 && time < begin + halfWidth) {
+                const double w = weightOfLater(time, begin);
+                windowResults[i - 1]->getDataAtTime(time, numColumns,
+                        neighbor);
+                for (int icol = 0; icol < numColumns; ++icol) {
+                    values[icol] = (1 - w) * neighbor[icol] + w * values[icol];
+                }
+            }
+            if (halfWidth > 0 && !isLast && time > end - halfWidth) {
+                const double w = weightOfLater(time, end);
+                windowResults[i + 1]->getDataAtTime(time, numColumns,
+                        neighbor);
+                for (int icol = 0; icol < numColumns; ++icol) {
+                    values[icol] = (1 - w) * values[icol] + w * neighbor[icol];
+                }
+            }
+            blended.append(time, numColumns, &values[0]);
+        }
+    }
+    return blended;
+}
+
+void ParallelTimeWindows::printBlendedTrackingResults(
+        const std::vector<AbstractTool*>& tools, const std::string& name,
+        const std::string& resultsDir) const {
+    const int numWindows = getNumWindows();
+    OPENSIM_THROW_IF((int)tools.size() != numWindows, Exception,
+            "Expected a tool for each of the {} time windows, but got {}.",
+            numWindows, tools.size());
+    IO::makeDir(resultsDir);
+
+    // Files written by each window.
+    auto blendFiles = [&](const std::string& suffix) {
+        std::vector<std::unique_ptr<Storage>> storages;
+        std::vector<const Storage*> windowResults;
+        for (const auto* tool : tools) {
+            storages.emplace_back(new Storage(
+                    tool->getResultsDir() + "/" + name + suffix));
+            windowResults.push_back(storages.back().get());
+        }
+        Storage blended = blend(windowResults);
+        blended.print(resultsDir + "/" + name + suffix);
+        return blended;
+    };
+    blendFiles("_states.sto");
+    blendFiles("_pErr.sto");
+    const Storage controls = blendFiles("_controls.sto");
+    ControlSet(controls).print(resultsDir + "/" + name + "_controls.xml");
+
+    // Storages of the analyses; the windows' models were created from the
+    // same setup, so their analyses correspond.
+    AnalysisSet& analyses = tools[0]->getModel().updAnalysisSet();
+    for (int ia = 0; ia < analyses.getSize(); ++ia) {
+        ArrayPtrs<Storage>& storages = analyses.get(ia).getStorageList();
+        for (int is = 0; is < storages.getSize(); ++is) {
+            std::vector<const Storage*> windowResults;
+            for (const auto* tool : tools) {
+                auto& windowAnalysis =
+                        tool->getModel().updAnalysisSet().get(ia);
+                const Storage* storage = windowAnalysis.getStorageList()[is];
+                if (storage == nullptr || storage->getSize() == 0) break;
+                windowResults.push_back(storage);
+            }
+            if ((int)windowResults.size() != numWindows) continue;
+            *storages[is] = blend(windowResults);
+        }
+    }
+    tools[0]->printResults(name, resultsDir);
+}
+
+template <typename TrackingTool>
+bool ParallelTimeWindows::runTrackingTool(const TrackingTool& tool,
+        const std::function<void(Model&)>& processBlendedResults) const {
+    const std::string toolName = tool.getConcreteClassName();
+    if (tool._modelFile.empty()) {
+        log_error("{}: running in parallel time windows requires a model "
+                  "file (<model_file>), from which each window loads its "
+                  "own model.", toolName);
+        return false;
+    }
+    const int numWindows = getNumWindows();
+    log_info("Running {} in {} parallel time windows.", toolName, numWindows);
+
+    IO::SetPrecision(tool._outputPrecision);
+    // updateModelForces() changes to the parent directory of its second
+    // argument; with a trailing separator, that is the directory itself.
+    const std::string setupDir = IO::getCwd() + "/";
+    const std::string resultsDir = makeAbsolute(tool.getResultsDir());
+
+    // The models are declared first so that they outlive the tools, which
+    // do not own them.
+    std::vector<std::unique_ptr<Model>> models;
+    std::vector<std::unique_ptr<TrackingTool>> tools;
+    std::vector<std::unique_ptr<CMC_TaskSet>> taskSets;
+    std::vector<char> succeeded(numWindows, false);
+    try {
+        IO::makeDir(resultsDir);
+        for (int i = 0; i < numWindows; ++i) {
+            std::unique_ptr<TrackingTool> windowTool(new TrackingTool(tool));
+            windowTool->_numParallelTimeWindows = 1;
+            windowTool->_numThreads = 1;
+            windowTool->setInitialTime(getWindowInitialTime(i));
+            windowTool->setFinalTime(getWindowFinalTime(i) + tool._targetDT);
+            windowTool->setResultsDir(
+                    resultsDir + "/time_window_" + std::to_string(i));
+            IO::makeDir(windowTool->getResultsDir());
+            windowTool->_debugFilePrefix = windowTool->getResultsDir() + "/";
+            windowTool->_modelFile = makeAbsolute(tool._modelFile);
+            for (int j = 0; j < tool._forceSetFiles.getSize(); ++j) {
+                windowTool->_forceSetFiles[j] =
+                        makeAbsolute(tool._forceSetFiles[j]);
+            }
+            windowTool->_externalLoadsFileName =
+                    makeAbsolute(tool._externalLoadsFileName);
+            windowTool->_desiredPointsFileName =
+                    makeAbsolute(tool._desiredPointsFileName);
+            windowTool->_desiredKinematicsFileName =
+                    makeAbsolute(tool._desiredKinematicsFileName);
+            windowTool->_taskSetFileName = makeAbsolute(tool._taskSetFileName);
+            windowTool->_constraintsFileName =
+                    makeAbsolute(tool._constraintsFileName);
+            makeToolSpecificFilesAbsolute(*windowTool);
+
+            models.emplace_back(new Model(windowTool->_modelFile));
+            Model& model = *models.back();
+            model.finalizeFromProperties();
+            windowTool->_originalForceSet = model.getForceSet();
+            windowTool->updateModelForces(model, setupDir);
+            windowTool->setModel(model);
+            windowTool->createExternalLoads(
+                    windowTool->_externalLoadsFileName, model);
+
+            taskSets.emplace_back(
+                    new CMC_TaskSet(windowTool->_taskSetFileName));
+            taskSets.back()->setDataFileName(
+                    makeAbsolute(taskSets.back()->getDataFileName()));
+            tools.push_back(std::move(windowTool));
+        }
+
+        run([&](int i) { succeeded[i] = tools[i]->track(*taskSets[i]); },
+                tool._numThreads);
+    } catch (const std::exception& x) {
+        log_error("{}: {}", toolName, x.what());
+        return false;
+    }
+    for (int i = 0; i < numWindows; ++i) {
+        if (!succeeded[i]) {
+            log_error("{} failed in time window {} ({} to {}).", toolName, i,
+                    getWindowInitialTime(i), getWindowFinalTime(i));
+            return false;
+        }
+    }
+
+    try {
+        std::vector<AbstractTool*> windowTools;
+        for (const auto& windowTool : tools) {
+            windowTools.push_back(windowTool.get());
+        }
+        printBlendedTrackingResults(
+                windowTools, tool.getName(), tool.getResultsDir());
+        if (processBlendedResults) processBlendedResults(tools[0]->getModel());
+    } catch (const std::exception& x) {
+        log_error("{}: {}", toolName, x.what());
+        return false;
+    }
+    return true;
+}
+
+template bool ParallelTimeWindows::runTrackingTool<CMCTool>(
+        const CMCTool&, const std::function<void(Model&)>&) const;
+template bool ParallelTimeWindows::runTrackingTool<RRATool>(
+        const RRATool&, const std::function<void(Model&)>&) const;
@@ -0,0 +1,116 @@
+#ifndef OPENSIM_PARALLEL_TIME_WINDOWS_H_
+#define OPENSIM_PARALLEL_TIME_WINDOWS_H_
+/* -------------------------------------------------------------------------- *
+ *                      OpenSim:  ParallelTimeWindows.h                       *
+ * -------------------------------------------------------------------------- *
+ * The OpenSim API is a toolkit for musculoskeletal modeling and simulation.  *
+ * See http://opensim.stanford.edu and the NOTICE file for more information.  *
+ * OpenSim is developed at Stanford University and supported by the US        *
+ * National Institutes of Health (U54 GM072970, R24 HD065690) and by DARPA    *
+ * through the Warrior Web program.                                           *
+ *                                                                            *
+ * Copyright (c) 2005-2021 Stanford University and the Authors                *
+ * Author(s): OpenSim Team                                                    *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "osimToolsDLL.h"
+#include <OpenSim/Common/Storage.h>
+
+#include <functional>
+#include <vector>
+
+namespace OpenSim {
+
+class AbstractTool;
+class Model;
+
+/** Divides a time interval into windows that can be solved independently and
+concurrently (e.g., by CMCTool or RRATool), and stitches the results of the
+windows back together.
+
+The interval [initialTime, finalTime] is divided into numWindows windows of
+equal length, with boundaries b_0 = initialTime < b_1 < ... < b_n =
+finalTime. Each window (except the first) starts `overlap` before its
+nominal start b_i, and each window (except the last) ends `overlap / 2`
+after its nominal end. When stitching, the result of window i is used on
+[b_i, b_(i+1)], and the results of adjacent windows are blended linearly
+over [b_i - overlap / 2, b_i + overlap / 2]. The first half of each
+window's overlap is therefore only a warm-up, which lets the solution of
+the window (e.g., muscle states) settle before it contributes to the
+result.
+
+The overlap must not be longer than a window. */
+class OSIMTOOLS_API ParallelTimeWindows {
+public:
+    ParallelTimeWindows(double initialTime, double finalTime, int numWindows,
+            double overlap);
+
+    int getNumWindows() const { return (int)_boundaries.size() - 1; }
+    /** The time at which the solution of window i starts, including the
+    warm-up and blending region. */
+    double getWindowInitialTime(int i) const;
+    /** The time at which the solution of window i ends, including the
+    blending region. */
+    double getWindowFinalTime(int i) const;
+
+    /** Invoke solveWindow(i) for each window, on up to numThreads threads
+    (all hardware threads if numThreads is less than 1). If any invocation
+    throws, the first exception (by window index) is rethrown after all
+    windows are done. */
+    void run(const std::function<void(int)>& solveWindow,
+            int numThreads) const;
+
+    /** Stitch the results of the windows (one Storage per window, in order,
+    each covering getWindowInitialTime(i) to getWindowFinalTime(i)) into one
+    Storage. The result has the column labels and name of the first
+    window's Storage. All Storages must have the same columns. */
+    Storage blend(const std::vector<const Storage*>& windowResults) const;
+
+    /** Stitch and write the results of tracking tools (CMCTool, RRATool)
+    that were run on the windows, one tool per window, each writing to its
+    own results directory. This blends `<name>_states.sto`,
+    `<name>_controls.sto`, and `<name>_pErr.sto` from the windows' results
+    directories and the storages of the analyses in the windows' models,
+    and writes them (and `<name>_controls.xml`) to resultsDir with the same
+    file names as a run over the whole interval. The storages of the
+    analyses of the first window's model are replaced by the blended
+    storages. */
+    void printBlendedTrackingResults(const std::vector<AbstractTool*>& tools,
+            const std::string& name, const std::string& resultsDir) const;
+
+    /** Run a tracking tool (CMCTool or RRATool) concurrently on these
+    windows, each with its own copy of the tool and of the model (loaded
+    from the tool's model file), and print the stitched results with
+    printBlendedTrackingResults(). The working directory must already be
+    that of the tool's setup file. Everything that depends on the working
+    directory or changes process-wide state is done on the calling thread:
+    the copies of the tool get absolute file names and write to their own
+    results directories, and the models, external loads, and task sets are
+    loaded here. Only the tracking runs on the worker threads.
+    processBlendedResults, if given, is invoked with the first window's
+    model, whose analyses hold the stitched results.
+    @returns false (after logging the error) if the tool cannot be run in
+    time windows or if tracking fails in any window. */
+    template <typename TrackingTool>
+    bool runTrackingTool(const TrackingTool& tool,
+            const std::function<void(Model&)>& processBlendedResults =
+                    {}) const;
+
+private:
+    std::vector<double> _boundaries;
+    double _overlap;
+};
+
+} // namespace OpenSim
+
+#endif // OPENSIM_PARALLEL_TIME_WINDOWS_H_
@@ -21,6 +21,7 @@
  * limitations under the License.                                             *
  * -------------------------------------------------------------------------- */
 #include "RRATool.h"
+#include "ParallelTimeWindows.h"
 #include "CMC.h"
 #include "CMC_TaskSet.h"
 #include "ActuatorForceTarget.h"
@@ -71,6 +72,9 @@ RRATool::RRATool() :
     _finalTimeForCOMAdjustment(_finalTimeForCOMAdjustmentProp.getValueDbl()),
     _adjustedCOMBody(_adjustedCOMBodyProp.getValueStr()),
     _outputModelFile(_outputModelFileProp.getValueStr()),
+    _numThreads(_numThreadsProp.getValueInt()),
+    _numParallelTimeWindows(_numParallelTimeWindowsProp.getValueInt()),
+    _parallelTimeWindowOverlap(_parallelTimeWindowOverlapProp.getValueDbl()),
     _verbose(_verboseProp.getValueBool())
 {
     setNull();
@@ -96,6 +100,9 @@ RRATool::RRATool(const string &aFileName, bool aLoadModel) :
     _finalTimeForCOMAdjustment(_finalTimeForCOMAdjustmentProp.getValueDbl()),
     _adjustedCOMBody(_adjustedCOMBodyProp.getValueStr()),
     _outputModelFile(_outputModelFileProp.getValueStr()),
+    _numThreads(_numThreadsProp.getValueInt()),
+    _numParallelTimeWindows(_numParallelTimeWindowsProp.getValueInt()),
+    _parallelTimeWindowOverlap(_parallelTimeWindowOverlapProp.getValueDbl()),
     _verbose(_verboseProp.getValueBool())
 {
     setNull();
@@ -161,6 +168,9 @@ RRATool(const RRATool &aTool) :
     _finalTimeForCOMAdjustment(_finalTimeForCOMAdjustmentProp.getValueDbl()),
     _adjustedCOMBody(_adjustedCOMBodyProp.getValueStr()),
     _outputModelFile(_outputModelFileProp.getValueStr()),
+    _numThreads(_numThreadsProp.getValueInt()),
+    _numParallelTimeWindows(_numParallelTimeWindowsProp.getValueInt()),
+    _parallelTimeWindowOverlap(_parallelTimeWindowOverlapProp.getValueDbl()),
     _verbose(_verboseProp.getValueBool())
 {
     setNull();
@@ -192,7 +202,11 @@ setNull()
     _finalTimeForCOMAdjustment = -1;
     _outputModelFile = "";
     _adjustKinematicsToReduceResiduals=true;
+    _numThreads = 1;
+    _numParallelTimeWindows = 1;
+    _parallelTimeWindowOverlap = 0.1;
     _verbose = false;
+    _debugFilePrefix = "";
     _targetDT = .001;
     _replaceForceSet = false;   // default should be false for Forward.
 
@@ -287,6 +301,30 @@ void RRATool::setupProperties()
     _outputModelFileProp.setName("output_model_file");
     _propertySet.append( &_outputModelFileProp );
 
+    comment = "Number of threads on which to compute the task accelerations for the "
+              "actuator forces (used by the optimizer to form the constraints). Each "
+              "thread uses its own copy of the model. The default is 1.";
+    _numThreadsProp.setComment(comment);
+    _numThreadsProp.setName("num_threads");
+    _propertySet.append( &_numThreadsProp );
+
+    comment = "Number of time windows into which to divide the time range. If greater "
+              "than 1, the windows are solved concurrently (using num_threads threads), "
+              "each with its own copy of the model starting from the desired kinematics, "
+              "and the results are blended where the windows overlap. Not supported with "
+              "adjust_com_to_reduce_residuals. The default is 1.";
+    _numParallelTimeWindowsProp.setComment(comment);
+    _numParallelTimeWindowsProp.setName("num_parallel_time_windows");
+    _propertySet.append( &_numParallelTimeWindowsProp );
+
+    comment = "Time (in seconds) by which each parallel time window starts before the "
+              "previous window ends. The first half lets the window's solution settle; "
+              "the results of adjacent windows are blended over the second half (and "
+              "the same duration after the boundary). The default is 0.1.";
+    _parallelTimeWindowOverlapProp.setComment(comment);
+    _parallelTimeWindowOverlapProp.setName("parallel_time_window_overlap");
+    _propertySet.append( &_parallelTimeWindowOverlapProp );
+
     comment = "True-false flag indicating whether or not to turn on verbose printing for cmc.";
     _verboseProp.setComment(comment);
     _verboseProp.setName("use_verbose_printing");
@@ -325,6 +363,9 @@ operator=(const RRATool &aTool)
     _adjustCOMToReduceResiduals = aTool._adjustCOMToReduceResiduals;
     _initialTimeForCOMAdjustment = aTool._initialTimeForCOMAdjustment;
     _finalTimeForCOMAdjustment = aTool._finalTimeForCOMAdjustment;
+    _numThreads = aTool._numThreads;
+    _numParallelTimeWindows = aTool._numParallelTimeWindows;
+    _parallelTimeWindowOverlap = aTool._parallelTimeWindowOverlap;
     _verbose = aTool._verbose;
 
     return(*this);
@@ -357,11 +398,34 @@ bool RRATool::run()
     // so that the parsing code behaves properly if called from a different directory
     auto cwd = IO::CwdChanger::changeToParentOf(getDocumentFileName());
 
-    try {
+    if(_numParallelTimeWindows > 1) return runInParallelTimeWindows();
 
     // SET OUTPUT PRECISION
     IO::SetPrecision(_outputPrecision);
 
+    std::unique_ptr<CMC_TaskSet> taskSet;
+    try {
+        /*bool externalLoads = */createExternalLoads(_externalLoadsFileName, *_model);
+        taskSet.reset(new CMC_TaskSet(_taskSetFileName));
+    } catch(const Exception& x) {
+        log_error(x.what());
+        return false;
+    }
+    return track(*taskSet);
+}
+
+//_____________________________________________________________________________
+/**
+ * Track the desired kinematics from the initial to the final time and write
+ * the results; this is the part of run() that is done for each time window.
+ * The external loads must already have been added to the model. This method
+ * changes neither the working directory (relative file names are relative
+ * to the current one) nor the output format of IO, so the time windows can
+ * be tracked concurrently.
+ */
+bool RRATool::track(CMC_TaskSet& taskSet)
+{
+    try {
 
     // CHECK PROPERTIES FOR ERRORS/INCONSISTENCIES
     if(_adjustCOMToReduceResiduals) {
@@ -373,9 +437,6 @@ bool RRATool::run()
                                  _adjustedCOMBodyProp.getName()+" not found",__FILE__,__LINE__);
     }
 
-    /*bool externalLoads = */createExternalLoads(_externalLoadsFileName, *_model);
-
-    CMC_TaskSet taskSet(_taskSetFileName);           
     log_info("\ttaskSet size = {}.", taskSet.getSize());         
 
     CMC* controller = new CMC(_model,&taskSet); // Need to make it a pointer since Model takes ownership 
@@ -386,6 +447,7 @@ bool RRATool::run()
     controller->setUseCurvatureFilter(false);
     controller->setTargetDT(.001);
     controller->setCheckTargetTime(true);
+    controller->setNumThreads(_numThreads);
 
     //Make sure system is up-to-date with model (i.e. added actuators, etc...)
     SimTK::State& s = _model->initSystem();
@@ -471,7 +533,7 @@ bool RRATool::run()
     // filtered trajectories
     if(desiredPointsFlag) {
         desiredPointsStore->pad(60);
-        desiredPointsStore->print("desiredPoints_padded.sto");
+        desiredPointsStore->print(_debugFilePrefix + "desiredPoints_padded.sto");
         if(_lowpassCutoffFrequency>=0) {
             int order = 50;
             log_info("Low-pass filtering desired points with a cutoff "
@@ -484,7 +546,7 @@ bool RRATool::run()
 
     if(desiredKinFlag) {
         desiredKinStore->pad(60);
-        if (_verbose) desiredKinStore->print("desiredKinematics_padded.sto");
+        if (_verbose) desiredKinStore->print(_debugFilePrefix + "desiredKinematics_padded.sto");
         if(_lowpassCutoffFrequency>=0) {
             int order = 50;
             log_info("Low-pass filtering desired kinematics with a cutoff "
@@ -551,7 +613,7 @@ bool RRATool::run()
         // Print acc for debugging
         if (_verbose) {
             Storage *accStore=posSet->constructStorage(2);
-            accStore->print("desiredPoints_splinefit_accelerations.sto");
+            accStore->print(_debugFilePrefix + "desiredPoints_splinefit_accelerations.sto");
             delete accStore; accStore=NULL; 
         }
     }
@@ -573,7 +635,7 @@ bool RRATool::run()
 
         // Print dudt for debugging
         if (_verbose) {
-            dudtStore->print("desiredKinematics_splinefit_accelerations.sto");
+            dudtStore->print(_debugFilePrefix + "desiredKinematics_splinefit_accelerations.sto");
         }
         delete dudtStore; dudtStore=NULL;
     }
@@ -907,6 +969,49 @@ bool RRATool::run()
 }
 
 
+//_____________________________________________________________________________
+/**
+ * Run the tool concurrently on overlapping time windows and stitch the
+ * results (see ParallelTimeWindows::runTrackingTool()). The working
+ * directory must already be that of the setup file.
+ */
+bool RRATool::runInParallelTimeWindows()
+{
+    if(_adjustCOMToReduceResiduals) {
+        log_error("Running RRA in parallel time windows does not support "
+            "adjusting the center of mass (<{}>); adjust it in a separate "
+            "run.", _adjustCOMToReduceResidualsProp.getName());
+        return false;
+    }
+
+    // The first window's Actuation analysis holds the blended forces.
+    const auto writeAverageResiduals = [&](Model& model) {
+        if(model.getAnalysisSet().getIndex("Actuation") == -1) return;
+        Actuation& actuation = (Actuation&)model.getAnalysisSet().get("Actuation");
+        Array<double> FAve(0.0,3),MAve(0.0,3);
+        computeAverageResiduals(*actuation.getForceStorage(),FAve,MAve);
+
+        ofstream residualFile((getResultsDir() + "/" + getName() + "_avgResiduals.txt").c_str());
+        residualFile << "Average Residuals:\n\n";
+        residualFile << "FX average = " << FAve[0] << "\n";
+        residualFile << "FY average = " << FAve[1] << "\n";
+        residualFile << "FZ average = " << FAve[2] << "\n";
+        residualFile << "MX average = " << MAve[0] << "\n";
+        residualFile << "MY average = " << MAve[1] << "\n";
+        residualFile << "MZ average = " << MAve[2] << "\n";
+        residualFile.close();
+    };
+    try {
+        // The sequential run integrates up to _tf - _targetDT.
+        const ParallelTimeWindows windows(_ti, _tf - _targetDT,
+            _numParallelTimeWindows, _parallelTimeWindowOverlap);
+        return windows.runTrackingTool(*this, writeAverageResiduals);
+    } catch(const Exception& x) {
+        log_error(x.what());
+        return false;
+    }
+}
+
 //=============================================================================
 // UTILITY
 //=============================================================================
@@ -43,6 +43,7 @@
 
 namespace OpenSim {
 
+class CMC_TaskSet;
 class ControlSet;
 class Storage;
 //=============================================================================
@@ -114,11 +115,28 @@ private:
 
     /** Flag indicating whether or not to adjust the kinematics in order to reduce residuals. */
     bool _adjustKinematicsToReduceResiduals;
+    /** Number of threads used by CMC to compute the task accelerations for
+    the actuator forces. */
+    PropertyInt _numThreadsProp;
+    int &_numThreads;
+    /** Number of time windows to solve concurrently (1: solve the whole time
+    range at once). */
+    PropertyInt _numParallelTimeWindowsProp;
+    int &_numParallelTimeWindows;
+    /** Overlap of adjacent parallel time windows. */
+    PropertyDbl _parallelTimeWindowOverlapProp;
+    double &_parallelTimeWindowOverlap;
     /** Flag for turning on and off verbose printing. */
     PropertyBool _verboseProp;
     bool &_verbose;
 
     ForceSet _originalForceSet;
+    /** Prepended to the names of the intermediate files that track() writes
+    (e.g., desiredPoints_padded.sto), so that concurrent time windows do not
+    write to the same files. */
+    std::string _debugFilePrefix;
+
+    friend class ParallelTimeWindows;
 
 //=============================================================================
 // METHODS
@@ -135,6 +153,8 @@ public:
 private:
     void setNull();
     void setupProperties();
+    bool track(CMC_TaskSet& taskSet);
+    bool runInParallelTimeWindows();
 
     //--------------------------------------------------------------------------
     // OPERATORS
@@ -177,6 +197,14 @@ public:
     const std::string &getExternalLoadsFileName() const { return _externalLoadsFileName; }
     void setExternalLoadsFileName(const std::string &aFileName) { _externalLoadsFileName = aFileName; }
 
+    // Threads
+    int getNumThreads() const { return _numThreads; }
+    void setNumThreads(int numThreads) { _numThreads = numThreads; }
+    int getNumParallelTimeWindows() const { return _numParallelTimeWindows; }
+    void setNumParallelTimeWindows(int numWindows) { _numParallelTimeWindows = numWindows; }
+    double getParallelTimeWindowOverlap() const { return _parallelTimeWindowOverlap; }
+    void setParallelTimeWindowOverlap(double overlap) { _parallelTimeWindowOverlap = overlap; }
+
     //--------------------------------------------------------------------------
     // INTERFACE
     //--------------------------------------------------------------------------
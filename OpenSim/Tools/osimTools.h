@@ -26,6 +26,7 @@
 #include "ScaleTool.h"
 #include "RRATool.h"
 #include "CMCTool.h"
+#include "ParallelTimeWindows.h"
 #include "ForwardTool.h"
 #include "AnalyzeTool.h"
 